@@ -24,5 +24,6 @@
 #include "setup.hpp"
 #include "before_kick_off.hpp"
 #include "finish.hpp"
+#include "pass.hpp"
 
 #endif /* AI_HPP_ */
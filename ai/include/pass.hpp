@@ -0,0 +1,110 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PASS_HPP_
+#define PASS_HPP_
+
+#include <vector>
+#include "WorldModel.hpp"
+#include "geometry.hpp"
+
+using namespace Phoenix;
+
+/*
+ * Pass evaluation: every candidate is a target (a teammate or a point) and an initial ball
+ * speed.  The ball travels along the ray from the ball to the target with Server::BALL_DECAY,
+ * the receiver and every opponent are resolved cycle by cycle against the ball position with
+ * the acceleration curve of their player type, the players also drift with their current
+ * velocity and the player decay of their type.  The opponents are transformed once per target
+ * to the coordinates of the ray and swept together for all the speeds, so the cost grows with
+ * targets x speeds x opponents x cycles without allocations.
+ */
+namespace pass {
+
+const int MAX_CYCLES = 40;
+const int MAX_SPEEDS = 16;
+const int MAX_OPPONENTS = 22;
+
+struct Target {
+	double x;
+	double y;
+	bool receiver;	// True for a teammate, false for a point
+	int unum;		// Uniform number of the receiver, 0 if unknown (the default type is used)
+	double vx;		// Velocity of the receiver
+	double vy;
+	Target() : x(0.0), y(0.0), receiver(false), unum(0), vx(0.0), vy(0.0) {};
+	Target(double x, double y) : x(x), y(y), receiver(false), unum(0), vx(0.0), vy(0.0) {};
+	Target(double x, double y, int unum, double vx, double vy) : x(x), y(y), receiver(true), unum(unum), vx(vx), vy(vy) {};
+};
+
+struct Candidate {
+	Target target;
+	double speed;				// Initial ball speed
+	double direction;			// Absolute kick direction (degrees)
+	int receiver_cycles;		// Cycles for the receiver to control the ball, -1 if it cannot
+	int opponent_cycles;		// Cycles for the fastest opponent to intercept, -1 if none can
+	int opponent_unum;			// Uniform number of the fastest opponent, 0 if unknown
+	double probability;			// Estimated success probability
+};
+
+/*
+ * Buffers of an evaluation, owned by the caller so evaluate does not allocate and several
+ * evaluations can run at the same time
+ */
+struct Workspace {
+	/* Opponents (and players of unknown team), position and velocity in the coordinates of the current ray */
+	int opponents;
+	double opp_x[MAX_OPPONENTS];
+	double opp_y[MAX_OPPONENTS];
+	double opp_vx[MAX_OPPONENTS];
+	double opp_vy[MAX_OPPONENTS];
+	double opp_a[MAX_OPPONENTS];
+	double opp_b[MAX_OPPONENTS];
+	double opp_va[MAX_OPPONENTS];
+	double opp_vb[MAX_OPPONENTS];
+	int opp_unum[MAX_OPPONENTS];
+	double opp_reach[MAX_OPPONENTS][MAX_CYCLES + 1];
+	double opp_drift[MAX_OPPONENTS][MAX_CYCLES + 1];
+	/* Distance traveled by the ball along the ray for every speed */
+	double travel[MAX_SPEEDS][MAX_CYCLES + 1];
+	/* Receiver reach and drift */
+	double receiver_reach[MAX_CYCLES + 1];
+	double receiver_drift[MAX_CYCLES + 1];
+};
+
+/*
+ * Appends the teammates in the world model as targets with their velocity, the agent is not included.
+ * The teammates with unknown uniform number reach the ball with the default player type
+ */
+void addReceivers(WorldModel &world_model, std::vector<Target> &targets);
+/*
+ * Evaluates every target with every speed for a ball kicked from ball, the speeds above the
+ * maximum ball speed (Server::BALL_SPEED_MAX and the maximum kick acceleration) are clamped.
+ * The candidates are returned ranked by probability, the vector is cleared first.
+ */
+void evaluate(WorldModel &world_model, Geometry::Point ball, const std::vector<Target> &targets, const std::vector<double> &speeds, std::vector<Candidate> &candidates, Workspace &workspace);
+/*
+ * Returns the maximum initial speed a kick can give to the ball
+ */
+double getMaxKickSpeed();
+
+}
+
+#endif /* PASS_HPP_ */
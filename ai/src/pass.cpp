@@ -0,0 +1,182 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pass.hpp"
+#include <algorithm>
+#include <cmath>
+#include "constants.hpp"
+#include "PlayerType.hpp"
+#include "Server.hpp"
+
+namespace pass {
+
+/*
+ * Squared reach of a player after t cycles, the players need a cycle to react and turn before dashing
+ */
+static void computeReach(const PlayerType* type, double reach[MAX_CYCLES + 1]) {
+	double kickable = type->getKickableRadius();
+	for (int t = 0; t <= MAX_CYCLES; ++t) {
+		reach[t] = type->getDashDistance(t - 1) + kickable;
+		reach[t] *= reach[t];
+	}
+}
+
+/*
+ * Displacement after t cycles of a player moving with unit velocity without dashing
+ */
+static void computeDrift(const PlayerType* type, double drift[MAX_CYCLES + 1]) {
+	double decay = type->getPlayerDecay();
+	double speed = 1.0;
+	drift[0] = 0.0;
+	for (int t = 1; t <= MAX_CYCLES; ++t) {
+		drift[t] = drift[t - 1] + speed;
+		speed *= decay;
+	}
+}
+
+static bool compareCandidates(const Candidate &candidate0, const Candidate &candidate1) {
+	if (candidate0.probability != candidate1.probability) {
+		return candidate0.probability > candidate1.probability;
+	}
+	return candidate0.receiver_cycles < candidate1.receiver_cycles;
+}
+
+double getMaxKickSpeed() {
+	double speed = Server::MAXPOWER * Server::KICK_POWER_RATE;
+	if (speed > Server::BALL_ACCEL_MAX) speed = Server::BALL_ACCEL_MAX;
+	if (speed > Server::BALL_SPEED_MAX) speed = Server::BALL_SPEED_MAX;
+	return speed;
+}
+
+void addReceivers(WorldModel &world_model, std::vector<Target> &targets) {
+	std::vector<Player*> players = world_model.getOurPlayers();
+	for (std::vector<Player*>::iterator it = players.begin(); it != players.end(); ++it) {
+		Position* position = (*it)->getPosition();
+		Geometry::Vector2D* velocity = (*it)->getVelocity();
+		targets.push_back(Target(position->getX(), position->getY(), (*it)->getUniformNumber(), velocity->dx, velocity->dy));
+	}
+}
+
+void evaluate(WorldModel &world_model, Geometry::Point ball, const std::vector<Target> &targets, const std::vector<double> &speeds, std::vector<Candidate> &candidates, Workspace &workspace) {
+	candidates.clear();
+	int n_speeds = speeds.size() < (size_t)MAX_SPEEDS ? speeds.size() : MAX_SPEEDS;
+	candidates.reserve(targets.size() * n_speeds);
+	double max_speed = getMaxKickSpeed();
+	for (int s = 0; s < n_speeds; ++s) {
+		double speed = speeds[s] < max_speed ? speeds[s] : max_speed;
+		double* travel = workspace.travel[s];
+		travel[0] = 0.0;
+		for (int t = 1; t <= MAX_CYCLES; ++t) {
+			travel[t] = travel[t - 1] + speed;
+			speed *= Server::BALL_DECAY;
+		}
+	}
+	int opponents = 0;
+	int players = world_model.getPlayersCount();
+	for (int i = 0; i < players && opponents < MAX_OPPONENTS; ++i) {
+		Player* player = world_model.getPlayer(i);
+		if (player->getTeam().compare("our") == 0) continue;
+		int unum = player->getUniformNumber();
+		const PlayerType* type = unum > 0 && player->getTeam().compare("opp") == 0 ? PlayerType::getPlayerTypeFor(false, unum) : PlayerType::getPlayerType(0);
+		workspace.opp_x[opponents] = player->getPosition()->getX();
+		workspace.opp_y[opponents] = player->getPosition()->getY();
+		workspace.opp_vx[opponents] = player->getVelocity()->dx;
+		workspace.opp_vy[opponents] = player->getVelocity()->dy;
+		workspace.opp_unum[opponents] = unum;
+		computeReach(type, workspace.opp_reach[opponents]);
+		computeDrift(type, workspace.opp_drift[opponents]);
+		opponents++;
+	}
+	workspace.opponents = opponents;
+	for (std::vector<Target>::const_iterator target = targets.begin(); target != targets.end(); ++target) {
+		double dx = target->x - ball.x;
+		double dy = target->y - ball.y;
+		double distance = sqrt(dx * dx + dy * dy);
+		double ux = distance > 0.0 ? dx / distance : 1.0;
+		double uy = distance > 0.0 ? dy / distance : 0.0;
+		for (int j = 0; j < opponents; ++j) {
+			double ox = workspace.opp_x[j] - ball.x;
+			double oy = workspace.opp_y[j] - ball.y;
+			workspace.opp_a[j] = ox * ux + oy * uy;
+			workspace.opp_b[j] = -ox * uy + oy * ux;
+			workspace.opp_va[j] = workspace.opp_vx[j] * ux + workspace.opp_vy[j] * uy;
+			workspace.opp_vb[j] = -workspace.opp_vx[j] * uy + workspace.opp_vy[j] * ux;
+		}
+		double receiver_va = target->vx * ux + target->vy * uy;
+		double receiver_vb = -target->vx * uy + target->vy * ux;
+		if (target->receiver) {
+			const PlayerType* type = target->unum > 0 ? PlayerType::getPlayerTypeFor(true, target->unum) : PlayerType::getPlayerType(0);
+			computeReach(type, workspace.receiver_reach);
+			computeDrift(type, workspace.receiver_drift);
+		}
+		for (int s = 0; s < n_speeds; ++s) {
+			Candidate candidate;
+			candidate.target = *target;
+			candidate.speed = speeds[s] < max_speed ? speeds[s] : max_speed;
+			candidate.direction = atan2(uy, ux) * 180.0 / Math::PI;
+			candidate.receiver_cycles = -1;
+			candidate.opponent_cycles = -1;
+			candidate.opponent_unum = 0;
+			for (int t = 1; t <= MAX_CYCLES; ++t) {
+				double along = workspace.travel[s][t];
+				if (candidate.receiver_cycles < 0) {
+					if (target->receiver) {
+						double drift = workspace.receiver_drift[t];
+						double da = along - distance - receiver_va * drift;
+						double db = receiver_vb * drift;
+						if (workspace.receiver_reach[t] >= da * da + db * db) candidate.receiver_cycles = t;
+					} else if (along >= distance) {
+						candidate.receiver_cycles = t;
+					}
+				}
+				if (candidate.opponent_cycles < 0) {
+					int fastest = -1;
+					for (int j = 0; j < opponents; ++j) {
+						double drift = workspace.opp_drift[j][t];
+						double da = along - workspace.opp_a[j] - workspace.opp_va[j] * drift;
+						double db = workspace.opp_b[j] + workspace.opp_vb[j] * drift;
+						if (workspace.opp_reach[j][t] >= da * da + db * db) {
+							fastest = j;
+							break;
+						}
+					}
+					if (fastest >= 0) {
+						candidate.opponent_cycles = t;
+						candidate.opponent_unum = workspace.opp_unum[fastest];
+					}
+				}
+				if (candidate.receiver_cycles >= 0 && candidate.opponent_cycles >= 0) break;
+			}
+			if (candidate.receiver_cycles < 0) {
+				candidate.probability = 0.0;
+			} else if (candidate.opponent_cycles < 0) {
+				candidate.probability = 1.0;
+			} else {
+				// One cycle of margin gives a fair chance, the opponents do not know the pass in advance
+				double margin = candidate.opponent_cycles - candidate.receiver_cycles;
+				candidate.probability = 1.0 / (1.0 + exp(-(margin - 0.5)));
+			}
+			candidates.push_back(candidate);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), compareCandidates);
+}
+
+}
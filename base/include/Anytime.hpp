@@ -0,0 +1,143 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file Anytime.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef ANYTIME_HPP_
+#define ANYTIME_HPP_
+
+#include <sys/time.h>
+#include "Game.hpp"
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+/*!
+ * @brief <STRONG> Anytime <BR> </STRONG>
+ * The Anytime object keeps the best result of a search that can be interrupted at any iteration.  The
+ * search calls running() before each iteration and offer() with each candidate, when the time budget
+ * expires running() returns false and the best candidate found so far is the result.  The budget is
+ * the time left before the cycle deadline (Game::getRemainingTime()) unless a budget in milliseconds is
+ * given.  The clock is read every check_interval calls to running(), so cheap iterations can use a
+ * bigger interval.
+ *
+ * Example:
+ *     Anytime<Candidate> search;
+ *     for (int depth = 1; search.running(); ++depth) {
+ *         search.offer(expand(depth), score);
+ *     }
+ *     if (search.hasResult()) execute(search.getBest());
+ */
+template <typename T>
+class Anytime {
+public:
+	/*!
+	 * @brief Anytime constructor, the budget starts running
+	 * @param budget Milliseconds for the search, negative to use the cycle deadline
+	 * @param check_interval Calls to running() between two reads of the clock
+	 */
+	Anytime(double budget = -1.0, unsigned int check_interval = 1) {
+		if (budget < 0.0) budget = Game::getRemainingTime();
+		this->budget = budget;
+		this->check_interval = check_interval > 0 ? check_interval : 1;
+		gettimeofday(&start, 0);
+		iterations = 0;
+		has_result = false;
+		expired = budget <= 0.0;
+		best_score = 0.0;
+	}
+	/*!
+	 * @brief Returns false once the budget expired, it counts one iteration
+	 */
+	bool running() {
+		if (expired) return false;
+		if (iterations++ % check_interval == 0 && getElapsedTime() >= budget) {
+			expired = true;
+		}
+		return !expired;
+	}
+	/*!
+	 * @brief Offers a candidate, it is kept if its score is bigger than the score of the best candidate
+	 * @return True if the candidate is the new best
+	 */
+	bool offer(const T &candidate, double score) {
+		if (has_result && score <= best_score) return false;
+		best = candidate;
+		best_score = score;
+		has_result = true;
+		return true;
+	}
+	/*!
+	 * @brief Returns true if a candidate was offered
+	 */
+	bool hasResult() const {
+		return has_result;
+	}
+	/*!
+	 * @brief Returns the best candidate, valid only if hasResult()
+	 */
+	const T& getBest() const {
+		return best;
+	}
+	/*!
+	 * @brief Returns the score of the best candidate
+	 */
+	double getBestScore() const {
+		return best_score;
+	}
+	/*!
+	 * @brief Returns the calls to running() while the budget did not expire
+	 */
+	unsigned int getIterations() const {
+		return iterations;
+	}
+	/*!
+	 * @brief Returns true if the budget expired
+	 */
+	bool isExpired() const {
+		return expired;
+	}
+	/*!
+	 * @brief Returns the milliseconds since the search started
+	 */
+	double getElapsedTime() const {
+		struct timeval now;
+		gettimeofday(&now, 0);
+		return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_usec - start.tv_usec) / 1000.0;
+	}
+private:
+	T best;
+	double best_score;
+	bool has_result;
+	bool expired;
+	double budget;
+	unsigned int check_interval;
+	unsigned int iterations;
+	struct timeval start;
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* ANYTIME_HPP_ */
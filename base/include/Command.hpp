@@ -38,13 +38,15 @@ namespace Phoenix {
  * status and this status is changed once the command is sent to SENT.  In the new cycle the command is
  * compared to the commands executed in the previous cycle using the information provided by the sense_body
  * sensor to change the status to EXECUTED.  In case the command is not sent and flags an error, the status
- * is changed to ERROR.
+ * is changed to ERROR.  If the command was sent but the server did not execute it, or it was replaced by
+ * another command of the same type before being confirmed, the status is changed to LOST.
  */
 enum COMMAND_STATUS {
 	CREATED,		///< Command created status
 	SENT,			///< Command sent status
 	EXECUTED,		///< Command executed status
-	ERROR			///< Command error status
+	ERROR,			///< Command error status
+	LOST			///< Command lost status
 };
 
  /*!
@@ -99,6 +101,28 @@ public:
 	 * @brief Command default destructor
 	 */
 	~Command();
+	/*!
+	 * @brief Empties the command so the object can be reused for a new command
+	 * @param weight command weight, it is 1 or 0
+	 * @param type command type
+	 * The Commands object keeps its commands in a ring and reuses them with this method, so no memory
+	 * is allocated when a command is created.
+	 */
+	void reset(int weight, COMMAND_TYPE type);
+	/*!
+	 * @brief Appends text to the command string
+	 * @param text text to append
+	 * If the command string does not fit in BUFFER_SIZE the status is changed to ERROR.
+	 */
+	void append(const char* text);
+	/*!
+	 * @brief Appends a number to the command string
+	 * @param value number to append
+	 * The number is written in fixed notation rounded to Configs::COMMAND_PRECISION significant
+	 * digits (the zeros after the point of a number smaller than 1 do not count) and without
+	 * trailing zeros. Numbers too large or too small for the fixed notation are written with %g.
+	 */
+	void append(double value);
 	/*!
 	 * @brief Method to add the arguments of the command
 	 * @param arg0 first parameter
@@ -112,6 +136,14 @@ public:
 	 * @brief Returns the command string to be sent to the server
 	 */
 	std::string getCommand();
+	/*!
+	 * @brief Returns the command string to be sent to the server without copying it
+	 */
+	const char* getCommandBuffer() const;
+	/*!
+	 * @brief Returns the length of the command string
+	 */
+	int getCommandLength() const;
 	/*!
 	 * @brief Returns the current command weight
 	 */
@@ -195,8 +227,10 @@ public:
 	 * @brief Returns the simulation time the command was created
 	 */
 	int createdAt();
+	static const int BUFFER_SIZE = 256;	///< Maximum length of a command string
 private:
-	std::string command;		///< current command string to be sent to the server
+	char command[BUFFER_SIZE];	///< current command string to be sent to the server
+	int length;					///< current command string length
 	int weight;					///< current command weight
 	COMMAND_TYPE type;			///< current command type
 	COMMAND_STATUS status;		///< current comman status
@@ -38,7 +38,11 @@ class Connect;
  * @brief <STRONG> Commands <BR> </STRONG>
  * The Commans object, or Dispatcher, stores the commands to be sent at the end of
  * the current cycle.  It also is in charge of creating the actual string sent to the
- * server using the string commands stored.
+ * server using the string commands stored.  The commands are kept in a ring allocated
+ * by the constructor with room for QUEUE_SIZE commands per cycle during the last
+ * Configs::COMMANDS_MAX_HISTORY cycles, so queueing and sending a command does not
+ * allocate memory.  The queue is protected by a mutex so the watchdog of the Controller
+ * can send the commands queued so far when the behavior misses the cycle deadline.
  */
 class Commands {
 public:
@@ -47,12 +51,14 @@ public:
 	 * @param connect pointer to a connect object in charge of send and receives messages from the server
 	 */
 	Commands(Connect *connect);
+	static const int QUEUE_SIZE = 16;	///< Maximum number of commands queued in a cycle
 	/*!
 	 * @brief Commands default destructor
 	 */
 	~Commands();
 	/*!
 	 * @brief Removes commands sent stored in memory
+	 * The ring recycles the old commands, so this method is kept for compatibility
 	 */
 	void flush();
 	/*!
@@ -146,6 +152,24 @@ public:
 	 * weight changes from 1 to 2.  Returns amount of commands sent.
 	 */
 	int sendCommands();
+	/*!
+	 * @brief Removes the commands in queue, an anytime behavior can replace its commands with better ones
+	 */
+	void clear();
+	/*!
+	 * @brief Holds the queue, the commands are not sent until unlock() is called.  It is used to replace
+	 * the commands in queue (clear and queue again) without the watchdog sending a partial set
+	 */
+	void lock();
+	/*!
+	 * @brief Releases the queue held by lock()
+	 */
+	void unlock();
+	/*!
+	 * @brief Sends the commands in queue when the cycle deadline expires and drops the commands sent
+	 * by the next call to sendCommands(), the late commands of the cycle.  Returns amount of commands sent.
+	 */
+	int sendOnDeadline();
 };
 
 } // End namespace Phoenix
@@ -71,6 +71,11 @@ public:
 	static double TRACKING_THRESHOLD;			///< When the match for two players is below this value the player will not be tracked
 	static std::string TRACKING;				///< Indicates which tracking method will be used for the player tracking
 	static std::string LOCALIZATION;			///< Indicates which localization method will be used for the player and goalie agents
+	static std::string REACH_CACHE;				///< Directory where the reach tables are persisted, empty to disable the cache
+	static unsigned int DEADLINE_MARGIN;		///< Milliseconds reserved at the end of the cycle to send the commands
+	static bool WATCHDOG;						///< If true the commands are sent at the deadline when the handler overruns
+	static unsigned int THREADS;				///< Threads of the task pool used by the behaviors, the main thread included
+	static bool AFFINITY;						///< If true the workers of the task pool are bound to cores
 };
 
 } // End namespace Phoenix
@@ -59,6 +59,12 @@ public:
 	 * @param msg message to send
 	 */
 	bool sendMessage(std::string msg);
+	/*!
+	 * @brief send a message to the server in hostname and port without copying it
+	 * @param msg null terminated message to send
+	 * @param length length of the message without the null character
+	 */
+	bool sendMessage(const char* msg, int length);
 	/*!
 	 * @brief Returns a message sent by the server.
 	 * It is a blocking method: returns until there is a new message in the buffer.
@@ -36,7 +36,9 @@ namespace Phoenix {
  * @brief <STRONG> Game <BR> </STRONG>
  * The Game object stores information about the current status of the game.  It
  * also synchronize the main thread with the server through the Game::nextCycle()
- * method.
+ * method.  The cycle starts when the sense_body (or see_global) message arrives, the
+ * deadline of the cycle is the end of the server cycle minus Configs::DEADLINE_MARGIN
+ * milliseconds, so the commands sent before it are executed in the cycle.
  */
 class Game {
 public:
@@ -51,6 +53,18 @@ public:
 	 * to start a new cycle.
 	 */
 	static bool nextCycle();
+	/*!
+	 * @brief Returns the milliseconds since the start of the current cycle
+	 */
+	static double getElapsedTime();
+	/*!
+	 * @brief Returns the milliseconds left before the deadline of the current cycle, negative if it expired
+	 */
+	static double getRemainingTime();
+	/*!
+	 * @brief Returns true if the deadline of the current cycle expired
+	 */
+	static bool isDeadlineExpired();
 	/*!
 	 * @brief Game default constructor
 	 */
@@ -64,6 +78,10 @@ public:
 	 * @param game_time current game time sent by the server
 	 */
 	void updateTime(int game_time);
+	/*!
+	 * @brief Marks the start of a server cycle, it is called when the first message of the cycle arrives
+	 */
+	void startCycle();
 	/*!
 	 * @brief Update the current play mode
 	 * @param play_mode new play mode sent by the server
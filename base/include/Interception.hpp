@@ -0,0 +1,123 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file Interception.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef INTERCEPTION_HPP_
+#define INTERCEPTION_HPP_
+
+#include "WorldModel.hpp"
+#include "geometry.hpp"
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+class PlayerType;
+
+/*!
+ * @brief Team of an interceptor
+ */
+enum INTERCEPTOR_TEAM {
+	OUR_TEAM,
+	OPP_TEAM,
+	UNKNOWN_TEAM
+};
+
+/*!
+ * @brief Earliest interception of the ball trajectory by a player
+ */
+struct Interceptor {
+	INTERCEPTOR_TEAM team;		///< Team of the player
+	int unum;					///< Uniform number, 0 if unknown
+	bool self;					///< True for the agent
+	bool in_sight_range;		///< False for players kept in the history out of the see sensor
+	int cycles;					///< Earliest cycle the player reaches the ball, -1 if not reachable in MAX_CYCLES
+	double x;					///< Ball position in x at the interception
+	double y;					///< Ball position in y at the interception
+	const PlayerType* type;		///< Player type used for the dynamics
+};
+
+/*!
+ * @brief <STRONG> Interception <BR> </STRONG>
+ * The Interception module computes, once per cycle, the earliest cycle each known player (the agent,
+ * the players in the see sensor and the ones kept in the history) can reach the predicted ball
+ * trajectory.  The ball trajectory is precomputed with Server::BALL_DECAY and every player moves with
+ * the acceleration curve of its PlayerType, after drifting with its current velocity and turning
+ * towards the interception point.  The players are stored as arrays and resolved together cycle by
+ * cycle, so the behaviors can query the result without recomputing it.
+ */
+class Interception {
+public:
+	static const int MAX_CYCLES = 50;	///< Length of the ball trajectory
+	static const int MAX_PLAYERS = 23;	///< The agent and 22 players
+	/*!
+	 * @brief Computes the interceptions for the world model unless they were computed in this cycle for
+	 * the same snapshot
+	 * @param world_model Current world model
+	 */
+	static void update(WorldModel &world_model);
+	/*!
+	 * @brief Computes the interceptions for the world model
+	 * @param world_model Current world model
+	 */
+	static void compute(WorldModel &world_model);
+	/*!
+	 * @brief Forces the next update to compute the interceptions
+	 */
+	static void invalidate();
+	/*!
+	 * @brief Returns the number of interceptors computed
+	 */
+	static int getCount();
+	/*!
+	 * @brief Returns an interceptor, the agent is always the first one
+	 * @param i Index of the interceptor (0 - getCount())
+	 */
+	static const Interceptor* getInterceptor(int i);
+	/*!
+	 * @brief Returns the agent interceptor
+	 */
+	static const Interceptor* getSelf();
+	/*!
+	 * @brief Returns the fastest interceptor of a team, the agent included in our team
+	 * @param team Team of the interceptor
+	 * @return Fastest interceptor, or null if no player of the team reaches the ball
+	 */
+	static const Interceptor* getFastest(INTERCEPTOR_TEAM team);
+	/*!
+	 * @brief Returns the fastest interceptor of all the players
+	 * @return Fastest interceptor, or null if no player reaches the ball
+	 */
+	static const Interceptor* getFastest();
+	/*!
+	 * @brief Returns the predicted ball position
+	 * @param cycle Cycles from now (0 - MAX_CYCLES)
+	 */
+	static Geometry::Point getBallPosition(int cycle);
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* INTERCEPTION_HPP_ */
@@ -0,0 +1,108 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file KickPlanner.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef KICKPLANNER_HPP_
+#define KICKPLANNER_HPP_
+
+#include "Physics.hpp"
+#include "WorldModel.hpp"
+#include "geometry.hpp"
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+class PlayerType;
+
+/*!
+ * @brief Sequence of kicks found by the KickPlanner
+ */
+struct KickPlan {
+	static const int MAX_KICKS = 3;		///< Maximum kicks in a plan
+	int kicks;							///< Kicks in the plan, 0 if the ball is not kick-able
+	double power[MAX_KICKS];			///< Power of each kick
+	double direction[MAX_KICKS];		///< Direction of each kick relative to the body, as Commands::kick expects
+	double vx;							///< Ball velocity in x after the last kick
+	double vy;							///< Ball velocity in y after the last kick
+	double noise;						///< Sum of the maximum noise the server can add to each kick
+	bool reached;						///< True if the plan gives the target velocity, otherwise it is the closest single kick
+};
+
+/*!
+ * @brief <STRONG> KickPlanner <BR> </STRONG>
+ * The KickPlanner finds a sequence of one to three kicks that gives the ball a target velocity.  When a
+ * single kick is not enough, the ball is first moved to other positions inside the kick-able area, around
+ * the body if needed, where the kick is more effective.  The positions are the cells of a table built
+ * for the player type: for every distance and direction relative to the body the table stores the
+ * effective kick rate (kick_power_rate reduced by the distance and direction of the ball) and the
+ * position term of the kick noise (kick_rand).  The cells inside the kick-able area of an opponent (of
+ * its player type, plus a margin) or whose path crosses the body are discarded.  The two kick sequences
+ * are searched exhaustively, the three kick sequences are searched until the time budget expires and the
+ * plan with the least noise is returned.  The movement of the agent is its current velocity decaying, the
+ * agent does not dash between the kicks.  The tables are shared, the buffers of a plan are local so plans
+ * for the same player type can run at the same time.
+ */
+class KickPlanner {
+public:
+	static const int DISTANCES = 6;		///< Distances from the body in the table
+	static const int ANGLES = 24;		///< Directions relative to the body in the table, every 15 degrees
+	static const int MAX_OPPONENTS = 22;	///< Opponents considered by a plan
+	/*!
+	 * @brief Builds the table for a player type, it is done when connecting and when the agent type changes
+	 * @param type Player type of the agent
+	 */
+	static void buildTables(const PlayerType* type);
+	/*!
+	 * @brief Plans the kicks for the agent using the current state of the world
+	 * @param vx Target ball velocity in x
+	 * @param vy Target ball velocity in y
+	 * @param world_model Current world model, used for the ball and the opponents with their player types
+	 * @param time_budget Milliseconds available for the three kick search
+	 */
+	static KickPlan plan(double vx, double vy, WorldModel &world_model, double time_budget = 2.0);
+	/*!
+	 * @brief Plans the kicks for a given state
+	 * @param state State of the agent and the ball, the body direction in degrees
+	 * @param vx Target ball velocity in x
+	 * @param vy Target ball velocity in y
+	 * @param opponents Positions of the opponents to avoid
+	 * @param kickable Kick-able radius of each opponent, if null the radius of the server default type is used
+	 * @param count Number of opponents, at most MAX_OPPONENTS
+	 * @param time_budget Milliseconds available for the three kick search
+	 */
+	static KickPlan plan(const Physics::State &state, double vx, double vy, const Geometry::Point* opponents, const double* kickable,
+			int count, double time_budget = 2.0);
+	/*!
+	 * @brief Returns the effective kick rate stored in the table for the nearest cell
+	 * @param distance Distance from the center of the agent to the center of the ball
+	 * @param angle Direction of the ball relative to the body (degrees)
+	 */
+	static double getKickRate(double distance, double angle);
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* KICKPLANNER_HPP_ */
@@ -26,6 +26,7 @@
 #define PARSER_HPP_
 
 #include <string>
+#include <vector>
 
 /*! @addtogroup phoenix_base
  * @{
@@ -35,6 +36,10 @@ namespace Phoenix {
 class Self;
 class World;
 class Messages;
+class Message;
+class Flag;
+class Player;
+class Ball;
 
  /*!
  * @brief <STRONG> Parser <BR> </STRONG>
@@ -60,6 +65,30 @@ public:
 	 * @param message Message received from the server
 	 */
 	void parseMessage(std::string message);
+	/*!
+	 * @brief Extract the flags, players and ball of a see message
+	 * @param see See message received from the server
+	 * @param simulation_time Simulation time assigned to the flags
+	 * @param flags Vector where the seen flags are appended
+	 * @param players Vector where the seen players are appended (relative data only)
+	 * @return Raw ball data or an empty string if the ball was not seen
+	 */
+	static std::string parseSee(const std::string &see, int simulation_time, std::vector<Flag> &flags, std::vector<Player> &players);
+	/*!
+	 * @brief Extract the players and the ball of a fullstate message
+	 * @param fullstate Fullstate message received from the server
+	 * @param players Vector where the players are appended
+	 * @param ball Ball to initialize
+	 */
+	static void parseFullstate(const std::string &fullstate, std::vector<Player> &players, Ball &ball);
+	/*!
+	 * @brief Extract the content of a hear message
+	 * @param hear Hear message received from the server
+	 * @param messages Vector where the heard message is appended (if any)
+	 * @param play_mode Set to the new play mode if the message comes from the referee
+	 * @return False if the message is not supported
+	 */
+	static bool parseHear(const std::string &hear, std::vector<Message> &messages, std::string &play_mode);
 };
 
 } // End namespace Phoenix
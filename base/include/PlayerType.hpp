@@ -0,0 +1,227 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file PlayerType.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef PLAYERTYPE_HPP_
+#define PLAYERTYPE_HPP_
+
+#include <string>
+#include "Physics.hpp"
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+/*!
+ * @brief <STRONG> PlayerType <BR> </STRONG>
+ * The PlayerType object stores the parameters of a heterogeneous player type received from the
+ * server, along with the capabilities derived from them and the server parameters: real maximum
+ * speed, acceleration curve, kick-able radius, turn rate and stamina cost.  The derived values are
+ * computed once when the type is received, so the planners can query them for any player.  The
+ * table of types received is shared by all the objects and can be queried by type id, or by uniform
+ * number for teammates and opponents.
+ */
+class PlayerType {
+public:
+	static const int ACCELERATION_CYCLES = 20;	///< Cycles stored in the acceleration curve
+	/*!
+	 * @brief PlayerType default constructor, the parameters of the default type in rcssserver
+	 */
+	PlayerType();
+	/*!
+	 * @brief PlayerType constructor
+	 * @param player_type Player type string received from the server
+	 */
+	PlayerType(std::string player_type);
+	/*!
+	 * @brief PlayerType default destructor
+	 */
+	~PlayerType();
+	/*!
+	 * @brief Returns the type id
+	 */
+	int getId() const;
+	/*!
+	 * @brief Returns the maximum speed allowed by the server for this type
+	 */
+	double getPlayerSpeedMax() const;
+	/*!
+	 * @brief Returns the maximum stamina increment per cycle
+	 */
+	double getStaminaIncMax() const;
+	/*!
+	 * @brief Returns the player decay
+	 */
+	double getPlayerDecay() const;
+	/*!
+	 * @brief Returns the inertia moment
+	 */
+	double getInertiaMoment() const;
+	/*!
+	 * @brief Returns the dash power rate
+	 */
+	double getDashPowerRate() const;
+	/*!
+	 * @brief Returns the player size (radius)
+	 */
+	double getPlayerSize() const;
+	/*!
+	 * @brief Returns the kick-able margin
+	 */
+	double getKickableMargin() const;
+	/*!
+	 * @brief Returns the random noise added to the kick command
+	 */
+	double getKickRand() const;
+	/*!
+	 * @brief Returns the extra stamina
+	 */
+	double getExtraStamina() const;
+	/*!
+	 * @brief Returns the maximum effort
+	 */
+	double getEffortMax() const;
+	/*!
+	 * @brief Returns the minimum effort
+	 */
+	double getEffortMin() const;
+	/*!
+	 * @brief Returns the kick power rate
+	 */
+	double getKickPowerRate() const;
+	/*!
+	 * @brief Returns the foul detect probability
+	 */
+	double getFoulDetectProbability() const;
+	/*!
+	 * @brief Returns the catchable area length stretch for the goalie
+	 */
+	double getCatchableAreaLStretch() const;
+	/*!
+	 * @brief Returns the maximum speed the player can reach dashing with maximum power
+	 * @param tired If true the minimum effort is used, otherwise the maximum effort
+	 */
+	double getRealSpeedMax(bool tired = false) const;
+	/*!
+	 * @brief Returns the speed after dashing from rest with maximum power and effort
+	 * @param cycles Cycles dashing, the curve saturates after ACCELERATION_CYCLES
+	 */
+	double getSpeedAfterDashes(int cycles) const;
+	/*!
+	 * @brief Returns the distance covered dashing from rest with maximum power and effort
+	 * @param cycles Cycles dashing, after ACCELERATION_CYCLES the player moves at the real maximum speed
+	 */
+	double getDashDistance(int cycles) const;
+	/*!
+	 * @brief Returns the cycles needed to cover the distance dashing from rest with maximum power and effort
+	 * @param distance Distance to cover
+	 */
+	int getCyclesToRun(double distance) const;
+	/*!
+	 * @brief Returns the distance from the center of the player where the ball can be kicked
+	 */
+	double getKickableRadius() const;
+	/*!
+	 * @brief Returns the maximum body turn in a cycle for the given speed
+	 * @param speed Current player speed
+	 */
+	double getMaxTurn(double speed) const;
+	/*!
+	 * @brief Returns the stamina spent per meter running at the real maximum speed
+	 */
+	double getStaminaPerMeter() const;
+	/*!
+	 * @brief Returns the movement model of this type for the physics simulator
+	 * @param effort Current effort, if negative the maximum effort of the type is used
+	 */
+	Physics::Model getModel(double effort = -1.0) const;
+	/*!
+	 * @brief Adds a player type to the table, replacing the type with the same id
+	 * @param type Player type to add
+	 */
+	static void addPlayerType(const PlayerType &type);
+	/*!
+	 * @brief Returns the player type with the given id
+	 * @param id Type id
+	 * @return Pointer to the type, or the default type if the id has not been received
+	 */
+	static const PlayerType* getPlayerType(int id);
+	/*!
+	 * @brief Sets the type of a player
+	 * @param our True for a teammate, false for an opponent
+	 * @param unum Uniform number of the player
+	 * @param id Type id, -1 if unknown
+	 */
+	static void setPlayerTypeFor(bool our, int unum, int id);
+	/*!
+	 * @brief Returns the type of a player
+	 * @param our True for a teammate, false for an opponent
+	 * @param unum Uniform number of the player
+	 * @return Pointer to the type, the default type if unknown
+	 * The server only informs the opponents substitutions, so the opponents type is unknown after
+	 * a substitution unless the coach identifies it and calls setPlayerTypeFor.
+	 */
+	static const PlayerType* getPlayerTypeFor(bool our, int unum);
+	/*!
+	 * @brief Returns the type id of a player, -1 if unknown
+	 * @param our True for a teammate, false for an opponent
+	 * @param unum Uniform number of the player
+	 */
+	static int getPlayerTypeIdFor(bool our, int unum);
+private:
+	int id;
+	double player_speed_max;
+	double stamina_inc_max;
+	double player_decay;
+	double inertia_moment;
+	double dash_power_rate;
+	double player_size;
+	double kickable_margin;
+	double kick_rand;
+	double extra_stamina;
+	double effort_max;
+	double effort_min;
+	double kick_power_rate;
+	double foul_detect_probability;
+	double catchable_area_l_stretch;
+	double real_speed_max;
+	double real_speed_max_tired;
+	double speed_after_dashes[ACCELERATION_CYCLES + 1];
+	double dash_distance[ACCELERATION_CYCLES + 1];
+	double kickable_radius;
+	double stamina_per_meter;
+	/*!
+	 * @brief Sets the parameters of the default type
+	 */
+	void setDefaults();
+	/*!
+	 * @brief Computes the derived capabilities from the parameters
+	 */
+	void computeDerived();
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* PLAYERTYPE_HPP_ */
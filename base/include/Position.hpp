@@ -68,6 +68,12 @@ public:
 	 * @return Distance to the given position
 	 */
 	double getDistanceTo(Position* position) const;
+	/*!
+	 * @brief Returns the squared euclidean distance between this position and the provided position
+	 * @param position Position to compute the distance
+	 * @return Squared distance to the given position, to compare distances without the square root
+	 */
+	double getSquaredDistanceTo(Position* position) const;
 	/*!
 	 * @brief Returns the relative direction from this position to the provided position
 	 * @param position Position to compute the direction
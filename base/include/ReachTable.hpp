@@ -0,0 +1,123 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file ReachTable.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef REACHTABLE_HPP_
+#define REACHTABLE_HPP_
+
+#include <string>
+#include "Physics.hpp"
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+class PlayerType;
+
+/*!
+ * @brief <STRONG> ReachTable <BR> </STRONG>
+ * The ReachTable gives, for a player type, the cycles needed to reach a point given its distance, its
+ * direction relative to the body and the initial speed of the player (along the body direction).  The
+ * reach is a rollout of the physics simulator with the type model in two phases: the player turns with
+ * the maximum moment until the point is in front (inside the kick-able radius along the body line) and
+ * then dashes with maximum power towards it, the lateral velocity left by the turns is ignored, the point
+ * is reached when it is inside the kick-able radius.  The turns are simulated in every query, they are a
+ * few cycles at most, and only the dash phase is read from the table, indexed by the distance to the
+ * point and the speed towards it after the turns, and interpolated linearly.  The dash cycles never
+ * decrease with the distance nor increase with the speed, so the rollout of any point of a cell lies
+ * between the corners of the cell, as does the interpolation: the difference of those corners is a
+ * bound of the error that holds by construction, getErrorBound returns the largest one.  The tables are
+ * built when the player types are received and are persisted in Configs::REACH_CACHE, in a file named
+ * after the hash of the model, so the next connection only reads them.
+ */
+class ReachTable {
+public:
+	static const int DISTANCES = 121;		///< Distance axis, from 0 to 60 meters every half meter
+	static const int SPEEDS = 13;			///< Speed axis, from minus to plus the maximum speed of the model
+	static const int MAX_CYCLES = 100;		///< Cycles stored for the points not reachable in the rollouts
+	/*!
+	 * @brief ReachTable constructor, loads the table from the cache or builds it
+	 * @param type Player type of the table
+	 */
+	ReachTable(const PlayerType* type);
+	/*!
+	 * @brief ReachTable default destructor
+	 */
+	~ReachTable();
+	/*!
+	 * @brief Returns the cycles needed to reach a point, the dash phase is interpolated in the table
+	 * @param distance Distance to the point
+	 * @param angle Direction of the point relative to the body (degrees)
+	 * @param speed Initial speed of the player along the body direction
+	 */
+	double getCycles(double distance, double angle, double speed) const;
+	/*!
+	 * @brief Returns the cycles given by the rollout of the simulator, the reference for the table
+	 * @param distance Distance to the point
+	 * @param angle Direction of the point relative to the body (degrees)
+	 * @param speed Initial speed of the player along the body direction
+	 */
+	int simulateCycles(double distance, double angle, double speed) const;
+	/*!
+	 * @brief Returns the maximum difference between getCycles and simulateCycles for any point
+	 */
+	double getErrorBound() const;
+	/*!
+	 * @brief Returns the hash of the model used to build the table
+	 */
+	unsigned long long getHash() const;
+	/*!
+	 * @brief Returns true if the table was read from the cache file
+	 */
+	bool isCached() const;
+	/*!
+	 * @brief Builds or loads the tables for all the player types received
+	 */
+	static void buildTables();
+	/*!
+	 * @brief Returns the table of a player type
+	 * @param type_id Type id
+	 * @return Table of the type, or the table of the default type if the type has no table
+	 */
+	static const ReachTable* getReachTable(int type_id);
+private:
+	Physics::Model model;
+	Physics::Simulator simulator;
+	unsigned long long hash;
+	bool cached;
+	double error_bound;
+	double speed_step;
+	float cycles[DISTANCES][SPEEDS];
+	int turnCycles(double distance, double angle, double speed, double &remaining, double &along) const;
+	int dashCycles(double distance, double speed) const;
+	void build();
+	bool load(const std::string &filename);
+	void save(const std::string &filename) const;
+	std::string getFilename() const;
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* REACHTABLE_HPP_ */
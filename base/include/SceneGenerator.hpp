@@ -0,0 +1,175 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file SceneGenerator.hpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#ifndef SCENEGENERATOR_HPP_
+#define SCENEGENERATOR_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/random.hpp>
+
+/*! @addtogroup phoenix_base
+ * @{
+ */
+namespace Phoenix {
+
+/*!
+ * @brief Ground truth state of a player or the ball at a given cycle
+ */
+struct SceneState {
+	double x;		///< Absolute position in x
+	double y;		///< Absolute position in y
+	double vx;		///< Absolute velocity in x
+	double vy;		///< Absolute velocity in y
+	double body;	///< Absolute body direction (degrees)
+	double neck;	///< Neck direction relative to the body (degrees)
+};
+
+/*!
+ * @brief <STRONG> SceneGenerator <BR> </STRONG>
+ * The SceneGenerator builds the messages a player would receive from the server for scripted
+ * ground truth trajectories, so the localization and tracking methods can be scored without a
+ * live server.  Trajectories are given as waypoints in the server coordinates (left side frame)
+ * and are linearly interpolated between them.  The see message follows the server rules: the view
+ * cone depends on the view width, distances are quantized with QUANTIZE_STEP (QUANTIZE_STEP_L for
+ * flags), directions are rounded and the team and uniform number of far players are hidden with
+ * the same probabilities used by the server.  The fullstate message supplies the matching truth.
+ * All the messages and states are expressed in the coordinate frame of the observer side.
+ */
+class SceneGenerator {
+public:
+	/*!
+	 * @brief SceneGenerator default constructor
+	 * @param team_l Name of the left team
+	 * @param team_r Name of the right team
+	 * @param seed Seed for the random visibility of far team names and uniform numbers
+	 */
+	SceneGenerator(std::string team_l, std::string team_r, unsigned int seed = 0);
+	/*!
+	 * @brief SceneGenerator default destructor
+	 */
+	~SceneGenerator();
+	/*!
+	 * @brief Removes all the trajectories
+	 */
+	void clear();
+	/*!
+	 * @brief Sets the player receiving the see and sense_body messages
+	 * @param side Side of the observer ('l' or 'r')
+	 * @param unum Uniform number of the observer
+	 */
+	void setObserver(char side, int unum);
+	/*!
+	 * @brief Sets the observer view width
+	 * @param width narrow, normal or wide
+	 */
+	void setViewWidth(std::string width);
+	/*!
+	 * @brief Adds a waypoint to the trajectory of a player
+	 * @param side Side of the player ('l' or 'r')
+	 * @param unum Uniform number of the player (1 is the goalie)
+	 * @param time Cycle of the waypoint
+	 * @param x Position in x
+	 * @param y Position in y
+	 * @param body Body direction (degrees)
+	 * @param neck Neck direction relative to the body (degrees)
+	 */
+	void addWaypoint(char side, int unum, int time, double x, double y, double body, double neck = 0.0);
+	/*!
+	 * @brief Adds a waypoint to the trajectory of the ball
+	 * @param time Cycle of the waypoint
+	 * @param x Position in x
+	 * @param y Position in y
+	 */
+	void addBallWaypoint(int time, double x, double y);
+	/*!
+	 * @brief Replaces the trajectories with random ones for the 22 players and the ball
+	 * @param cycles Length of the scene in cycles
+	 */
+	void randomize(int cycles);
+	/*!
+	 * @brief Returns the ground truth of a player in the observer frame
+	 * @param side Side of the player ('l' or 'r')
+	 * @param unum Uniform number of the player
+	 * @param time Cycle of the state
+	 * @return State of the player, or a zero state if the player has no trajectory
+	 */
+	SceneState getPlayerState(char side, int unum, int time) const;
+	/*!
+	 * @brief Returns the ground truth of the ball in the observer frame
+	 * @param time Cycle of the state
+	 */
+	SceneState getBallState(int time) const;
+	/*!
+	 * @brief Returns the ground truth of the observer in its own frame
+	 * @param time Cycle of the state
+	 */
+	SceneState getObserverState(int time) const;
+	/*!
+	 * @brief Returns the see message received by the observer
+	 * @param time Cycle of the message
+	 */
+	std::string getSee(int time);
+	/*!
+	 * @brief Returns the sense_body message received by the observer
+	 * @param time Cycle of the message
+	 */
+	std::string getSenseBody(int time) const;
+	/*!
+	 * @brief Returns the fullstate message with the ground truth of the scene
+	 * @param time Cycle of the message
+	 */
+	std::string getFullstate(int time) const;
+	/*!
+	 * @brief Returns the number of cycles covered by the trajectories
+	 */
+	int getCycles() const;
+	double unum_far_length;			///< Distance up to the uniform number is always seen (server default 20)
+	double unum_too_far_length;		///< Distance from the uniform number is never seen (server default 40)
+	double team_far_length;			///< Distance up to the team name is always seen (server default 40)
+	double team_too_far_length;		///< Distance from the team name is never seen (server default 60)
+private:
+	struct _waypoint {
+		int time;
+		double x;
+		double y;
+		double body;
+		double neck;
+	};
+	std::string team_l;
+	std::string team_r;
+	char observer_side;
+	int observer_unum;
+	std::string view_width;
+	std::vector<_waypoint> players[2][12];
+	std::vector<_waypoint> ball;
+	boost::mt19937 rng;
+	SceneState interpolate(const std::vector<_waypoint> &trajectory, int time) const;
+	SceneState toObserverFrame(SceneState state) const;
+};
+
+} // End namespace Phoenix
+/*! @} */
+
+#endif /* SCENEGENERATOR_HPP_ */
@@ -38,6 +38,63 @@
 namespace Phoenix {
 
 class Command;
+class PlayerType;
+
+/*!
+ * @brief Confirmation statistics for a command type
+ */
+struct CommandStats {
+	unsigned int sent;			///< Commands sent to the server
+	unsigned int executed;		///< Commands confirmed by the sense_body sensor
+	unsigned int lost;			///< Commands sent but not executed by the server
+	unsigned int overridden;	///< Commands replaced by another command of the same type before being confirmed
+};
+
+/*!
+ * @brief Collisions reported by the sense_body sensor, they are combined in SenseBody::collisions
+ */
+enum COLLISION_FLAGS {
+	COLLISION_NONE   = 0,	///< No collision
+	COLLISION_BALL   = 1,	///< Collision with the ball
+	COLLISION_PLAYER = 2,	///< Collision with a player
+	COLLISION_POST   = 4	///< Collision with a goal post
+};
+
+/*!
+ * @brief Information received in a sense_body sensor
+ * The record does not hold pointers, so the history is kept in a single ring of records.
+ */
+struct SenseBody {
+	int    time;					///< Simulation time of the sensor
+	char   view_mode_quality[8];	///< View quality (high or low)
+	char   view_mode_width[8];		///< View width (narrow, normal or wide)
+	double stamina;					///< Player stamina
+	double effort;					///< Player effort
+	double stamina_capacity;		///< Player stamina capacity
+	double amount_of_speed;			///< Amount of speed
+	double direction_of_speed;		///< Direction of speed relative to the head
+	double head_angle;				///< Neck angle relative to the body
+	int    kick_count;				///< Kick commands executed
+	int    dash_count;				///< Dash commands executed
+	int    turn_count;				///< Turn commands executed
+	int    say_count;				///< Say commands executed
+	int    turn_neck_count;			///< Turn neck commands executed
+	int    catch_count;				///< Catch commands executed
+	int    move_count;				///< Move commands executed
+	int    change_view_count;		///< Change view commands executed
+	int    arm_movable;				///< Cycles until the arm can be moved
+	int    arm_expires;				///< Cycles until the arm stops pointing
+	double arm_dist;				///< Distance of the point target
+	double arm_dir;					///< Direction of the point target
+	int    arm_count;				///< Point to commands executed
+	char   focus_target[8];			///< Focus target (none or side and uniform number)
+	int    focus_count;				///< Attention to commands executed
+	int    tackle_expires;			///< Cycles until the player can move after a tackle
+	int    tackle_count;			///< Tackle commands executed
+	int    collisions;				///< Collisions as a combination of COLLISION_FLAGS
+	int    foul_charged;			///< Fouls charged
+	char   foul_card[8];			///< Card received (none, yellow or red)
+};
 
 /*!
  * @brief <STRONG> Self <BR> </STRONG>
@@ -261,6 +318,28 @@ public:
 	 * @param time The time delay
 	 */
 	static std::string getFoulCardAtTime(unsigned int time);
+	/*!
+	 * @brief Returns the sense_body record at time Game::SIMULATION_TIME - time
+	 * @param time The time delay
+	 * @return Pointer to the record, or 0 if the time delay is beyond the history
+	 */
+	static const SenseBody* getSenseBodyAtTime(unsigned int time);
+	/*!
+	 * @brief Copies the last values of a field of the sense_body records, the newest first
+	 * @param field Field to copy, for example &SenseBody::stamina
+	 * @param values Array with room for cycles values
+	 * @param cycles Number of cycles requested
+	 * @return Number of values copied, limited by the history size
+	 */
+	static unsigned int getHistory(double SenseBody::*field, double* values, unsigned int cycles);
+	/*!
+	 * @brief Copies the last values of a field of the sense_body records, the newest first
+	 * @param field Field to copy, for example &SenseBody::dash_count
+	 * @param values Array with room for cycles values
+	 * @param cycles Number of cycles requested
+	 * @return Number of values copied, limited by the history size
+	 */
+	static unsigned int getHistory(int SenseBody::*field, int* values, unsigned int cycles);
 	/*!
 	 * @brief Returns a pointer to the agent current absolute position
 	 */
@@ -274,6 +353,23 @@ public:
 	 * @param last_commands_sent List of commands sent
 	 */
 	static void setLastCommandsSet(std::list<Command*> last_commands_sent);
+	/*!
+	 * @brief Informs the object about the last commands sent to the server without allocating memory
+	 * @param last_commands_sent Array of commands sent
+	 * @param size Number of commands sent, at most Commands::QUEUE_SIZE
+	 */
+	static void setLastCommandsSet(Command** last_commands_sent, int size);
+	/*!
+	 * @brief Returns the confirmation statistics for a command type
+	 * @param command_type COMMAND_TYPE of the commands
+	 */
+	static CommandStats getCommandStats(int command_type);
+	/*!
+	 * @brief Returns the fraction of the commands of a type that were sent but never executed
+	 * @param command_type COMMAND_TYPE of the commands
+	 * The overridden commands are counted as lost.
+	 */
+	static double getCommandLossRate(int command_type);
 	/*!
 	 * @brief Self default constructor
 	 * @param player_params Player parameters string received from the server
@@ -301,6 +397,10 @@ public:
 	 * @param type Type id to be changed
 	 */
 	void changePlayerType(int type);
+	/*!
+	 * @brief Returns the current player type with its derived capabilities
+	 */
+	static const PlayerType* getPlayerType();
 	/*!
 	 * @brief Localize the player using the flags provided by the see sensor
 	 * @param flags List of flags seen by the see sensor
@@ -25,6 +25,7 @@
 #ifndef WORLDMODEL_HPP_
 #define WORLDMODEL_HPP_
 
+#include <string>
 #include <vector>
 #include "Player.hpp"
 #include "Ball.hpp"
@@ -34,17 +35,45 @@
  */
 namespace Phoenix {
 
+class WorldModel;
+
+/*!
+ * @brief Features computed by the WorldModel, the player features return the index of the player in
+ * WorldModel::getPlayers(), WorldModel::NO_PLAYER or WorldModel::SELF_PLAYER
+ */
+enum FEATURE {
+	OUR_NEAREST_TO_BALL,	///< Teammate nearest to the ball, the agent excluded
+	OPP_NEAREST_TO_BALL,	///< Opponent nearest to the ball
+	OFFSIDE_LINE,			///< Offside line in x, the second last opponent or the ball and never behind the half line
+	DEFENSIVE_LINE,			///< Position in x of our last field player, the agent included
+	FASTEST_INTERCEPTOR,	///< Player that reaches the ball first, from the Interception module
+	FASTEST_CYCLES,			///< Cycles of the fastest interceptor, -1 if nobody reaches the ball
+	BALL_OWNER,				///< Nearest player with the ball inside its kick-able area
+	BUILTIN_FEATURES		///< Number of built in features, the registered ones come after
+};
+
+/*!
+ * @brief Function that computes a feature of a world model
+ */
+typedef double (*feature)(WorldModel &world_model);
+
  /*!
  * @brief <STRONG> WorldModel <BR> </STRONG>
  * A WorldModel object stores information about the current state of the world.  It includes information
  * about players and the ball received in the see sensor along with information about players and the ball
- * received in the full state sensor.
+ * received in the full state sensor.  Each world model built by the World is a new snapshot, the copies
+ * passed to the handlers share it.  The features (derived values like the offside line) are computed
+ * the first time they are requested for a snapshot and the next requests in the snapshot return the
+ * cached value, more features can be registered by the behaviors.  The cache is not thread safe, the
+ * features must be requested before spreading the work in the task pool.
  */
 class WorldModel {
 public:
 	int real_matches;
 	int method_matches;
 	int correct_matches;
+	static const int NO_PLAYER = -1;	///< Player feature without player
+	static const int SELF_PLAYER = -2;	///< Player feature for the agent
 	/*!
 	 * @brief Constructor deprecated
 	 * @param players List of current players received in the see sensor
@@ -68,6 +97,16 @@ public:
 	 * @return List of all players
 	 */
 	std::vector<Player*> getPlayers();
+	/*!
+	 * @brief Returns the number of current players, they are accessed with getPlayer without building a list
+	 */
+	int getPlayersCount();
+	/*!
+	 * @brief Returns a current player in the order of getPlayers
+	 * @param index Index of the player (0 - getPlayersCount())
+	 * @return Pointer to the player, null if the index is out of range
+	 */
+	Player* getPlayer(int index);
 	/*!
 	 * @brief Returns list of all current players ordered from nearest to farthest in function of the position
 	 * @param position Position anchor to order the players
@@ -140,7 +179,45 @@ public:
 	 * This method returns the ball with exact data iff the full state sensor is enabled
 	 */
 	Ball* getExactBall();
+	/*!
+	 * @brief Returns the value of a feature, computed once per snapshot
+	 * @param id Feature id, a FEATURE or an id returned by registerFeature
+	 * @return Value of the feature, 0 if the id is not registered
+	 */
+	double getFeature(int id);
+	/*!
+	 * @brief Returns the value of a feature by name
+	 * @param name Name used to register the feature
+	 */
+	double getFeature(std::string name);
+	/*!
+	 * @brief Returns the player of a player feature
+	 * @param id Feature id
+	 * @return Pointer to the player, null for the agent or if there is no player
+	 */
+	Player* getFeaturePlayer(int id);
+	/*!
+	 * @brief Forces the features of the snapshot, and the interceptions they read, to be computed again
+	 */
+	void invalidateFeatures();
+	/*!
+	 * @brief Returns the snapshot of the world model
+	 */
+	unsigned long getSnapshot() const;
+	/*!
+	 * @brief Registers a feature, the name of a registered feature replaces its function
+	 * @param name Name of the feature
+	 * @param function Function that computes the feature
+	 * @return Id of the feature
+	 */
+	static int registerFeature(std::string name, feature function);
+	/*!
+	 * @brief Returns the id of a feature, -1 if it is not registered
+	 * @param name Name of the feature
+	 */
+	static int getFeatureId(std::string name);
 private:
+	unsigned long snapshot;			///< Snapshot id shared by the copies
 	std::vector<Player> players;	///< Current player in the see sensor
 	std::vector<Player> fs_players;	///< Current player in the full state sensor
 	Ball ball;						///< Current ball in the see sensor
@@ -24,12 +24,19 @@
 
 #include "Command.hpp"
 #include "Game.hpp"
+#include "Configs.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
 namespace Phoenix {
 
+const int Command::BUFFER_SIZE;
+
 Command::Command() {
-	command = "(error)";
+	std::strcpy(command, "(error)");
+	length = 7;
 	weight = 1;
 	type = EMPTY;
 	double_arg_0 = 0.0;
@@ -43,7 +50,6 @@ Command::Command() {
 }
 
 Command::Command(std::string command, int weight, COMMAND_TYPE type) { //, void* ... args) {
-	this->command = command;
 	this->weight = weight;
 	this->type = type;
 	double_arg_0 = 0.0;
@@ -54,12 +60,102 @@ Command::Command(std::string command, int weight, COMMAND_TYPE type) { //, void*
 	bool_arg_1 = false;
 	status = CREATED;
 	simulation_time = Game::SIMULATION_TIME;
+	this->command[0] = '\0';
+	length = 0;
+	append(command.c_str());
 }
 
 Command::~Command() {
 
 }
 
+void Command::reset(int weight, COMMAND_TYPE type) {
+	command[0] = '\0';
+	length = 0;
+	this->weight = weight;
+	this->type = type;
+	double_arg_0 = 0.0;
+	double_arg_1 = 0.0;
+	bool_arg_0 = false;
+	bool_arg_1 = false;
+	status = CREATED;
+	simulation_time = Game::SIMULATION_TIME;
+}
+
+void Command::append(const char* text) {
+	int size = std::strlen(text);
+	if (length + size >= BUFFER_SIZE) {
+		std::cerr << "Command::append(const char*) -> command too long" << std::endl;
+		status = ERROR;
+		return;
+	}
+	std::memcpy(command + length, text, size + 1);
+	length += size;
+}
+
+void Command::append(double value) {
+	unsigned int precision = Configs::COMMAND_PRECISION;
+	if (precision < 1) precision = 1;
+	if (precision > 15) precision = 15;
+	if (!(std::fabs(value) < 1.0e15)) {
+		// Not representable in fixed notation, this should never be sent to the server
+		char text[32];
+		std::snprintf(text, sizeof(text), "%.*g", precision, value);
+		append(text);
+		return;
+	}
+	// Digits of the integer part, the remaining significant digits are decimals
+	double absolute = std::fabs(value);
+	unsigned int decimals = 0;
+	if (absolute >= 1.0) {
+		unsigned int digits = 1;
+		for (double limit = 10.0; absolute >= limit && digits < 16; limit *= 10.0) {
+			digits++;
+		}
+		decimals = (digits < precision) ? precision - digits : 0;
+	} else if (absolute > 0.0) {
+		// The zeros after the point are not significant
+		unsigned int zeros = 0;
+		for (double limit = 0.1; absolute < limit && zeros < 19; limit /= 10.0) {
+			zeros++;
+		}
+		decimals = precision + zeros;
+		if (decimals > 18) {
+			// Too small for the fixed notation
+			char text[32];
+			std::snprintf(text, sizeof(text), "%.*g", precision, value);
+			append(text);
+			return;
+		}
+	}
+	unsigned long long scale = 1;
+	for (unsigned int i = 0; i < decimals; ++i) {
+		scale *= 10;
+	}
+	unsigned long long scaled = (unsigned long long)(absolute * scale + 0.5);
+	unsigned long long integer = scaled / scale;
+	unsigned long long fraction = scaled % scale;
+	// Trailing zeros are not written
+	while (decimals > 0 && fraction % 10 == 0) {
+		fraction /= 10;
+		decimals--;
+	}
+	char text[48];
+	char* p = text + sizeof(text);
+	*--p = '\0';
+	for (unsigned int i = 0; i < decimals; ++i) {
+		*--p = '0' + (char)(fraction % 10);
+		fraction /= 10;
+	}
+	if (decimals > 0) *--p = '.';
+	do {
+		*--p = '0' + (char)(integer % 10);
+		integer /= 10;
+	} while (integer > 0);
+	if (value < 0.0 && scaled > 0) *--p = '-';
+	append(p);
+}
+
 void Command::setArgs(void* arg0, void* arg1, void* arg2) {
 	switch(type) {
 	case MOVE:
@@ -88,9 +184,17 @@ void Command::setArgs(void* arg0, void* arg1, void* arg2) {
 }
 
 std::string Command::getCommand() {
+	return std::string(command, length);
+}
+
+const char* Command::getCommandBuffer() const {
 	return command;
 }
 
+int Command::getCommandLength() const {
+	return length;
+}
+
 int Command::getWeight() {
 	return weight;
 }
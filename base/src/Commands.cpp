@@ -24,8 +24,8 @@
 
 #include <iostream>
 #include <sstream>
-#include <iomanip>
-#include <list>
+#include <cstring>
+#include <pthread.h>
 #include "Commands.hpp"
 #include "Command.hpp"
 #include "Connect.hpp"
@@ -38,12 +38,77 @@
 namespace Phoenix {
 
 Connect* commands_connect_ptr = 0;
-std::list<Command> commands_history;
-std::list<Command*> commands_to_send;
+static Command* commands_ring = 0;
+static unsigned int commands_ring_size = 0;
+static unsigned int commands_ring_next = 0;
+static Command* commands_to_send[Commands::QUEUE_SIZE];
+static int commands_to_send_size = 0;
+static Command* commands_sent[Commands::QUEUE_SIZE];
+static char datagram[Commands::QUEUE_SIZE * Command::BUFFER_SIZE];
 std::ofstream comm_stream;
+static pthread_mutex_t commands_mutex;
+static bool sent_on_deadline = false;
+
+const int Commands::QUEUE_SIZE;
+
+/*
+ * Holds the commands mutex while it is in scope, the mutex is recursive so a behavior holding
+ * the queue with Commands::lock() can still queue commands
+ */
+class CommandsLock {
+public:
+	CommandsLock() {
+		if (pthread_mutex_lock(&commands_mutex) != 0) {
+			std::cerr << "Commands::CommandsLock() -> can not lock mutex" << std::endl;
+		}
+	}
+	~CommandsLock() {
+		if (pthread_mutex_unlock(&commands_mutex) != 0) {
+			std::cerr << "Commands::~CommandsLock() -> can not unlock mutex" << std::endl;
+		}
+	}
+};
+
+/*
+ * Takes the oldest command of the ring and puts it in queue, returns 0 if the queue is full
+ */
+static Command* queueCommand(int weight, COMMAND_TYPE type) {
+	if (commands_to_send_size == Commands::QUEUE_SIZE) {
+		std::cerr << "Commands::queueCommand(int, COMMAND_TYPE) -> commands queue is full" << std::endl;
+		return 0;
+	}
+	Command* command = &commands_ring[commands_ring_next];
+	commands_ring_next = (commands_ring_next + 1) % commands_ring_size;
+	command->reset(weight, type);
+	commands_to_send[commands_to_send_size++] = command;
+	return command;
+}
+
+/*
+ * Drops the queued commands and gives their entries back to the ring, they are always the last
+ * ones taken from it and were never sent
+ */
+static void dropQueued() {
+	commands_ring_next = (commands_ring_next + commands_ring_size - commands_to_send_size) % commands_ring_size;
+	commands_to_send_size = 0;
+}
 
 Commands::Commands(Connect *connect) {
 	commands_connect_ptr = connect;
+	// At most QUEUE_SIZE entries are taken per sent set because dropped commands give theirs
+	// back, so the commands sent in the last COMMANDS_MAX_HISTORY cycles are never overwritten
+	commands_ring_size = (Configs::COMMANDS_MAX_HISTORY + 2) * Commands::QUEUE_SIZE;
+	commands_ring = new Command[commands_ring_size];
+	commands_ring_next = 0;
+	commands_to_send_size = 0;
+	sent_on_deadline = false;
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	if (pthread_mutex_init(&commands_mutex, &attr) != 0) {
+		std::cerr << "Commands::Commands(Connect*) -> can not create mutex" << std::endl;
+	}
+	pthread_mutexattr_destroy(&attr);
 	if (Configs::SAVE_COMMANDS) {
 		std::stringstream ss;
 		ss << Self::TEAM_NAME << "_" << Self::UNIFORM_NUMBER << "_" << std::endl;
@@ -58,55 +123,59 @@ Commands::~Commands() {
 	if (Configs::SAVE_COMMANDS) {
 		comm_stream.close();
 	}
+	delete[] commands_ring;
+	commands_ring = 0;
+	pthread_mutex_destroy(&commands_mutex);
 }
 
 void Commands::flush() {
-	while (commands_history.size() > 0 && Game::SIMULATION_TIME - commands_history.front().createdAt() > Configs::COMMANDS_MAX_HISTORY) {
-		commands_history.pop_front();
-	}
+
 }
 
 void Commands::move(double x, double y) {
-	std::stringstream ss;
-	ss << "(move " << std::setprecision(4) << x << " " << y << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, MOVE));
-	commands_history.back().setArgs((void *)&x, (void *)&y);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, MOVE);
+	if (!command) return;
+	command->append("(move ");
+	command->append(x);
+	command->append(" ");
+	command->append(y);
+	command->append(")");
+	command->setArgs((void *)&x, (void *)&y);
 }
 
 void Commands::turn(double moment) {
+	CommandsLock lock;
 	if (moment < Server::MINMOMENT) {
 		moment = Server::MINMOMENT;
 	} else if (moment > Server::MAXMOMENT) {
 		moment = Server::MAXMOMENT;
 	}
-	std::stringstream ss;
-	ss << "(turn " << std::setprecision(4) << moment << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, TURN));
-	commands_history.back().setArgs((void *)&moment);
-	commands_to_send.push_back(&commands_history.back());
+	Command* command = queueCommand(1, TURN);
+	if (!command) return;
+	command->append("(turn ");
+	command->append(moment);
+	command->append(")");
+	command->setArgs((void *)&moment);
 }
 
 void Commands::turnNeck(double moment) {
+	CommandsLock lock;
 	if (moment < Server::MINMOMENT) {
 		moment = Server::MINMOMENT;
 	} else if (moment > Server::MAXMOMENT) {
 		moment = Server::MAXMOMENT;
 	}
-	std::stringstream ss;
-	ss << "(turn_neck " << std::setprecision(4) << moment << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 0, TURN_NECK));
-	commands_history.back().setArgs((void *)&moment);
-	commands_to_send.push_back(&commands_history.back());
+	Command* command = queueCommand(0, TURN_NECK);
+	if (!command) return;
+	command->append("(turn_neck ");
+	command->append(moment);
+	command->append(")");
+	command->setArgs((void *)&moment);
 }
 
 void Commands::dash(double power, double direction) {
+	CommandsLock lock;
 	if (power > Server::MAXPOWER) {
 		power = Server::MAXPOWER;
 	} else if (power < Server::MINPOWER) {
@@ -117,120 +186,171 @@ void Commands::dash(double power, double direction) {
 	} else if (direction < Server::MINMOMENT) {
 		direction = Server::MINMOMENT;
 	}
-	std::stringstream ss;
-	ss << "(dash " << std::setprecision(4) << power << " " << direction << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, DASH));
-	commands_history.back().setArgs((void *)&power, (void *)&direction);
-	commands_to_send.push_back(&commands_history.back());
+	Command* command = queueCommand(1, DASH);
+	if (!command) return;
+	command->append("(dash ");
+	command->append(power);
+	command->append(" ");
+	command->append(direction);
+	command->append(")");
+	command->setArgs((void *)&power, (void *)&direction);
 }
 
 void Commands::say(std::string message) {
-	std::string command = "(say \"" + message + "\")";
-	commands_history.push_back(Command(command, 0, SAY));
-	commands_history.back().setArgs((void *)&message);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(0, SAY);
+	if (!command) return;
+	command->append("(say \"");
+	command->append(message.c_str());
+	command->append("\")");
+	command->setArgs((void *)&message);
 }
 
 void Commands::catchBall(double direction) {
-	std::stringstream ss;
-	ss << "(catch " << std::setprecision(4) << direction << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, CATCH));
-	commands_history.back().setArgs((void *)&direction);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, CATCH);
+	if (!command) return;
+	command->append("(catch ");
+	command->append(direction);
+	command->append(")");
+	command->setArgs((void *)&direction);
 }
 
 void Commands::kick(double power, double direction) {
-	std::stringstream ss;
-	ss << "(kick " << std::setprecision(4) << power << " " << direction << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, KICK));
-	commands_history.back().setArgs((void *)&power, (void *)&direction);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, KICK);
+	if (!command) return;
+	command->append("(kick ");
+	command->append(power);
+	command->append(" ");
+	command->append(direction);
+	command->append(")");
+	command->setArgs((void *)&power, (void *)&direction);
 }
 
 void Commands::tackle(double power, bool willToFoul) {
-	std::stringstream ss;
-	ss << "(tackle " << std::setprecision(4) << power << (willToFoul ? " true" : " false") << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, TACKLE));
-	commands_history.back().setArgs((void *)&power, (void *)&willToFoul);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, TACKLE);
+	if (!command) return;
+	command->append("(tackle ");
+	command->append(power);
+	command->append(willToFoul ? " true)" : " false)");
+	command->setArgs((void *)&power, (void *)&willToFoul);
 }
 
 void Commands::pointTo(double distance, double direction) {
-	std::stringstream ss;
-	ss << "(pointto " << std::setprecision(4) << distance << " " << direction << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, POINT));
-	commands_history.back().setArgs((void *)&distance, (void *)&direction);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, POINT);
+	if (!command) return;
+	command->append("(pointto ");
+	command->append(distance);
+	command->append(" ");
+	command->append(direction);
+	command->append(")");
+	command->setArgs((void *)&distance, (void *)&direction);
 }
 
 void Commands::changeView(std::string width) {
-	std::string command = "(change_view " + width + ")";
-	commands_history.push_back(Command(command, 0, CHANGE_VIEW));
-	commands_history.back().setArgs((void *)&width);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(0, CHANGE_VIEW);
+	if (!command) return;
+	command->append("(change_view ");
+	command->append(width.c_str());
+	command->append(")");
+	command->setArgs((void *)&width);
 }
 
 void Commands::moveObject(std::string object, double x, double y) {
-	std::stringstream ss;
-	ss << "(move " << object << " " << std::setprecision(4) << x << " " << y << ")" << std::endl;
-	std::string command;
-	std::getline(ss, command);
-	commands_history.push_back(Command(command, 1, MOVE_OBJECT));
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, MOVE_OBJECT);
+	if (!command) return;
+	command->append("(move ");
+	command->append(object.c_str());
+	command->append(" ");
+	command->append(x);
+	command->append(" ");
+	command->append(y);
+	command->append(")");
 }
 
 void Commands::changeMode(std::string mode) {
-	std::string command = "(change_mode " + mode + ")";
-	commands_history.push_back(Command(command, 1, CHANGE_MODE));
-	commands_history.back().setArgs((void *)&mode);
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, CHANGE_MODE);
+	if (!command) return;
+	command->append("(change_mode ");
+	command->append(mode.c_str());
+	command->append(")");
+	command->setArgs((void *)&mode);
 }
 
 void Commands::start() {
-	std::string command = "(start)";
-	commands_history.push_back(Command(command, 1, START));
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, START);
+	if (!command) return;
+	command->append("(start)");
 }
 
 void Commands::recover() {
-	std::string command = "(recover)";
-	commands_history.push_back(Command(command, 1, RECOVER));
-	commands_to_send.push_back(&commands_history.back());
+	CommandsLock lock;
+	Command* command = queueCommand(1, RECOVER);
+	if (!command) return;
+	command->append("(recover)");
+}
+
+void Commands::clear() {
+	CommandsLock lock;
+	dropQueued();
+}
+
+void Commands::lock() {
+	if (pthread_mutex_lock(&commands_mutex) != 0) {
+		std::cerr << "Commands::lock() -> can not lock mutex" << std::endl;
+	}
+}
+
+void Commands::unlock() {
+	if (pthread_mutex_unlock(&commands_mutex) != 0) {
+		std::cerr << "Commands::unlock() -> can not unlock mutex" << std::endl;
+	}
+}
+
+int Commands::sendOnDeadline() {
+	CommandsLock lock;
+	int sent = sendCommands();
+	sent_on_deadline = true;
+	return sent;
 }
 
 int Commands::sendCommands() {
+	CommandsLock lock;
+	// The commands of this cycle were already sent by the watchdog, the late ones are dropped
+	if (sent_on_deadline) {
+		sent_on_deadline = false;
+		dropQueued();
+		return 0;
+	}
 	int commands_sent_counter = 0;
-	std::list<Command*> commands_sent;
+	int length = 0;
+	int weight = 0;
 	if (Configs::SAVE_COMMANDS) comm_stream << Game::GAME_TIME << ": ";
-	if (commands_to_send.size() > 0) {
-		std::string message = "";
-		int weight = 0;
-		do {
-			Command* command_to_send = commands_to_send.front();
-			weight += command_to_send->getWeight();
-			if (weight < 2) {
-				command_to_send->changeStatusTo(SENT);
-				message += command_to_send->getCommand();
-				commands_sent.push_back(command_to_send);
-				commands_to_send.pop_front();
-				commands_sent_counter++;
-			}
-		} while (weight < 2 && commands_to_send.size() > 0);
-		if (Configs::SAVE_COMMANDS) comm_stream << message;
-		commands_connect_ptr->sendMessage(message);
+	for (int i = 0; i < commands_to_send_size; ++i) {
+		Command* command_to_send = commands_to_send[i];
+		// A command that did not fit in its buffer is never sent
+		if (command_to_send->getCommandStatus() == ERROR) continue;
+		weight += command_to_send->getWeight();
+		if (weight > 1) break;
+		std::memcpy(datagram + length, command_to_send->getCommandBuffer(), command_to_send->getCommandLength());
+		length += command_to_send->getCommandLength();
+		command_to_send->changeStatusTo(SENT);
+		commands_sent[commands_sent_counter++] = command_to_send;
+	}
+	datagram[length] = '\0';
+	if (commands_sent_counter > 0) {
+		if (Configs::SAVE_COMMANDS) comm_stream << datagram;
+		commands_connect_ptr->sendMessage(datagram, length);
 	}
-	commands_to_send.clear(); //we clear the commands to send queue
-	Self::setLastCommandsSet(commands_sent);
+	commands_to_send_size = 0; //we clear the commands to send queue
+	Self::setLastCommandsSet(commands_sent, commands_sent_counter);
 	if (Configs::SAVE_COMMANDS) comm_stream << std::endl;
 	return commands_sent_counter;
 }
@@ -53,6 +53,11 @@ bool Configs::TRAINER_LOGGING = false;
 bool Configs::VERBOSE = false;
 std::string Configs::LOCALIZATION = "lowpassfilter";
 std::string Configs::TRACKING = "qualifier";
+std::string Configs::REACH_CACHE = "/tmp";
+unsigned int Configs::DEADLINE_MARGIN = 5;
+bool Configs::WATCHDOG = true;
+unsigned int Configs::THREADS = 1;
+bool Configs::AFFINITY = false;
 bool Configs::SAVE_SEE = false;
 bool Configs::SAVE_HEAR = false;
 bool Configs::SAVE_FULLSTATE = false;
@@ -82,6 +87,9 @@ bool Configs::SAVE_COMMANDS = false;
  *      "offset": 20,
  *      "localization": "lowpassfilter"
  *    }
+ *    "reach": {
+ *      "cache": "/tmp"
+ *    }
  *  }
  *  }
  */
@@ -112,6 +120,11 @@ void Configs::loadConfigs(std::string filename) {
 			std::cout << "Using " << Configs::TRACKING << std::endl;
 			Configs::LOCALIZATION         = pt.get("configs.self.localization", "lowpassfilter");
 			Configs::TRACKING_THRESHOLD   = pt.get("configs.world.threshold", 1.50);
+			Configs::REACH_CACHE          = pt.get("configs.reach.cache", "/tmp");
+			Configs::DEADLINE_MARGIN      = pt.get("configs.self.margin", 5);
+			Configs::WATCHDOG             = pt.get("configs.self.watchdog", true);
+			Configs::THREADS              = pt.get("configs.threads.count", 1);
+			Configs::AFFINITY             = pt.get("configs.threads.affinity", false);
 			file.close();
 		}
 		catch (std::exception const &e) {
@@ -89,9 +89,12 @@ void Connect::disconnect() {
 }
 
 bool Connect::sendMessage(std::string msg) {
-	int size = msg.size() + 1;
-	if (sendto(sock.socketfd, msg.c_str(), size, 0, (struct sockaddr *)&sock.server, sizeof(sock.server)) < 0) {
-		std::cerr << "Connect::sendMessage(string) -> error sending message" << std::endl;
+	return sendMessage(msg.c_str(), msg.size());
+}
+
+bool Connect::sendMessage(const char* msg, int length) {
+	if (sendto(sock.socketfd, msg, length + 1, 0, (struct sockaddr *)&sock.server, sizeof(sock.server)) < 0) {
+		std::cerr << "Connect::sendMessage(const char*, int) -> error sending message" << std::endl;
 		return false;
 	}
 	return true;
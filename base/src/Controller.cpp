@@ -26,11 +26,15 @@
 #include <boost/regex.hpp>
 #include <iostream>
 #include <cstdlib>
+#include <pthread.h>
+#include <sys/time.h>
 #include "Connect.hpp"
 #include "Self.hpp"
 #include "Reader.hpp"
 #include "Server.hpp"
 #include "Parser.hpp"
+#include "KickPlanner.hpp"
+#include "ReachTable.hpp"
 #include "Commands.hpp"
 #include "PlayMode.hpp"
 #include "World.hpp"
@@ -40,6 +44,7 @@
 #include <map>
 #include "Configs.hpp"
 #include "Logger.hpp"
+#include "TaskPool.hpp"
 #include "Trainer.cpp"
 
 namespace Phoenix {
@@ -61,6 +66,79 @@ static Server* _server = 0;
 static Connect* _connect = 0;
 std::string team_name = "";
 
+/* Watchdog of the cycle deadline */
+static pthread_t watchdog_thread;
+static pthread_mutex_t watchdog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t watchdog_cond = PTHREAD_COND_INITIALIZER;
+static bool watchdog_running = false;
+static bool executing = false;
+static unsigned int executing_time = 0;
+
+/*
+ * Sleeps until the deadline of the cycle being executed, if the handler did not return the
+ * commands queued so far are sent and the late ones are dropped
+ */
+static void* watchdog(void*) {
+	if (pthread_mutex_lock(&watchdog_mutex) != 0) {
+		std::cerr << "Controller::watchdog(void*) -> can not lock mutex" << std::endl;
+		return 0;
+	}
+	while (watchdog_running) {
+		if (!executing) {
+			if (pthread_cond_wait(&watchdog_cond, &watchdog_mutex) != 0) {
+				std::cerr << "Controller::watchdog(void*) -> can not wait for condition" << std::endl;
+				break;
+			}
+			continue;
+		}
+		double remaining = Game::getRemainingTime();
+		if (remaining > 0.0) {
+			struct timeval now;
+			gettimeofday(&now, 0);
+			long usec = now.tv_usec + (long)(remaining * 1000.0);
+			struct timespec deadline;
+			deadline.tv_sec = now.tv_sec + usec / 1000000;
+			deadline.tv_nsec = (usec % 1000000) * 1000;
+			pthread_cond_timedwait(&watchdog_cond, &watchdog_mutex, &deadline);
+			continue;
+		}
+		int sent = _commands->sendOnDeadline();
+		std::cerr << executing_time << ": Controller::watchdog(void*) -> handler overrun, " << sent << " commands sent at the deadline" << std::endl;
+		executing = false;
+	}
+	if (pthread_mutex_unlock(&watchdog_mutex) != 0) {
+		std::cerr << "Controller::watchdog(void*) -> can not unlock mutex" << std::endl;
+	}
+	return 0;
+}
+
+static void setExecuting(bool value) {
+	if (pthread_mutex_lock(&watchdog_mutex) != 0) {
+		std::cerr << "Controller::setExecuting(bool) -> can not lock mutex" << std::endl;
+		return;
+	}
+	executing = value;
+	executing_time = Game::SIMULATION_TIME;
+	if (pthread_cond_signal(&watchdog_cond) != 0) {
+		std::cerr << "Controller::setExecuting(bool) -> can not signal to the watchdog" << std::endl;
+	}
+	if (pthread_mutex_unlock(&watchdog_mutex) != 0) {
+		std::cerr << "Controller::setExecuting(bool) -> can not unlock mutex" << std::endl;
+	}
+}
+
+static void stopWatchdog() {
+	if (!watchdog_running) return;
+	if (pthread_mutex_lock(&watchdog_mutex) != 0) {
+		std::cerr << "Controller::stopWatchdog() -> can not lock mutex" << std::endl;
+		return;
+	}
+	watchdog_running = false;
+	pthread_cond_signal(&watchdog_cond);
+	pthread_mutex_unlock(&watchdog_mutex);
+	pthread_join(watchdog_thread, 0);
+}
+
 char Controller::AGENT_TYPE = 'p';
 
 Controller::Controller(std::string teamName, char agentType, std::string hostname) {
@@ -150,6 +228,10 @@ void Controller::connect() {
 			message = _connect->receiveMessage(); //player_type
 			_self->addPlayerType(message);
 		}
+		if (Controller::AGENT_TYPE == 'p' || Controller::AGENT_TYPE == 'g') {
+			ReachTable::buildTables();
+			KickPlanner::buildTables(Self::getPlayerType());
+		}
 		switch (Controller::AGENT_TYPE) {
 		case 'p':
 			//A player use synchronized view as default
@@ -237,7 +319,16 @@ void Controller::run() {
 			ai = &player;
 			break;
 		}
+		// The agents sharing a host bind their workers to different cores
+		Tasks::TaskPool::start(Configs::THREADS, Configs::AFFINITY, (Self::UNIFORM_NUMBER > 0 ? Self::UNIFORM_NUMBER - 1 : 0) * Configs::THREADS);
 		play_mode.onStart(setup);
+		if (Configs::WATCHDOG) {
+			watchdog_running = true;
+			if (pthread_create(&watchdog_thread, 0, watchdog, 0) != 0) {
+				std::cerr << "Controller::run() -> error creating watchdog thread" << std::endl;
+				watchdog_running = false;
+			}
+		}
 		while (Game::nextCycle()) {
 			if (current_play_mode.compare(Game::PLAY_MODE) != 0) {
 				current_play_mode = Game::PLAY_MODE;
@@ -245,13 +336,17 @@ void Controller::run() {
 			play_mode.onPreExecute();
 			std::map<std::string, execute>::iterator it = ai->find(current_play_mode);
 			if (it != ai->end()) {
+				if (watchdog_running) setExecuting(true);
 				play_mode.onExecute(_world->getWorldModel(), _messages->getMessages(), it->second);
+				if (watchdog_running) setExecuting(false);
 			} else {
 				std::cerr << "Controller::run(): " << current_play_mode << " handler not found" << std::endl;
 			}
 			play_mode.onPostExecute();
 		}
+		stopWatchdog();
 		play_mode.onEnd(finish);
+		Tasks::TaskPool::stop();
 	}
 }
 
@@ -24,10 +24,12 @@
 
 #include <iostream>
 #include <pthread.h>
+#include <sys/time.h>
 #include <boost/regex.hpp>
 #include "Self.hpp"
 #include "Game.hpp"
 #include "Configs.hpp"
+#include "Server.hpp"
 
 namespace Phoenix {
 
@@ -38,6 +40,7 @@ static bool cycle_flag = false;
 static bool on_game = true;
 static pthread_cond_t cycle_cond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t cycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct timeval cycle_start = {0, 0};
 
 unsigned int Game::GAME_TIME = 0;
 unsigned int Game::SIMULATION_TIME = 0;
@@ -94,6 +97,41 @@ void Game::updatePlayMode(std::string play_mode) {
 	}
 }
 
+void Game::startCycle() {
+	struct timeval now;
+	gettimeofday(&now, 0);
+	if (pthread_mutex_lock(&cycle_mutex)) {
+		std::cerr << "Game::startCycle() -> can not lock mutex" << std::endl;
+		return;
+	}
+	cycle_start = now;
+	if (pthread_mutex_unlock(&cycle_mutex)) {
+		std::cerr << "Game::startCycle() -> can not unlock mutex" << std::endl;
+	}
+}
+
+double Game::getElapsedTime() {
+	struct timeval now;
+	gettimeofday(&now, 0);
+	if (pthread_mutex_lock(&cycle_mutex)) {
+		std::cerr << "Game::getElapsedTime() -> can not lock mutex" << std::endl;
+		return 0.0;
+	}
+	struct timeval start = cycle_start;
+	if (pthread_mutex_unlock(&cycle_mutex)) {
+		std::cerr << "Game::getElapsedTime() -> can not unlock mutex" << std::endl;
+	}
+	return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_usec - start.tv_usec) / 1000.0;
+}
+
+double Game::getRemainingTime() {
+	return Server::SIMULATOR_STEP - (double)Configs::DEADLINE_MARGIN - getElapsedTime();
+}
+
+bool Game::isDeadlineExpired() {
+	return getRemainingTime() <= 0.0;
+}
+
 bool Game::nextCycle() {
 	int success = pthread_mutex_lock(&cycle_mutex);
 	if (success) {
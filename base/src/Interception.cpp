@@ -0,0 +1,220 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file Interception.cpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#include <cmath>
+#include <vector>
+#include "constants.hpp"
+#include "Interception.hpp"
+#include "Game.hpp"
+#include "PlayerType.hpp"
+#include "Self.hpp"
+#include "Server.hpp"
+
+namespace Phoenix {
+
+const int Interception::MAX_CYCLES;
+const int Interception::MAX_PLAYERS;
+
+static const int MAX_TURNS = 3;
+
+/* Predicted ball trajectory */
+static double ball_x[Interception::MAX_CYCLES + 1];
+static double ball_y[Interception::MAX_CYCLES + 1];
+
+/* Players as arrays, resolved together cycle by cycle */
+static int    count = 0;
+static double px[Interception::MAX_PLAYERS];
+static double py[Interception::MAX_PLAYERS];
+static double pvx[Interception::MAX_PLAYERS];
+static double pvy[Interception::MAX_PLAYERS];
+static double body[Interception::MAX_PLAYERS];
+static double decay[Interception::MAX_PLAYERS];
+static double decay_pow[Interception::MAX_PLAYERS];
+static double drift[Interception::MAX_PLAYERS];
+static double qx[Interception::MAX_PLAYERS];
+static double qy[Interception::MAX_PLAYERS];
+static double kickable[Interception::MAX_PLAYERS];
+static double distance[Interception::MAX_PLAYERS];
+static Interceptor interceptors[Interception::MAX_PLAYERS];
+
+static const Interceptor* fastest[3] = {0, 0, 0};
+static const Interceptor* fastest_all = 0;
+static unsigned int computed_time = 0;
+static unsigned long computed_snapshot = 0;
+static bool computed = false;
+
+static void addInterceptor(INTERCEPTOR_TEAM team, int unum, bool self, bool in_sight_range, const PlayerType* type,
+		double x, double y, double vx, double vy, double direction) {
+	if (count >= Interception::MAX_PLAYERS) return;
+	px[count] = x;
+	py[count] = y;
+	pvx[count] = vx;
+	pvy[count] = vy;
+	body[count] = direction;
+	decay[count] = type->getPlayerDecay();
+	decay_pow[count] = 1.0;
+	drift[count] = 0.0;
+	kickable[count] = type->getKickableRadius();
+	Interceptor &interceptor = interceptors[count];
+	interceptor.team = team;
+	interceptor.unum = unum;
+	interceptor.self = self;
+	interceptor.in_sight_range = in_sight_range;
+	interceptor.cycles = -1;
+	interceptor.x = 0.0;
+	interceptor.y = 0.0;
+	interceptor.type = type;
+	count++;
+}
+
+/*
+ * Cycles needed to face the target point at distance d and direction angle (degrees), the player
+ * slows down while turning so the turn is bigger every cycle
+ */
+static int turnCycles(int i, double angle, double d) {
+	if (d <= kickable[i]) return 0;
+	double diff = fabs(angle - body[i]);
+	if (diff > 180.0) diff = 360.0 - diff;
+	double tolerance = asin(kickable[i] / d) * 180.0 / Math::PI;
+	double speed = sqrt(pvx[i] * pvx[i] + pvy[i] * pvy[i]);
+	int turns = 0;
+	while (diff > tolerance && turns < MAX_TURNS) {
+		diff -= interceptors[i].type->getMaxTurn(speed);
+		speed *= decay[i];
+		turns++;
+	}
+	return turns;
+}
+
+void Interception::update(WorldModel &world_model) {
+	if (computed && computed_time == Game::SIMULATION_TIME && computed_snapshot == world_model.getSnapshot()) return;
+	compute(world_model);
+}
+
+void Interception::compute(WorldModel &world_model) {
+	computed = true;
+	computed_time = Game::SIMULATION_TIME;
+	computed_snapshot = world_model.getSnapshot();
+	count = 0;
+	fastest[OUR_TEAM] = 0;
+	fastest[OPP_TEAM] = 0;
+	fastest[UNKNOWN_TEAM] = 0;
+	fastest_all = 0;
+	// Ball trajectory
+	Ball* ball = world_model.getBall();
+	double bx = ball->getPosition()->getX();
+	double by = ball->getPosition()->getY();
+	double bvx = ball->getVelocity()->dx;
+	double bvy = ball->getVelocity()->dy;
+	for (int t = 0; t <= MAX_CYCLES; ++t) {
+		ball_x[t] = bx;
+		ball_y[t] = by;
+		bx += bvx;
+		by += bvy;
+		bvx *= Server::BALL_DECAY;
+		bvy *= Server::BALL_DECAY;
+	}
+	// Players
+	const Position* self_position = Self::getPosition();
+	const Geometry::Vector2D* self_velocity = Self::getVelocity();
+	addInterceptor(OUR_TEAM, Self::UNIFORM_NUMBER, true, true, Self::getPlayerType(), self_position->getX(), self_position->getY(),
+			self_velocity->dx, self_velocity->dy, self_position->getDirection());
+	std::vector<Player*> players = world_model.getPlayers();
+	for (std::vector<Player*>::iterator it = players.begin(); it != players.end(); ++it) {
+		Player* player = *it;
+		INTERCEPTOR_TEAM team = UNKNOWN_TEAM;
+		if (player->getTeam().compare("our") == 0) {
+			team = OUR_TEAM;
+		} else if (player->getTeam().compare("opp") == 0) {
+			team = OPP_TEAM;
+		}
+		int unum = player->getUniformNumber();
+		const PlayerType* type = team != UNKNOWN_TEAM && unum > 0 ? PlayerType::getPlayerTypeFor(team == OUR_TEAM, unum) : PlayerType::getPlayerType(0);
+		Position* position = player->getPosition();
+		Geometry::Vector2D* velocity = player->getVelocity();
+		addInterceptor(team, unum, false, player->isInSightRange(), type, position->getX(), position->getY(),
+				velocity->dx, velocity->dy, position->getDirection());
+	}
+	// Every cycle the distance from each player (drifting with its velocity) to the ball is computed
+	// for all the players, then the players that can cover it dashing are resolved
+	int pending = count;
+	for (int t = 0; t <= MAX_CYCLES && pending > 0; ++t) {
+		for (int i = 0; i < count; ++i) {
+			qx[i] = px[i] + pvx[i] * drift[i];
+			qy[i] = py[i] + pvy[i] * drift[i];
+			drift[i] += decay_pow[i];
+			decay_pow[i] *= decay[i];
+		}
+		Geometry::distances(ball_x[t], ball_y[t], qx, qy, distance, count);
+		for (int i = 0; i < count; ++i) {
+			Interceptor &interceptor = interceptors[i];
+			if (interceptor.cycles >= 0) continue;
+			double reach = distance[i] - kickable[i];
+			if (reach > 0.0) {
+				if (interceptor.type->getDashDistance(t) < reach) continue;
+				double angle = atan2(ball_y[t] - py[i], ball_x[t] - px[i]) * 180.0 / Math::PI;
+				if (interceptor.type->getDashDistance(t - turnCycles(i, angle, distance[i])) < reach) continue;
+			}
+			interceptor.cycles = t;
+			interceptor.x = ball_x[t];
+			interceptor.y = ball_y[t];
+			if (!fastest[interceptor.team]) fastest[interceptor.team] = &interceptor;
+			if (!fastest_all) fastest_all = &interceptor;
+			pending--;
+		}
+	}
+}
+
+void Interception::invalidate() {
+	computed = false;
+}
+
+int Interception::getCount() {
+	return count;
+}
+
+const Interceptor* Interception::getInterceptor(int i) {
+	if (i < 0 || i >= count) return 0;
+	return &interceptors[i];
+}
+
+const Interceptor* Interception::getSelf() {
+	return count > 0 ? &interceptors[0] : 0;
+}
+
+const Interceptor* Interception::getFastest(INTERCEPTOR_TEAM team) {
+	return fastest[team];
+}
+
+const Interceptor* Interception::getFastest() {
+	return fastest_all;
+}
+
+Geometry::Point Interception::getBallPosition(int cycle) {
+	if (cycle < 0) cycle = 0;
+	if (cycle > MAX_CYCLES) cycle = MAX_CYCLES;
+	return Geometry::Point(ball_x[cycle], ball_y[cycle]);
+}
+
+} // End namespace Phoenix
@@ -0,0 +1,347 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file KickPlanner.cpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#include <cmath>
+#include <vector>
+#include <sys/time.h>
+#include "constants.hpp"
+#include "KickPlanner.hpp"
+#include "PlayerType.hpp"
+#include "Self.hpp"
+#include "Server.hpp"
+
+namespace Phoenix {
+
+const int KickPlan::MAX_KICKS;
+const int KickPlanner::DISTANCES;
+const int KickPlanner::ANGLES;
+
+static const int CELLS = KickPlanner::DISTANCES * KickPlanner::ANGLES;
+static const double ANGLE_STEP = 360.0 / KickPlanner::ANGLES;
+static const double CELL_MARGIN = 0.05;		// Distance kept from the body and from the edge of the kick-able area
+static const double OPPONENT_MARGIN = 0.3;	// Distance added to the kick-able radius of the opponents
+static const double EPSILON = 1e-6;
+
+/* Table of the player type */
+static int table_type = -1;
+static Physics::Model model;
+static double kick_rand = 0.0;
+static double min_distance = 0.0;
+static double max_distance = 0.0;
+static double cell_x[CELLS];		// Position relative to the body
+static double cell_y[CELLS];
+static double cell_rate[CELLS];		// Effective kick rate
+static double cell_noise[CELLS];	// Position term of the kick noise
+static bool crosses[CELLS][CELLS];	// True if the ball moving between the cells hits the body
+
+static double normalize(double angle) {
+	while (angle > 180.0) angle -= 360.0;
+	while (angle < -180.0) angle += 360.0;
+	return angle;
+}
+
+static double kickRate(double distance, double angle) {
+	double dist_ball = distance - model.player_size - model.ball_size;
+	return model.kick_power_rate * (1.0 - 0.25 * fabs(angle) / 180.0 - 0.25 * dist_ball / model.kickable_margin);
+}
+
+static double positionNoise(double distance, double angle) {
+	double dist_ball = distance - model.player_size - model.ball_size;
+	return 0.5 + 0.25 * (fabs(angle) / 180.0 + dist_ball / model.kickable_margin);
+}
+
+/*
+ * Minimum distance from the origin to the segment (x0, y0) - (x1, y1)
+ */
+static double segmentDistance(double x0, double y0, double x1, double y1) {
+	double dx = x1 - x0;
+	double dy = y1 - y0;
+	double length = dx * dx + dy * dy;
+	double t = length > 0.0 ? -(x0 * dx + y0 * dy) / length : 0.0;
+	if (t < 0.0) t = 0.0;
+	if (t > 1.0) t = 1.0;
+	double x = x0 + t * dx;
+	double y = y0 + t * dy;
+	return sqrt(x * x + y * y);
+}
+
+/*
+ * Kick that changes the ball velocity (vx, vy) into (wx, wy) from a position with the given rate,
+ * the noise follows the maximum noise of the server for the kick
+ */
+static bool solveKick(double rate, double position_noise, double vx, double vy, double wx, double wy, double body,
+		double &power, double &direction, double &noise) {
+	if (wx * wx + wy * wy > model.ball_speed_max * model.ball_speed_max + EPSILON) return false;
+	double ax = wx - vx;
+	double ay = wy - vy;
+	double accel = sqrt(ax * ax + ay * ay);
+	if (accel > model.ball_accel_max + EPSILON || rate <= 0.0) return false;
+	power = accel / rate;
+	if (power > model.maxpower + EPSILON) return false;
+	direction = accel > 0.0 ? normalize(atan2(ay, ax) * 180.0 / Math::PI - body) : 0.0;
+	double speed_rate = 0.5 + 0.5 * sqrt(vx * vx + vy * vy) / (model.ball_speed_max * model.ball_decay);
+	noise = kick_rand * power / model.maxpower * (position_noise + speed_rate);
+	return true;
+}
+
+/*
+ * True if the ball at (x, y) is out of the kick-able area of every opponent, the radii are
+ * already squared and include OPPONENT_MARGIN
+ */
+static bool isSafe(double x, double y, const Geometry::Point* opponents, const double* radii, int count) {
+	for (int i = 0; i < count; ++i) {
+		double dx = opponents[i].x - x;
+		double dy = opponents[i].y - y;
+		if (dx * dx + dy * dy < radii[i]) return false;
+	}
+	return true;
+}
+
+static double elapsed(const struct timeval &start) {
+	struct timeval now;
+	gettimeofday(&now, 0);
+	return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_usec - start.tv_usec) / 1000.0;
+}
+
+void KickPlanner::buildTables(const PlayerType* type) {
+	model = type->getModel();
+	kick_rand = type->getKickRand();
+	min_distance = model.player_size + model.ball_size + CELL_MARGIN;
+	max_distance = model.player_size + model.ball_size + model.kickable_margin - CELL_MARGIN;
+	double distance_step = (max_distance - min_distance) / (DISTANCES - 1);
+	for (int d = 0; d < DISTANCES; ++d) {
+		double distance = min_distance + d * distance_step;
+		for (int a = 0; a < ANGLES; ++a) {
+			int c = d * ANGLES + a;
+			double angle = normalize(a * ANGLE_STEP);
+			cell_x[c] = distance * cos(angle * Math::PI / 180.0);
+			cell_y[c] = distance * sin(angle * Math::PI / 180.0);
+			cell_rate[c] = kickRate(distance, angle);
+			cell_noise[c] = positionNoise(distance, angle);
+		}
+	}
+	double body_radius = model.player_size + model.ball_size;
+	for (int c1 = 0; c1 < CELLS; ++c1) {
+		for (int c2 = 0; c2 < CELLS; ++c2) {
+			crosses[c1][c2] = segmentDistance(cell_x[c1], cell_y[c1], cell_x[c2], cell_y[c2]) < body_radius;
+		}
+	}
+	table_type = type->getId();
+}
+
+double KickPlanner::getKickRate(double distance, double angle) {
+	if (table_type < 0) buildTables(PlayerType::getPlayerType(0));
+	double distance_step = (max_distance - min_distance) / (DISTANCES - 1);
+	int d = (int)floor((distance - min_distance) / distance_step + 0.5);
+	if (d < 0) d = 0;
+	if (d >= DISTANCES) d = DISTANCES - 1;
+	double a = normalize(angle);
+	if (a < 0.0) a += 360.0;
+	int ai = (int)floor(a / ANGLE_STEP + 0.5) % ANGLES;
+	return cell_rate[d * ANGLES + ai];
+}
+
+KickPlan KickPlanner::plan(double vx, double vy, WorldModel &world_model, double time_budget) {
+	if (table_type != Self::TYPE_ID) buildTables(Self::getPlayerType());
+	Physics::State state;
+	const Position* position = Self::getPosition();
+	const Geometry::Vector2D* velocity = Self::getVelocity();
+	state.x = position->getX();
+	state.y = position->getY();
+	state.vx = velocity->dx;
+	state.vy = velocity->dy;
+	state.body = position->getDirection();
+	state.stamina = Self::STAMINA;
+	Ball* ball = world_model.getBall();
+	state.ball_x = ball->getPosition()->getX();
+	state.ball_y = ball->getPosition()->getY();
+	state.ball_vx = ball->getVelocity()->dx;
+	state.ball_vy = ball->getVelocity()->dy;
+	Geometry::Point opponents[MAX_OPPONENTS];
+	double kickable[MAX_OPPONENTS];
+	int count = 0;
+	std::vector<Player*> players = world_model.getPlayers();
+	for (std::vector<Player*>::iterator it = players.begin(); it != players.end() && count < MAX_OPPONENTS; ++it) {
+		if ((*it)->getTeam().compare("opp") != 0) continue;
+		opponents[count] = Geometry::Point((*it)->getPosition()->getX(), (*it)->getPosition()->getY());
+		// The type of an opponent not identified yet is the default type
+		kickable[count] = PlayerType::getPlayerTypeFor(false, (*it)->getUniformNumber())->getKickableRadius();
+		count++;
+	}
+	return plan(state, vx, vy, opponents, kickable, count, time_budget);
+}
+
+KickPlan KickPlanner::plan(const Physics::State &state, double vx, double vy, const Geometry::Point* opponents, const double* kickable,
+		int count, double time_budget) {
+	if (table_type < 0) buildTables(PlayerType::getPlayerType(0));
+	if (count > MAX_OPPONENTS) count = MAX_OPPONENTS;
+	double radii[MAX_OPPONENTS];
+	double default_kickable = Server::PLAYER_SIZE + Server::BALL_SIZE + Server::KICKABLE_MARGIN;
+	for (int i = 0; i < count; ++i) {
+		radii[i] = (kickable ? kickable[i] : default_kickable) + OPPONENT_MARGIN;
+		radii[i] *= radii[i];
+	}
+	struct timeval start;
+	gettimeofday(&start, 0);
+	KickPlan result;
+	result.kicks = 0;
+	result.vx = state.ball_vx;
+	result.vy = state.ball_vy;
+	result.noise = 0.0;
+	result.reached = false;
+	double rel_x = state.ball_x - state.x;
+	double rel_y = state.ball_y - state.y;
+	double distance = sqrt(rel_x * rel_x + rel_y * rel_y);
+	if (distance > model.player_size + model.ball_size + model.kickable_margin) return result;
+	double angle = normalize(atan2(rel_y, rel_x) * 180.0 / Math::PI - state.body);
+	double rate = kickRate(distance, angle);
+	double noise = positionNoise(distance, angle);
+	double power, direction, kick_noise;
+	// One kick
+	if (solveKick(rate, noise, state.ball_vx, state.ball_vy, vx, vy, state.body, power, direction, kick_noise)) {
+		result.kicks = 1;
+		result.power[0] = power;
+		result.direction[0] = direction;
+		result.vx = vx;
+		result.vy = vy;
+		result.noise = kick_noise;
+		result.reached = true;
+		return result;
+	}
+	// The agent drifts with its velocity between the kicks
+	double p1_x = state.x + state.vx;
+	double p1_y = state.y + state.vy;
+	double v1_x = state.vx * model.player_decay;
+	double v1_y = state.vy * model.player_decay;
+	double p2_x = p1_x + v1_x;
+	double p2_y = p1_y + v1_y;
+	double cos_body = cos(state.body * Math::PI / 180.0);
+	double sin_body = sin(state.body * Math::PI / 180.0);
+	double body_radius = model.player_size + model.ball_size;
+	// Cells of the plan in absolute axes
+	double offset_x[CELLS];
+	double offset_y[CELLS];
+	bool safe_second[CELLS];
+	bool first_valid[CELLS];
+	double first_power[CELLS];
+	double first_direction[CELLS];
+	double first_noise[CELLS];
+	for (int c = 0; c < CELLS; ++c) {
+		offset_x[c] = cell_x[c] * cos_body - cell_y[c] * sin_body;
+		offset_y[c] = cell_x[c] * sin_body + cell_y[c] * cos_body;
+		safe_second[c] = isSafe(p2_x + offset_x[c], p2_y + offset_y[c], opponents, radii, count);
+		// First kick, from the ball to the cell
+		first_valid[c] = false;
+		if (!isSafe(p1_x + offset_x[c], p1_y + offset_y[c], opponents, radii, count)) continue;
+		if (segmentDistance(rel_x, rel_y, offset_x[c], offset_y[c]) < body_radius) continue;
+		double wx = p1_x + offset_x[c] - state.ball_x;
+		double wy = p1_y + offset_y[c] - state.ball_y;
+		first_valid[c] = solveKick(rate, noise, state.ball_vx, state.ball_vy, wx, wy, state.body,
+				first_power[c], first_direction[c], first_noise[c]);
+	}
+	// Two kicks, all the cells
+	for (int c = 0; c < CELLS; ++c) {
+		if (!first_valid[c]) continue;
+		double bvx = (p1_x + offset_x[c] - state.ball_x) * model.ball_decay;
+		double bvy = (p1_y + offset_y[c] - state.ball_y) * model.ball_decay;
+		if (!solveKick(cell_rate[c], cell_noise[c], bvx, bvy, vx, vy, state.body, power, direction, kick_noise)) continue;
+		if (result.reached && first_noise[c] + kick_noise >= result.noise) continue;
+		result.kicks = 2;
+		result.power[0] = first_power[c];
+		result.direction[0] = first_direction[c];
+		result.power[1] = power;
+		result.direction[1] = direction;
+		result.noise = first_noise[c] + kick_noise;
+		result.reached = true;
+	}
+	if (result.reached) {
+		result.vx = vx;
+		result.vy = vy;
+		return result;
+	}
+	// Three kicks, pairs of cells until the time budget expires
+	for (int c1 = 0; c1 < CELLS; ++c1) {
+		if (!first_valid[c1]) continue;
+		if (elapsed(start) > time_budget) break;
+		double b1_x = p1_x + offset_x[c1];
+		double b1_y = p1_y + offset_y[c1];
+		double bv1_x = (b1_x - state.ball_x) * model.ball_decay;
+		double bv1_y = (b1_y - state.ball_y) * model.ball_decay;
+		for (int c2 = 0; c2 < CELLS; ++c2) {
+			if (c2 == c1 || !safe_second[c2] || crosses[c1][c2]) continue;
+			double wx = p2_x + offset_x[c2] - b1_x;
+			double wy = p2_y + offset_y[c2] - b1_y;
+			double second_power, second_direction, second_noise;
+			if (!solveKick(cell_rate[c1], cell_noise[c1], bv1_x, bv1_y, wx, wy, state.body,
+					second_power, second_direction, second_noise)) continue;
+			double total = first_noise[c1] + second_noise;
+			if (result.reached && total >= result.noise) continue;
+			if (!solveKick(cell_rate[c2], cell_noise[c2], wx * model.ball_decay, wy * model.ball_decay, vx, vy, state.body,
+					power, direction, kick_noise)) continue;
+			if (result.reached && total + kick_noise >= result.noise) continue;
+			result.kicks = 3;
+			result.power[0] = first_power[c1];
+			result.direction[0] = first_direction[c1];
+			result.power[1] = second_power;
+			result.direction[1] = second_direction;
+			result.power[2] = power;
+			result.direction[2] = direction;
+			result.noise = total + kick_noise;
+			result.reached = true;
+		}
+	}
+	if (result.reached) {
+		result.vx = vx;
+		result.vy = vy;
+		return result;
+	}
+	// Not reachable, the strongest kick towards the target velocity
+	double ax = vx - state.ball_vx;
+	double ay = vy - state.ball_vy;
+	double accel = sqrt(ax * ax + ay * ay);
+	double max_accel = rate * model.maxpower;
+	if (max_accel > model.ball_accel_max) max_accel = model.ball_accel_max;
+	if (accel > max_accel) {
+		ax *= max_accel / accel;
+		ay *= max_accel / accel;
+	}
+	double wx = state.ball_vx + ax;
+	double wy = state.ball_vy + ay;
+	double speed = sqrt(wx * wx + wy * wy);
+	if (speed > model.ball_speed_max) {
+		wx *= model.ball_speed_max / speed;
+		wy *= model.ball_speed_max / speed;
+	}
+	accel = sqrt(ax * ax + ay * ay);
+	result.kicks = 1;
+	result.power[0] = rate > 0.0 ? accel / rate : 0.0;
+	result.direction[0] = accel > 0.0 ? normalize(atan2(ay, ax) * 180.0 / Math::PI - state.body) : 0.0;
+	result.vx = wx;
+	result.vy = wy;
+	double speed_rate = 0.5 + 0.5 * sqrt(state.ball_vx * state.ball_vx + state.ball_vy * state.ball_vy) / (model.ball_speed_max * model.ball_decay);
+	result.noise = kick_rand * result.power[0] / model.maxpower * (noise + speed_rate);
+	return result;
+}
+
+} // End namespace Phoenix
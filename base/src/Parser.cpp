@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
 #include <boost/regex.hpp>
 #include <pthread.h>
 #include <vector>
@@ -33,6 +34,7 @@
 #include "Self.hpp"
 #include "Flag.hpp"
 #include "Player.hpp"
+#include "PlayerType.hpp"
 #include "Server.hpp"
 #include "Position.hpp"
 #include "World.hpp"
@@ -142,37 +144,7 @@ boost::regex fullstate_player("\\(\\(p\\s+(l|r)\\s+(\\d+)\\s+(g|\\d+)\\)\\s+" //
 	                          "([\\d\\.\\-e]+)\\s+([\\d\\.\\-e]+)\\)\\)"); //group 12 (recovery) group 13 (capacity)
 
 void *fullstateHandler(void* arg) {
-	std::string::const_iterator start, end;
-	start = fullstate.begin();
-	end = fullstate.end();
-	boost::match_results<std::string::const_iterator> match;
-	boost::match_flag_type search_flags = boost::match_default;
-	while (boost::regex_search(start, end, match, fullstate_player, search_flags)) {
-		std::string side = std::string() + match[1];
-		int unum = atoi((std::string() + match[2]).c_str());
-		double x = atof((std::string() + match[4]).c_str());
-		double y = atof((std::string() + match[5]).c_str());
-		double vx = atof((std::string() + match[6]).c_str());
-		double vy = atof((std::string() + match[7]).c_str());
-		double b = atof((std::string() + match[8]).c_str());
-		double n = atof((std::string() + match[9]).c_str());
-		Player p;
-		p.initForFullstate(side, unum, x, y, vx, vy, b, n);
-		fs_players.push_back(p);
-		start = match[0].second;
-		search_flags |= boost::match_prev_avail;
-		search_flags |= boost::match_not_bob;
-	}
-	start = fullstate.begin();
-	end = fullstate.end();
-	search_flags = boost::match_default;
-	if (boost::regex_search(start, end, match, fullstate_ball, search_flags)) {
-		double x = atof((std::string() + match[1]).c_str());
-		double y = atof((std::string() + match[2]).c_str());
-		double vx = atof((std::string() + match[3]).c_str());
-		double vy = atof((std::string() + match[4]).c_str());
-		fs_ball.initForFullstate(x, y, vx, vy);
-	}
+	Parser::parseFullstate(fullstate, fs_players, fs_ball);
 	if (Configs::SAVE_FULLSTATE) {
 		fs_stream << fullstate << std::endl;
 	}
@@ -192,49 +164,11 @@ std::vector<std::string> hears;
 
 void *hearHandler(void* arg) {
 	std::string hear = *((std::string *)arg);
-	boost::cmatch match;
-	if (boost::regex_match(hear.c_str(), match, hear_referee_regex)) { //from referee to player/trainer
-		game_ptr->updatePlayMode(std::string() + match[2]);
-	} 
-	else if (boost::regex_match(hear.c_str(), match, hear_player_regex)) { //from player to player (same team)
-		double direction = atof((std::string() + match[2]).c_str());
-		int unum = atoi((std::string() + match[3]).c_str());
-		std::string message = std::string() + match[4];
-		Message new_message(direction, "our", unum, message);
-		if (new_cycle) {
-			messages.push_back(new_message);
-		} else {
-			out_of_cycle.push_back(new_message);
-		}
-	} 
-	else if (boost::regex_match(hear.c_str(), match, hear_coach_regex)) { //from coach to player (free-form)
-		std::string coach = std::string() + match[2];
-		if (Self::SIDE[0] == coach[13]) {
-			std::string msg = std::string() + match[3];
-			Message new_message(0.0, "coach", msg);
-			if (new_cycle) {
-				messages.push_back(new_message);
-			} else {
-				out_of_cycle.push_back(new_message);
-			}
-		}
-	} 
-	else if (boost::regex_match(hear.c_str(), match, hear_trainer_regex)) { //from trainer to player
-
-	}
-	else if (boost::regex_match(hear.c_str(), match, hear_for_trainer)) { //from player to trainer
-		std::string team = std::string() + match[2];
-		int unum = atoi((std::string() + match[3]).c_str());
-		std::string msg = std::string() + match[4];
-		Message new_message(0.0, team, unum, msg);
-		if (new_cycle) {
-			messages.push_back(new_message);
-		} else {
-			out_of_cycle.push_back(new_message);
-		}
-	}
-	else {
+	std::string play_mode;
+	if (!Parser::parseHear(hear, new_cycle ? messages : out_of_cycle, play_mode)) {
 		std::cerr << Game::SIMULATION_TIME << ": message not supported " << hear << std::endl;
+	} else if (play_mode.length() > 0) {
+		game_ptr->updatePlayMode(play_mode);
 	}
 	if (Configs::SAVE_HEAR) {
 		hear_stream << hear << std::endl;
@@ -270,43 +204,7 @@ void *seeHandler(void* arg) {
 		std::cerr << "Parser::process_sense_body(void*) -> cannot unlock sense body mutex" << std::endl;
 		return 0;
 	}
-	int simulation_time = Game::SIMULATION_TIME;
-	std::string raw_ball = "";
-	std::string::const_iterator start, end;
-	start = see.begin();
-	end = see.end();
-	boost::match_results<std::string::const_iterator> match;
-	boost::match_flag_type search_flags = boost::match_default;
-	while (boost::regex_search(start, end, match, see_regex, search_flags)) {
-		std::string name = std::string() + match[1];
-		std::string data = std::string() + match[2];
-		switch (name[0]) {
-		case 'g': {
-			break;
-		}
-		case 'f': {
-			flags.push_back(Flag(name, data, simulation_time));
-			break;
-		}
-		case 'p': {
-			Player p;
-			p.setDataForPlayer(name, data);
-			players.push_back(p);
-			break;
-		}
-		case 'b': {
-//			ball.initForPlayer(data, player_position, player_velocity);
-			raw_ball = data;
-			break;
-		}
-		default: {
-			break;
-		}
-		}
-		start = match[0].second;
-		search_flags |= boost::match_prev_avail;
-		search_flags |= boost::match_not_bob;
-	}
+	std::string raw_ball = Parser::parseSee(see, Game::SIMULATION_TIME, flags, players);
 	self_ptr->localize(flags);
 	localized = true;
 	const Position* player_position = Self::getPosition();
@@ -433,6 +331,7 @@ void Parser::parseMessage(std::string message) {
 		new_cycle = true;
 		found = message.find(" ", 12);
 		time = atoi(message.substr(12, found - 12).c_str());
+		game_ptr->startCycle();
 		if (pthread_create(&thread_timer, &attr, timer, 0) != 0) {
 			std::cerr << "Parser::parseMessage(string) -> error creating timer thread" << std::endl;
 		}
@@ -453,6 +352,7 @@ void Parser::parseMessage(std::string message) {
 		new_cycle = true;
 		found = message.find(" ", 12);
 		time = atoi(message.substr(12, found - 12).c_str());
+		game_ptr->startCycle();
 		if (pthread_create(&thread_timer, &attr, timer, 0) != 0) {
 			std::cerr << "Parser::parseMessage(string) -> error creating timer thread" << std::endl;
 		}
@@ -469,6 +369,21 @@ void Parser::parseMessage(std::string message) {
 		return;
 	}
 	else if (message_type.compare("change_player_type") == 0) {
+		int unum = 0;
+		int type = -1;
+		int args = sscanf(message.c_str(), "(change_player_type %d %d)", &unum, &type);
+		if (args == 2) {
+			if (self_ptr && unum == Self::UNIFORM_NUMBER) {
+				self_ptr->changePlayerType(type);
+			} else {
+				PlayerType::setPlayerTypeFor(true, unum, type);
+			}
+		} else if (args == 1) {
+			// The server does not tell the new type of the opponents
+			PlayerType::setPlayerTypeFor(false, unum, -1);
+		} else {
+			std::cerr << "Parser::parseMessage(string) -> failed to parse " << message << std::endl;
+		}
 		return;
 	}
 	else if (message_type.compare("ok") == 0) {
@@ -506,4 +421,110 @@ void Parser::parseMessage(std::string message) {
 	}
 }
 
+std::string Parser::parseSee(const std::string &see, int simulation_time, std::vector<Flag> &flags, std::vector<Player> &players) {
+	std::string raw_ball = "";
+	std::string::const_iterator start, end;
+	start = see.begin();
+	end = see.end();
+	boost::match_results<std::string::const_iterator> match;
+	boost::match_flag_type search_flags = boost::match_default;
+	while (boost::regex_search(start, end, match, see_regex, search_flags)) {
+		std::string name = std::string() + match[1];
+		std::string data = std::string() + match[2];
+		switch (name[0]) {
+		case 'g': {
+			break;
+		}
+		case 'f': {
+			flags.push_back(Flag(name, data, simulation_time));
+			break;
+		}
+		case 'p': {
+			Player p;
+			p.setDataForPlayer(name, data);
+			players.push_back(p);
+			break;
+		}
+		case 'b': {
+			raw_ball = data;
+			break;
+		}
+		default: {
+			break;
+		}
+		}
+		start = match[0].second;
+		search_flags |= boost::match_prev_avail;
+		search_flags |= boost::match_not_bob;
+	}
+	return raw_ball;
+}
+
+void Parser::parseFullstate(const std::string &fullstate, std::vector<Player> &players, Ball &ball) {
+	std::string::const_iterator start, end;
+	start = fullstate.begin();
+	end = fullstate.end();
+	boost::match_results<std::string::const_iterator> match;
+	boost::match_flag_type search_flags = boost::match_default;
+	while (boost::regex_search(start, end, match, fullstate_player, search_flags)) {
+		std::string side = std::string() + match[1];
+		int unum = atoi((std::string() + match[2]).c_str());
+		double x = atof((std::string() + match[4]).c_str());
+		double y = atof((std::string() + match[5]).c_str());
+		double vx = atof((std::string() + match[6]).c_str());
+		double vy = atof((std::string() + match[7]).c_str());
+		double b = atof((std::string() + match[8]).c_str());
+		double n = atof((std::string() + match[9]).c_str());
+		Player p;
+		p.initForFullstate(side, unum, x, y, vx, vy, b, n);
+		players.push_back(p);
+		start = match[0].second;
+		search_flags |= boost::match_prev_avail;
+		search_flags |= boost::match_not_bob;
+	}
+	start = fullstate.begin();
+	end = fullstate.end();
+	search_flags = boost::match_default;
+	if (boost::regex_search(start, end, match, fullstate_ball, search_flags)) {
+		double x = atof((std::string() + match[1]).c_str());
+		double y = atof((std::string() + match[2]).c_str());
+		double vx = atof((std::string() + match[3]).c_str());
+		double vy = atof((std::string() + match[4]).c_str());
+		ball.initForFullstate(x, y, vx, vy);
+	}
+}
+
+bool Parser::parseHear(const std::string &hear, std::vector<Message> &messages, std::string &play_mode) {
+	boost::cmatch match;
+	if (boost::regex_match(hear.c_str(), match, hear_referee_regex)) { //from referee to player/trainer
+		play_mode = std::string() + match[2];
+	}
+	else if (boost::regex_match(hear.c_str(), match, hear_player_regex)) { //from player to player (same team)
+		double direction = atof((std::string() + match[2]).c_str());
+		int unum = atoi((std::string() + match[3]).c_str());
+		std::string message = std::string() + match[4];
+		messages.push_back(Message(direction, "our", unum, message));
+	}
+	else if (boost::regex_match(hear.c_str(), match, hear_coach_regex)) { //from coach to player (free-form)
+		std::string coach = std::string() + match[2];
+		if (Self::SIDE[0] == coach[13]) {
+			std::string msg = std::string() + match[3];
+			messages.push_back(Message(0.0, "coach", msg));
+		}
+	}
+	else if (boost::regex_match(hear.c_str(), match, hear_trainer_regex)) { //from trainer to player
+
+	}
+	else if (boost::regex_match(hear.c_str(), match, hear_for_trainer)) { //from player to trainer
+		std::string team = std::string() + match[2];
+		int unum = atoi((std::string() + match[3]).c_str());
+		std::string msg = std::string() + match[4];
+		messages.push_back(Message(0.0, team, unum, msg));
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
 }
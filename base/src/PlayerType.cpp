@@ -0,0 +1,304 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file PlayerType.cpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <boost/regex.hpp>
+#include "PlayerType.hpp"
+#include "Server.hpp"
+
+namespace Phoenix {
+
+const int PlayerType::ACCELERATION_CYCLES;
+
+static std::vector<PlayerType> player_types;
+static PlayerType default_type;
+/* Type id of each uniform number, all the players start with the default type */
+static int our_types[12]  = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static int their_types[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+PlayerType::PlayerType() {
+	setDefaults();
+	computeDerived();
+}
+
+PlayerType::PlayerType(std::string player_type) {
+	setDefaults();
+	static const boost::regex parameter_regex("\\((\\w+)\\s+([\\w\\-\\.]+)\\)");
+	boost::sregex_iterator it(player_type.begin(), player_type.end(), parameter_regex);
+	boost::sregex_iterator end;
+	if (it == end) {
+		std::cerr << "PlayerType::PlayerType(string) -> no parameters found in " << player_type << std::endl;
+	}
+	for (; it != end; ++it) {
+		std::string name = (*it)[1];
+		double value = atof(std::string((*it)[2]).c_str());
+		if      (name == "id")                       id                       = (int)value;
+		else if (name == "player_speed_max")         player_speed_max         = value;
+		else if (name == "stamina_inc_max")          stamina_inc_max          = value;
+		else if (name == "player_decay")             player_decay             = value;
+		else if (name == "inertia_moment")           inertia_moment           = value;
+		else if (name == "dash_power_rate")          dash_power_rate          = value;
+		else if (name == "player_size")              player_size              = value;
+		else if (name == "kickable_margin")          kickable_margin          = value;
+		else if (name == "kick_rand")                kick_rand                = value;
+		else if (name == "extra_stamina")            extra_stamina            = value;
+		else if (name == "effort_max")               effort_max               = value;
+		else if (name == "effort_min")               effort_min               = value;
+		else if (name == "kick_power_rate")          kick_power_rate          = value;
+		else if (name == "foul_detect_probability")  foul_detect_probability  = value;
+		else if (name == "catchable_area_l_stretch") catchable_area_l_stretch = value;
+	}
+	computeDerived();
+}
+
+PlayerType::~PlayerType() {
+
+}
+
+void PlayerType::setDefaults() {
+	id                       = 0;
+	player_speed_max         = 1.05;
+	stamina_inc_max          = 45.0;
+	player_decay             = 0.4;
+	inertia_moment           = 5.0;
+	dash_power_rate          = 0.006;
+	player_size              = 0.3;
+	kickable_margin          = 0.7;
+	kick_rand                = 0.1;
+	extra_stamina            = 50.0;
+	effort_max               = 1.0;
+	effort_min               = 0.6;
+	kick_power_rate          = 0.027;
+	foul_detect_probability  = 0.5;
+	catchable_area_l_stretch = 1.0;
+}
+
+/*
+ * The acceleration curve follows the server movement model for a dash with maximum power:
+ * v(t+1) = min(v(t) + accel, speed_max), position(t+1) = position(t) + v(t+1), then the
+ * velocity decays by player_decay.  The speed stored is the step of each cycle.
+ */
+void PlayerType::computeDerived() {
+	double accel = Server::MAX_DASH_POWER * dash_power_rate * effort_max;
+	double accel_tired = Server::MAX_DASH_POWER * dash_power_rate * effort_min;
+	double decay = player_decay < 1.0 ? 1.0 - player_decay : 1.0;
+	real_speed_max = std::min(player_speed_max, accel / decay);
+	real_speed_max_tired = std::min(player_speed_max, accel_tired / decay);
+	double speed = 0.0;
+	double distance = 0.0;
+	speed_after_dashes[0] = 0.0;
+	dash_distance[0] = 0.0;
+	for (int i = 1; i <= ACCELERATION_CYCLES; ++i) {
+		speed += accel;
+		if (speed > player_speed_max) speed = player_speed_max;
+		distance += speed;
+		speed_after_dashes[i] = speed;
+		dash_distance[i] = distance;
+		speed *= player_decay;
+	}
+	kickable_radius = player_size + kickable_margin + Server::BALL_SIZE;
+	// Stamina spent by the dash minus the recovered each cycle, per meter covered
+	stamina_per_meter = real_speed_max > 0.0 ? std::max(0.0, Server::MAX_DASH_POWER - stamina_inc_max) / real_speed_max : 0.0;
+}
+
+int PlayerType::getId() const {
+	return id;
+}
+
+double PlayerType::getPlayerSpeedMax() const {
+	return player_speed_max;
+}
+
+double PlayerType::getStaminaIncMax() const {
+	return stamina_inc_max;
+}
+
+double PlayerType::getPlayerDecay() const {
+	return player_decay;
+}
+
+double PlayerType::getInertiaMoment() const {
+	return inertia_moment;
+}
+
+double PlayerType::getDashPowerRate() const {
+	return dash_power_rate;
+}
+
+double PlayerType::getPlayerSize() const {
+	return player_size;
+}
+
+double PlayerType::getKickableMargin() const {
+	return kickable_margin;
+}
+
+double PlayerType::getKickRand() const {
+	return kick_rand;
+}
+
+double PlayerType::getExtraStamina() const {
+	return extra_stamina;
+}
+
+double PlayerType::getEffortMax() const {
+	return effort_max;
+}
+
+double PlayerType::getEffortMin() const {
+	return effort_min;
+}
+
+double PlayerType::getKickPowerRate() const {
+	return kick_power_rate;
+}
+
+double PlayerType::getFoulDetectProbability() const {
+	return foul_detect_probability;
+}
+
+double PlayerType::getCatchableAreaLStretch() const {
+	return catchable_area_l_stretch;
+}
+
+double PlayerType::getRealSpeedMax(bool tired) const {
+	return tired ? real_speed_max_tired : real_speed_max;
+}
+
+double PlayerType::getSpeedAfterDashes(int cycles) const {
+	if (cycles <= 0) return 0.0;
+	if (cycles > ACCELERATION_CYCLES) cycles = ACCELERATION_CYCLES;
+	return speed_after_dashes[cycles];
+}
+
+double PlayerType::getDashDistance(int cycles) const {
+	if (cycles <= 0) return 0.0;
+	if (cycles <= ACCELERATION_CYCLES) return dash_distance[cycles];
+	return dash_distance[ACCELERATION_CYCLES] + (cycles - ACCELERATION_CYCLES) * real_speed_max;
+}
+
+int PlayerType::getCyclesToRun(double distance) const {
+	if (distance <= 0.0) return 0;
+	for (int i = 1; i <= ACCELERATION_CYCLES; ++i) {
+		if (dash_distance[i] >= distance) return i;
+	}
+	if (real_speed_max <= 0.0) return -1;
+	return ACCELERATION_CYCLES + (int)ceil((distance - dash_distance[ACCELERATION_CYCLES]) / real_speed_max);
+}
+
+double PlayerType::getKickableRadius() const {
+	return kickable_radius;
+}
+
+double PlayerType::getMaxTurn(double speed) const {
+	return Server::MAXMOMENT / (1.0 + inertia_moment * speed);
+}
+
+double PlayerType::getStaminaPerMeter() const {
+	return stamina_per_meter;
+}
+
+Physics::Model PlayerType::getModel(double effort) const {
+	Physics::Model model;
+	model.ball_accel_max        = Server::BALL_ACCEL_MAX;
+	model.ball_decay            = Server::BALL_DECAY;
+	model.ball_size             = Server::BALL_SIZE;
+	model.ball_speed_max        = Server::BALL_SPEED_MAX;
+	model.player_accel_max      = Server::PLAYER_ACCEL_MAX;
+	model.player_decay          = player_decay;
+	model.player_size           = player_size;
+	model.player_speed_max      = player_speed_max;
+	model.dash_power_rate       = dash_power_rate;
+	model.effort                = effort < 0.0 ? effort_max : effort;
+	model.inertia_moment        = inertia_moment;
+	model.kickable_margin       = kickable_margin;
+	model.kick_power_rate       = kick_power_rate;
+	model.stamina_inc_max       = stamina_inc_max;
+	model.stamina_max           = Server::STAMINA_MAX;
+	model.extra_stamina         = extra_stamina;
+	model.max_dash_power        = Server::MAX_DASH_POWER;
+	model.min_dash_power        = Server::MIN_DASH_POWER;
+	model.max_dash_angle        = Server::MAX_DASH_ANGLE;
+	model.min_dash_angle        = Server::MIN_DASH_ANGLE;
+	model.dash_angle_step       = Server::DASH_ANGLE_STEP;
+	model.side_dash_rate        = Server::SIDE_DASH_RATE;
+	model.back_dash_rate        = Server::BACK_DASH_RATE;
+	model.maxmoment             = Server::MAXMOMENT;
+	model.minmoment             = Server::MINMOMENT;
+	model.maxpower              = Server::MAXPOWER;
+	model.minpower              = Server::MINPOWER;
+	model.tackle_dist           = Server::TACKLE_DIST;
+	model.tackle_back_dist      = Server::TACKLE_BACK_DIST;
+	model.tackle_width          = Server::TACKLE_WIDTH;
+	model.tackle_exponent       = Server::TACKLE_EXPONENT;
+	model.tackle_power_rate     = Server::TACKLE_POWER_RATE;
+	model.max_tackle_power      = Server::MAX_TACKLE_POWER;
+	model.max_back_tackle_power = Server::MAX_BACK_TACKLE_POWER;
+	return model;
+}
+
+void PlayerType::addPlayerType(const PlayerType &type) {
+	if (type.id < 0) {
+		std::cerr << "PlayerType::addPlayerType(PlayerType) -> invalid type id " << type.id << std::endl;
+		return;
+	}
+	if ((unsigned int)type.id >= player_types.size()) {
+		player_types.resize(type.id + 1);
+	}
+	player_types[type.id] = type;
+}
+
+const PlayerType* PlayerType::getPlayerType(int id) {
+	if (id >= 0 && (unsigned int)id < player_types.size()) {
+		return &player_types[id];
+	}
+	return &default_type;
+}
+
+void PlayerType::setPlayerTypeFor(bool our, int unum, int id) {
+	if (unum < 1 || unum > 11) {
+		std::cerr << "PlayerType::setPlayerTypeFor(bool, int, int) -> invalid uniform number " << unum << std::endl;
+		return;
+	}
+	if (our) {
+		our_types[unum] = id;
+	} else {
+		their_types[unum] = id;
+	}
+}
+
+const PlayerType* PlayerType::getPlayerTypeFor(bool our, int unum) {
+	return getPlayerType(getPlayerTypeIdFor(our, unum));
+}
+
+int PlayerType::getPlayerTypeIdFor(bool our, int unum) {
+	if (unum < 1 || unum > 11) return -1;
+	return our ? our_types[unum] : their_types[unum];
+}
+
+} // End namespace Phoenix
@@ -51,18 +51,15 @@ Position::~Position() {
 }
 
 double Position::getDistanceTo(Position* position) const {
-	double distance = sqrt(pow(position->x - x, 2.0) + pow(position->y - y, 2.0));
-	return distance;
+	return Geometry::distance(x, y, position->x, position->y);
+}
+
+double Position::getSquaredDistanceTo(Position* position) const {
+	return Geometry::squaredDistance(x, y, position->x, position->y);
 }
 
 double Position::getDirectionTo(Position* position) const {
-	double direction = 180.0 * (atan2(position->y - y, position->x - x)) / Math::PI - body;
-	if (direction >= 180.0) {
-		direction -= 360.0;
-	} else if (direction < -180.0) {
-		direction += 360.0;
-	}
-	return direction;
+	return Geometry::angleDifference(Geometry::bearing(position->x - x, position->y - y), body);
 }
 
 void Position::mirror() {
@@ -0,0 +1,284 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file ReachTable.cpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "constants.hpp"
+#include "Configs.hpp"
+#include "PlayerType.hpp"
+#include "ReachTable.hpp"
+#include "Self.hpp"
+
+namespace Phoenix {
+
+const int ReachTable::DISTANCES;
+const int ReachTable::SPEEDS;
+const int ReachTable::MAX_CYCLES;
+
+static const double DISTANCE_STEP = 0.5;
+static const char CACHE_MAGIC[4] = {'P', 'H', 'R', 'T'};
+static const int CACHE_VERSION = 2;
+
+static std::vector<ReachTable*> tables;
+
+/*
+ * FNV-1a over the bytes of the model and the dimensions of the table
+ */
+static unsigned long long hashModel(const Physics::Model &model) {
+	unsigned long long hash = 14695981039346656037ULL;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&model);
+	for (size_t i = 0; i < sizeof(Physics::Model); ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	int dimensions[] = {CACHE_VERSION, ReachTable::DISTANCES, ReachTable::SPEEDS, ReachTable::MAX_CYCLES};
+	bytes = reinterpret_cast<const unsigned char*>(dimensions);
+	for (size_t i = 0; i < sizeof(dimensions); ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+ReachTable::ReachTable(const PlayerType* type) {
+	model = type->getModel();
+	simulator.setModel(model);
+	speed_step = 2.0 * model.player_speed_max / (SPEEDS - 1);
+	hash = hashModel(model);
+	cached = false;
+	error_bound = 0.0;
+	std::string filename = getFilename();
+	if (filename.length() > 0 && load(filename)) {
+		cached = true;
+	} else {
+		build();
+		if (filename.length() > 0) save(filename);
+	}
+}
+
+ReachTable::~ReachTable() {
+
+}
+
+std::string ReachTable::getFilename() const {
+	if (Configs::REACH_CACHE.length() == 0) return "";
+	char name[64];
+	sprintf(name, "/phoenix_reach_%016llx.tbl", hash);
+	return Configs::REACH_CACHE + name;
+}
+
+/*
+ * The player starts at the origin facing the x axis with the given speed and turns while the point
+ * is not inside the kick-able radius along its body line, returns the turns and leaves the distance
+ * to the point and the speed towards it in remaining and along
+ */
+int ReachTable::turnCycles(double distance, double angle, double speed, double &remaining, double &along) const {
+	if (distance < 0.0) distance = 0.0;
+	if (speed > model.player_speed_max) speed = model.player_speed_max;
+	if (speed < -model.player_speed_max) speed = -model.player_speed_max;
+	double x = 0.0;
+	double y = 0.0;
+	double vx = speed;
+	double vy = 0.0;
+	double body = 0.0;
+	double target_x = distance * cos(angle * Math::PI / 180.0);
+	double target_y = distance * sin(angle * Math::PI / 180.0);
+	double radius = model.player_size + model.ball_size + model.kickable_margin;
+	int n = 0;
+	for (; n < MAX_CYCLES; ++n) {
+		double dx = target_x - x;
+		double dy = target_y - y;
+		remaining = sqrt(dx * dx + dy * dy);
+		along = remaining > 0.0 ? (vx * dx + vy * dy) / remaining : 0.0;
+		if (remaining <= radius) break;
+		double diff = atan2(dy, dx) * 180.0 / Math::PI - body;
+		while (diff > 180.0) diff -= 360.0;
+		while (diff < -180.0) diff += 360.0;
+		if (fabs(diff) <= asin(radius / remaining) * 180.0 / Math::PI) break;
+		// A turn of Physics::Simulator::step with the moment that faces the point, bounded by the model
+		double inertia = 1.0 + model.inertia_moment * sqrt(vx * vx + vy * vy);
+		double moment = diff * inertia;
+		if (moment > model.maxmoment) moment = model.maxmoment;
+		if (moment < model.minmoment) moment = model.minmoment;
+		body += moment / inertia;
+		x += vx;
+		y += vy;
+		vx *= model.player_decay;
+		vy *= model.player_decay;
+	}
+	return n;
+}
+
+/*
+ * The player dashes with maximum power along a line starting with the given speed
+ */
+int ReachTable::dashCycles(double distance, double speed) const {
+	Physics::State state;
+	state.x = 0.0;
+	state.y = 0.0;
+	state.vx = speed;
+	state.vy = 0.0;
+	state.body = 0.0;
+	state.stamina = model.stamina_max;
+	state.ball_x = 1000.0;
+	state.ball_y = 1000.0;
+	state.ball_vx = 0.0;
+	state.ball_vy = 0.0;
+	double radius = model.player_size + model.ball_size + model.kickable_margin;
+	for (int n = 0; n < MAX_CYCLES; ++n) {
+		if (distance - state.x <= radius) return n;
+		simulator.step(state, Physics::Action(Physics::DASH, model.max_dash_power, 0.0));
+	}
+	return MAX_CYCLES;
+}
+
+int ReachTable::simulateCycles(double distance, double angle, double speed) const {
+	double remaining, along;
+	int cycles = turnCycles(distance, angle, speed, remaining, along) + dashCycles(remaining, along);
+	return cycles < MAX_CYCLES ? cycles : MAX_CYCLES;
+}
+
+void ReachTable::build() {
+	for (int d = 0; d < DISTANCES; ++d) {
+		for (int v = 0; v < SPEEDS; ++v) {
+			cycles[d][v] = (float)dashCycles(d * DISTANCE_STEP, v * speed_step - model.player_speed_max);
+		}
+	}
+	// The farthest and slowest corner of a cell minus the nearest and fastest one
+	error_bound = 0.0;
+	for (int d = 0; d < DISTANCES - 1; ++d) {
+		for (int v = 0; v < SPEEDS - 1; ++v) {
+			double error = cycles[d + 1][v] - cycles[d][v + 1];
+			if (error > error_bound) error_bound = error;
+		}
+	}
+}
+
+double ReachTable::getCycles(double distance, double angle, double speed) const {
+	double remaining, along;
+	int turns = turnCycles(distance, angle, speed, remaining, along);
+	double dashes;
+	double fd = remaining / DISTANCE_STEP;
+	if (fd >= DISTANCES - 1) {
+		// Beyond the table the dashes are simulated
+		dashes = dashCycles(remaining, along);
+	} else {
+		double fv = (along + model.player_speed_max) / speed_step;
+		if (fv < 0.0) fv = 0.0;
+		if (fv > SPEEDS - 1) fv = SPEEDS - 1;
+		int d0 = (int)fd;
+		int v0 = (int)fv;
+		if (v0 >= SPEEDS - 1) v0 = SPEEDS - 2;
+		double td = fd - d0;
+		double tv = fv - v0;
+		double c0 = cycles[d0][v0] * (1.0 - tv) + cycles[d0][v0 + 1] * tv;
+		double c1 = cycles[d0 + 1][v0] * (1.0 - tv) + cycles[d0 + 1][v0 + 1] * tv;
+		dashes = c0 * (1.0 - td) + c1 * td;
+	}
+	double total = turns + dashes;
+	return total < MAX_CYCLES ? total : MAX_CYCLES;
+}
+
+double ReachTable::getErrorBound() const {
+	return error_bound;
+}
+
+unsigned long long ReachTable::getHash() const {
+	return hash;
+}
+
+bool ReachTable::isCached() const {
+	return cached;
+}
+
+bool ReachTable::load(const std::string &filename) {
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) return false;
+	char magic[4];
+	int version = 0;
+	unsigned long long file_hash = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&file_hash), sizeof(file_hash));
+	if (!file || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || version != CACHE_VERSION || file_hash != hash) {
+		std::cerr << "ReachTable::load(string) -> ignoring invalid cache file " << filename << std::endl;
+		return false;
+	}
+	file.read(reinterpret_cast<char*>(&error_bound), sizeof(error_bound));
+	file.read(reinterpret_cast<char*>(cycles), sizeof(cycles));
+	if (!file) {
+		std::cerr << "ReachTable::load(string) -> truncated cache file " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ReachTable::save(const std::string &filename) const {
+	// Written to a temporary file and renamed, another agent never reads a partial table
+	std::string temporary = filename + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "ReachTable::save(string) -> could not open " << temporary << std::endl;
+		return;
+	}
+	file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+	file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	file.write(reinterpret_cast<const char*>(&error_bound), sizeof(error_bound));
+	file.write(reinterpret_cast<const char*>(cycles), sizeof(cycles));
+	file.close();
+	if (!file) {
+		std::cerr << "ReachTable::save(string) -> error writing " << temporary << std::endl;
+		return;
+	}
+	if (rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::cerr << "ReachTable::save(string) -> could not rename " << temporary << std::endl;
+	}
+}
+
+void ReachTable::buildTables() {
+	for (std::vector<ReachTable*>::iterator it = tables.begin(); it != tables.end(); ++it) {
+		delete *it;
+	}
+	tables.clear();
+	for (int id = 0; id < Self::PLAYER_TYPES; ++id) {
+		tables.push_back(new ReachTable(PlayerType::getPlayerType(id)));
+	}
+}
+
+const ReachTable* ReachTable::getReachTable(int type_id) {
+	if (tables.empty()) {
+		tables.push_back(new ReachTable(PlayerType::getPlayerType(0)));
+	}
+	if (type_id >= 0 && (unsigned int)type_id < tables.size()) {
+		return tables[type_id];
+	}
+	return tables[0];
+}
+
+} // End namespace Phoenix
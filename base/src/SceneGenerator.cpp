@@ -0,0 +1,384 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @file SceneGenerator.cpp
+ *
+ * @author Nelson Ivan Gonzalez
+ */
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include "SceneGenerator.hpp"
+#include "Server.hpp"
+#include "constants.hpp"
+
+namespace Phoenix {
+
+struct _landmark {
+	const char* name;
+	double x;
+	double y;
+};
+
+/*
+ * Flags and goals in the server coordinates (left side frame)
+ */
+static const _landmark landmarks[] = {
+	{"f t 0",     0.0, -39.0}, {"f t r 10",  10.0, -39.0}, {"f t r 20",  20.0, -39.0}, {"f t r 30",  30.0, -39.0},
+	{"f t r 40", 40.0, -39.0}, {"f t r 50",  50.0, -39.0}, {"f r t 30",  57.5, -30.0}, {"f r t 20",  57.5, -20.0},
+	{"f r t 10", 57.5, -10.0}, {"f r 0",     57.5,   0.0}, {"f r b 10",  57.5,  10.0}, {"f r b 20",  57.5,  20.0},
+	{"f r b 30", 57.5,  30.0}, {"f b r 50",  50.0,  39.0}, {"f b r 40",  40.0,  39.0}, {"f b r 30",  30.0,  39.0},
+	{"f b r 20", 20.0,  39.0}, {"f b r 10",  10.0,  39.0}, {"f b 0",      0.0,  39.0}, {"f b l 10", -10.0,  39.0},
+	{"f b l 20",-20.0,  39.0}, {"f b l 30", -30.0,  39.0}, {"f b l 40", -40.0,  39.0}, {"f b l 50", -50.0,  39.0},
+	{"f l b 30",-57.5,  30.0}, {"f l b 20", -57.5,  20.0}, {"f l b 10", -57.5,  10.0}, {"f l 0",    -57.5,   0.0},
+	{"f l t 10",-57.5, -10.0}, {"f l t 20", -57.5, -20.0}, {"f l t 30", -57.5, -30.0}, {"f t l 50", -50.0, -39.0},
+	{"f t l 40",-40.0, -39.0}, {"f t l 30", -30.0, -39.0}, {"f t l 20", -20.0, -39.0}, {"f t l 10", -10.0, -39.0},
+	{"f c",       0.0,   0.0}, {"f c t",      0.0, -34.0}, {"f r t",     52.5, -34.0}, {"f r b",     52.5,  34.0},
+	{"f c b",     0.0,  34.0}, {"f l b",    -52.5,  34.0}, {"f l t",    -52.5, -34.0}, {"g l",      -52.5,   0.0},
+	{"f g l t",-52.5,  -7.0}, {"f p l t",  -36.0, -20.0}, {"f p l c",  -36.0,   0.0}, {"f p l b",  -36.0,  20.0},
+	{"f g l b",-52.5,   7.0}, {"g r",       52.5,   0.0}, {"f g r t",   52.5,  -7.0}, {"f p r t",   36.0, -20.0},
+	{"f p r c", 36.0,   0.0}, {"f p r b",   36.0,  20.0}, {"f g r b",   52.5,   7.0}
+};
+static const int LANDMARKS = sizeof(landmarks) / sizeof(_landmark);
+
+/* Messages are formatted in a buffer of the size of the server messages */
+static const int MESSAGE_SIZE = 8192;
+
+/*
+ * Appends to the message in buffer with vsnprintf, the message is truncated at MESSAGE_SIZE
+ */
+static void append(char* buffer, int &length, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	int written = vsnprintf(buffer + length, MESSAGE_SIZE - length, format, args);
+	va_end(args);
+	if (written < 0) return;
+	length += written < MESSAGE_SIZE - 1 - length ? written : MESSAGE_SIZE - 1 - length;
+}
+
+static double normalize(double angle) {
+	while (angle > 180.0) angle -= 360.0;
+	while (angle < -180.0) angle += 360.0;
+	return angle;
+}
+
+/*
+ * Same rounding used by the server, the zero is added to avoid printing -0
+ */
+static double quantize(double value, double step) {
+	return rint(value / step) * step + 0.0;
+}
+
+static double quantizeDistance(double distance, double step) {
+	return quantize(exp(quantize(log(distance + 1.0e-10), step)), 0.1);
+}
+
+SceneGenerator::SceneGenerator(std::string team_l, std::string team_r, unsigned int seed) : rng(seed) {
+	this->team_l = team_l;
+	this->team_r = team_r;
+	observer_side = 'l';
+	observer_unum = 1;
+	view_width = "normal";
+	unum_far_length = 20.0;
+	unum_too_far_length = 40.0;
+	team_far_length = 40.0;
+	team_too_far_length = 60.0;
+}
+
+SceneGenerator::~SceneGenerator() {
+
+}
+
+void SceneGenerator::clear() {
+	for (int s = 0; s < 2; ++s) {
+		for (int u = 0; u < 12; ++u) {
+			players[s][u].clear();
+		}
+	}
+	ball.clear();
+}
+
+void SceneGenerator::setObserver(char side, int unum) {
+	observer_side = side;
+	observer_unum = unum;
+}
+
+void SceneGenerator::setViewWidth(std::string width) {
+	view_width = width;
+}
+
+void SceneGenerator::addWaypoint(char side, int unum, int time, double x, double y, double body, double neck) {
+	if (unum < 1 || unum > 11) {
+		std::cerr << "SceneGenerator::addWaypoint(char, int, int, double, double, double, double) -> invalid uniform number " << unum << std::endl;
+		return;
+	}
+	_waypoint waypoint = {time, x, y, body, neck};
+	std::vector<_waypoint> &trajectory = players[side == 'l' ? 0 : 1][unum];
+	std::vector<_waypoint>::iterator it = trajectory.begin();
+	while (it != trajectory.end() && it->time < time) ++it;
+	trajectory.insert(it, waypoint);
+}
+
+void SceneGenerator::addBallWaypoint(int time, double x, double y) {
+	_waypoint waypoint = {time, x, y, 0.0, 0.0};
+	std::vector<_waypoint>::iterator it = ball.begin();
+	while (it != ball.end() && it->time < time) ++it;
+	ball.insert(it, waypoint);
+}
+
+void SceneGenerator::randomize(int cycles) {
+	clear();
+	boost::uniform_real<> dist(0.0, 1.0);
+	for (int s = 0; s < 2; ++s) {
+		double sign = (s == 0) ? -1.0 : 1.0;
+		for (int u = 1; u < 12; ++u) {
+			double x = (u == 1) ? 50.0 * sign : sign * (5.0 + 45.0 * dist(rng));
+			double y = (u == 1) ? 0.0 : -32.0 + 64.0 * dist(rng);
+			double body = (s == 0) ? 0.0 : 180.0;
+			for (int t = 0; t <= cycles; t += 10) {
+				double neck = -90.0 + 180.0 * dist(rng);
+				addWaypoint(s == 0 ? 'l' : 'r', u, t, x, y, body, neck);
+				// Players move at most 0.8 meters per cycle
+				double step = 8.0 * dist(rng);
+				double direction = 2.0 * Math::PI * dist(rng);
+				double nx = x + step * cos(direction);
+				double ny = y + step * sin(direction);
+				if (nx > 52.0) nx = 52.0;
+				if (nx < -52.0) nx = -52.0;
+				if (ny > 33.0) ny = 33.0;
+				if (ny < -33.0) ny = -33.0;
+				if (nx != x || ny != y) {
+					body = 180.0 * atan2(ny - y, nx - x) / Math::PI;
+				}
+				x = nx;
+				y = ny;
+			}
+		}
+	}
+	double x = 0.0;
+	double y = 0.0;
+	for (int t = 0; t <= cycles; t += 5) {
+		addBallWaypoint(t, x, y);
+		x += -15.0 + 30.0 * dist(rng);
+		y += -15.0 + 30.0 * dist(rng);
+		if (x > 52.0) x = 52.0;
+		if (x < -52.0) x = -52.0;
+		if (y > 33.0) y = 33.0;
+		if (y < -33.0) y = -33.0;
+	}
+}
+
+SceneState SceneGenerator::interpolate(const std::vector<_waypoint> &trajectory, int time) const {
+	SceneState state = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	if (trajectory.empty()) {
+		return state;
+	}
+	// The velocity is the displacement to the next cycle, as the server moves the objects
+	double positions[2][2];
+	for (int k = 0; k < 2; ++k) {
+		int t = time + k;
+		size_t i = 0;
+		while (i + 1 < trajectory.size() && trajectory[i + 1].time <= t) ++i;
+		const _waypoint &a = trajectory[i];
+		if (t <= a.time || i + 1 == trajectory.size()) {
+			positions[k][0] = a.x;
+			positions[k][1] = a.y;
+			if (k == 0) {
+				state.body = a.body;
+				state.neck = a.neck;
+			}
+		} else {
+			const _waypoint &b = trajectory[i + 1];
+			double r = (double)(t - a.time) / (double)(b.time - a.time);
+			positions[k][0] = a.x + r * (b.x - a.x);
+			positions[k][1] = a.y + r * (b.y - a.y);
+			if (k == 0) {
+				state.body = normalize(a.body + r * normalize(b.body - a.body));
+				state.neck = a.neck + r * (b.neck - a.neck);
+			}
+		}
+	}
+	state.x = positions[0][0];
+	state.y = positions[0][1];
+	state.vx = positions[1][0] - positions[0][0];
+	state.vy = positions[1][1] - positions[0][1];
+	return state;
+}
+
+SceneState SceneGenerator::toObserverFrame(SceneState state) const {
+	if (observer_side == 'r') {
+		state.x = -state.x;
+		state.y = -state.y;
+		state.vx = -state.vx;
+		state.vy = -state.vy;
+		state.body = normalize(state.body + 180.0);
+	}
+	return state;
+}
+
+SceneState SceneGenerator::getPlayerState(char side, int unum, int time) const {
+	if (unum < 1 || unum > 11) {
+		SceneState state = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+		return state;
+	}
+	return toObserverFrame(interpolate(players[side == 'l' ? 0 : 1][unum], time));
+}
+
+SceneState SceneGenerator::getBallState(int time) const {
+	return toObserverFrame(interpolate(ball, time));
+}
+
+SceneState SceneGenerator::getObserverState(int time) const {
+	return getPlayerState(observer_side, observer_unum, time);
+}
+
+std::string SceneGenerator::getSee(int time) {
+	// Relative directions do not depend on the frame, so the server frame is used
+	SceneState self = interpolate(players[observer_side == 'l' ? 0 : 1][observer_unum], time);
+	double head = normalize(self.body + self.neck);
+	double visible_angle = Server::VISIBLE_ANGLE;
+	if (view_width.compare("narrow") == 0) {
+		visible_angle *= 0.5;
+	} else if (view_width.compare("wide") == 0) {
+		visible_angle *= 2.0;
+	}
+	boost::uniform_real<> dist(0.0, 1.0);
+	char buffer[MESSAGE_SIZE];
+	int length = 0;
+	append(buffer, length, "(see %d", time);
+	for (int i = 0; i < LANDMARKS; ++i) {
+		double dx = landmarks[i].x - self.x;
+		double dy = landmarks[i].y - self.y;
+		double distance = sqrt(dx * dx + dy * dy);
+		double direction = normalize(180.0 * atan2(dy, dx) / Math::PI - head);
+		if (fabs(direction) < visible_angle / 2.0) {
+			append(buffer, length, " ((%s) %g %g)", landmarks[i].name, quantizeDistance(distance, Server::QUANTIZE_STEP_L), quantize(direction, 1.0));
+		}
+	}
+	// Moving objects: the ball (s = -1) and the players
+	for (int s = -1; s < 2; ++s) {
+		for (int u = (s < 0) ? 0 : 1; u < ((s < 0) ? 1 : 12); ++u) {
+			const std::vector<_waypoint> &trajectory = (s < 0) ? ball : players[s][u];
+			if (trajectory.empty()) continue;
+			if (s == (observer_side == 'l' ? 0 : 1) && u == observer_unum) continue;
+			SceneState object = interpolate(trajectory, time);
+			double dx = object.x - self.x;
+			double dy = object.y - self.y;
+			double distance = sqrt(dx * dx + dy * dy);
+			double direction = normalize(180.0 * atan2(dy, dx) / Math::PI - head);
+			double qdistance = quantizeDistance(distance, Server::QUANTIZE_STEP);
+			if (fabs(direction) >= visible_angle / 2.0) {
+				// Objects out of the view cone are only felt if they are near
+				if (distance <= Server::VISIBLE_DISTANCE) {
+					append(buffer, length, " ((%s) %g %g)", (s < 0) ? "B" : "P", qdistance, quantize(direction, 1.0));
+				}
+				continue;
+			}
+			if (s < 0) {
+				append(buffer, length, " ((b)");
+			} else {
+				bool team = distance <= team_far_length;
+				if (!team && distance < team_too_far_length) {
+					team = dist(rng) < (team_too_far_length - distance) / (team_too_far_length - team_far_length);
+				}
+				bool unum = team && distance <= unum_far_length;
+				if (team && !unum && distance < unum_too_far_length) {
+					unum = dist(rng) < (unum_too_far_length - distance) / (unum_too_far_length - unum_far_length);
+				}
+				append(buffer, length, " ((p");
+				if (team) append(buffer, length, " \"%s\"", ((s == 0) ? team_l : team_r).c_str());
+				if (unum) append(buffer, length, " %d%s", u, (u == 1) ? " goalie" : "");
+				append(buffer, length, ")");
+			}
+			append(buffer, length, " %g %g", qdistance, quantize(direction, 1.0));
+			if (distance <= unum_far_length && distance > 0.0) {
+				double rvx = object.vx - self.vx;
+				double rvy = object.vy - self.vy;
+				double ex = dx / distance;
+				double ey = dy / distance;
+				double dist_chg = quantize(qdistance * quantize((rvx * ex + rvy * ey) / distance, 0.02), 0.1);
+				double dir_chg = quantize(180.0 * (rvy * ex - rvx * ey) / (Math::PI * distance), 0.1);
+				append(buffer, length, " %g %g", dist_chg, dir_chg);
+				if (s >= 0) {
+					append(buffer, length, " %g %g", quantize(normalize(object.body - head), 1.0), quantize(normalize(object.body + object.neck - head), 1.0));
+				}
+			}
+			append(buffer, length, ")");
+		}
+	}
+	append(buffer, length, ")");
+	return std::string(buffer, length);
+}
+
+std::string SceneGenerator::getSenseBody(int time) const {
+	SceneState self = getObserverState(time);
+	double speed = sqrt(self.vx * self.vx + self.vy * self.vy);
+	double direction = 0.0;
+	if (speed > 0.0) {
+		direction = normalize(180.0 * atan2(self.vy, self.vx) / Math::PI - self.body - self.neck);
+	}
+	char buffer[MESSAGE_SIZE];
+	int length = 0;
+	append(buffer, length, "(sense_body %d (view_mode high %s) (stamina 8000 1 130600) (speed %g %g) (head_angle %g)"
+			" (kick 0) (dash 0) (turn 0) (say 0) (turn_neck 0) (catch 0) (move 0) (change_view 0)"
+			" (arm (movable 0) (expires 0) (target 0 0) (count 0)) (focus (target none) (count 0))"
+			" (tackle (expires 0) (count 0)) (collision none) (foul  (charged 0) (card none)))",
+			time, view_width.c_str(), quantize(speed, 0.01), quantize(direction, 1.0), quantize(self.neck, 1.0));
+	return std::string(buffer, length);
+}
+
+std::string SceneGenerator::getFullstate(int time) const {
+	char buffer[MESSAGE_SIZE];
+	int length = 0;
+	append(buffer, length, "(fullstate %d (pmode play_on) (vmode high %s) (count 0 0 0 0 0 0 0 0)"
+			" (arm (movable 0) (expires 0) (count 0)) (score 0 0)", time, view_width.c_str());
+	if (!ball.empty()) {
+		SceneState b = getBallState(time);
+		append(buffer, length, " ((b) %g %g %g %g)", b.x, b.y, b.vx, b.vy);
+	}
+	for (int s = 0; s < 2; ++s) {
+		for (int u = 1; u < 12; ++u) {
+			if (players[s][u].empty()) continue;
+			SceneState p = getPlayerState(s == 0 ? 'l' : 'r', u, time);
+			append(buffer, length, " ((p %s%d%s%g %g %g %g %g %g (stamina 8000 1 1 130600))", (s == 0) ? "l " : "r ", u,
+					(u == 1) ? " g) " : " 0) ", p.x, p.y, p.vx, p.vy, p.body, p.neck);
+		}
+	}
+	append(buffer, length, ")");
+	return std::string(buffer, length);
+}
+
+int SceneGenerator::getCycles() const {
+	int cycles = 0;
+	for (int s = 0; s < 2; ++s) {
+		for (int u = 1; u < 12; ++u) {
+			if (!players[s][u].empty() && players[s][u].back().time > cycles) {
+				cycles = players[s][u].back().time;
+			}
+		}
+	}
+	if (!ball.empty() && ball.back().time > cycles) {
+		cycles = ball.back().time;
+	}
+	return cycles;
+}
+
+}
@@ -23,38 +23,26 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <pthread.h>
 #include <boost/regex.hpp>
-#include <boost/circular_buffer.hpp>
 #include "constants.hpp"
 #include "Command.hpp"
+#include "Commands.hpp"
 #include "Configs.hpp"
 #include "Self.hpp"
 #include "Server.hpp"
 #include "Game.hpp"
 #include "PFilter.hpp"
+#include "PlayerType.hpp"
 #include "functions.hpp"
 
 namespace Phoenix {
 
-int    *types_id;
-double *player_speed_max;
-double *stamina_inc_max;
-double *player_decay;
-double *inertia_moment;
-double *dash_power_rate;
-double *player_size;
-double *kickable_margin;
-double *kick_rand;
-double *extra_stamina;
-double *effort_max;
-double *effort_min;
-double *kick_power_rate;
-double *foul_detect_probability;
-double *catchable_area_l_stretch;
 Filters::PFilter<4> pfilter;
 
 double u[3] = {0.0, 0.0, 0.0}; //{dash_power, dash_direction, turn_moment}
@@ -99,36 +87,83 @@ static double y          = 0.0;
 static double body       = 0.0;
 static Position position;
 static Geometry::Vector2D velocity;
-static std::list<Command*> last_commands_sent;
-static boost::circular_buffer<std::string> view_mode_width_buffer(Configs::BUFFER_MAX_HISTORY, "normal");
-static boost::circular_buffer<std::string> view_mode_quality_buffer(Configs::BUFFER_MAX_HISTORY, "high");
-static boost::circular_buffer<double> stamina_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> effort_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> stamina_capacity_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> amount_of_speed_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> direction_of_speed_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> head_angle_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<int> kick_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> dash_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> turn_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> say_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> turn_neck_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> catch_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> move_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> change_view_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> arm_movable_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> arm_expires_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<double> arm_dist_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<double> arm_dir_buffer(Configs::BUFFER_MAX_HISTORY, 0.0);
-static boost::circular_buffer<int> arm_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<std::string> focus_target_buffer(Configs::BUFFER_MAX_HISTORY, "none");
-static boost::circular_buffer<int> focus_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> tackle_expires_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<int> tackle_count_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-std::list<std::string> empty_vector;
-static boost::circular_buffer<std::list<std::string> > collisions_buffer(Configs::BUFFER_MAX_HISTORY, empty_vector);
-static boost::circular_buffer<int> foul_charged_buffer(Configs::BUFFER_MAX_HISTORY, 0);
-static boost::circular_buffer<std::string> foul_card_buffer(Configs::BUFFER_MAX_HISTORY, "none");
+
+/*
+ * Commands sent of each type that the sense_body sensor has not confirmed yet, oldest first.  A
+ * command received late by the server is executed one cycle later, so a command is only lost
+ * when a second sense_body does not count it.  The slots are written by the parser thread and
+ * by the thread sending the commands
+ */
+struct _slot {
+	Command* pending[2];
+	unsigned int ages[2];
+	int size;
+};
+static const int COMMAND_TYPES = CHANGE_PLAYER_TYPE + 1;
+static _slot command_slots[COMMAND_TYPES];
+static CommandStats command_stats[COMMAND_TYPES];
+static pthread_mutex_t command_slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Holds the slots mutex while it is in scope
+ */
+class SlotsLock {
+public:
+	SlotsLock() {
+		if (pthread_mutex_lock(&command_slots_mutex) != 0) {
+			std::cerr << "Self::SlotsLock() -> can not lock mutex" << std::endl;
+		}
+	}
+	~SlotsLock() {
+		if (pthread_mutex_unlock(&command_slots_mutex) != 0) {
+			std::cerr << "Self::~SlotsLock() -> can not unlock mutex" << std::endl;
+		}
+	}
+};
+
+/*
+ * History of the sense_body sensor, the newest record is at sense_body_head.  The ring is
+ * allocated by the constructor and resized if Configs::BUFFER_MAX_HISTORY changes
+ */
+static SenseBody* sense_body_ring = 0;
+static unsigned int sense_body_size = 0;
+static unsigned int sense_body_head = 0;
+
+static void initSenseBody(SenseBody &record) {
+	std::memset(&record, 0, sizeof(SenseBody));
+	std::strcpy(record.view_mode_quality, "high");
+	std::strcpy(record.view_mode_width, "normal");
+	std::strcpy(record.focus_target, "none");
+	std::strcpy(record.foul_card, "none");
+}
+
+static void resizeSenseBodyRing(unsigned int size) {
+	if (size == 0) size = 1;
+	SenseBody* ring = new SenseBody[size];
+	for (unsigned int i = 0; i < size; ++i) {
+		initSenseBody(ring[i]);
+	}
+	// The newest records are kept, the oldest first
+	unsigned int kept = (sense_body_size < size) ? sense_body_size : size;
+	for (unsigned int i = 0; i < kept; ++i) {
+		ring[kept - 1 - i] = sense_body_ring[(sense_body_head + sense_body_size - i) % sense_body_size];
+	}
+	if (sense_body_ring) delete[] sense_body_ring;
+	sense_body_ring = ring;
+	sense_body_size = size;
+	sense_body_head = (kept > 0) ? kept - 1 : 0;
+}
+
+static void copyToken(char* token, size_t size, const boost::csub_match &match) {
+	size_t length = match.length();
+	if (length > size - 1) length = size - 1;
+	std::memcpy(token, match.first, length);
+	token[length] = '\0';
+}
+
+static bool containsToken(const char* begin, const char* end, const char* token) {
+	return std::search(begin, end, token, token + std::strlen(token)) != end;
+}
 
 std::string Self::TEAM_NAME                            = "Phoenix2D";
 int         Self::UNIFORM_NUMBER                       = 1;
@@ -206,18 +241,6 @@ std::list<std::string> Self::COLLISION;              //empty
 int         Self::FOUL_CHARGED                         = 0;
 std::string Self::FOUL_CARD                            = "none";
 
-std::string getPlayerTypeParameter(const std::string &player_type, std::string parameter) {
-	boost::regex parameter_regex("\\(" + parameter + "\\s+([\\w\\-\\.]+)\\)");
-	boost::cmatch match;
-	if (boost::regex_search(player_type.c_str(), match, parameter_regex)) {
-		std::string param = std::string() + match[1];
-		return param;
-	} else {
-		std::cerr << "Self::getParameter(string, string) -> search failed miserably for parameter " << parameter << std::endl;
-		return "";
-	}
-}
-
 std::string getPlayerParameter(const std::string &player_params, std::string parameter) {
 	boost::regex parameter_regex("\\(" + parameter + "\\s+([\\w\\-\\.]+)\\)");
 	boost::cmatch match;
@@ -263,282 +286,197 @@ Self::Self(std::string player_params, std::string team_name, int unum, std::stri
 	Self::RANDOM_SEED                          = atoi((getPlayerParameter(player_params, "random_seed")).c_str());
 	Self::STAMINA_INC_MAX_DELTA_FACTOR         = atof((getPlayerParameter(player_params, "stamina_inc_max_delta_factor")).c_str());
 	Self::SUBS_MAX                             = atoi((getPlayerParameter(player_params, "subs_max")).c_str());
-	types_id = new int[Self::PLAYER_TYPES];
-	player_speed_max = new double[Self::PLAYER_TYPES];
-	stamina_inc_max = new double[Self::PLAYER_TYPES];
-	player_decay = new double[Self::PLAYER_TYPES];
-	inertia_moment = new double[Self::PLAYER_TYPES];
-	dash_power_rate = new double[Self::PLAYER_TYPES];
-	player_size = new double[Self::PLAYER_TYPES];
-	kickable_margin = new double[Self::PLAYER_TYPES];
-	kick_rand = new double[Self::PLAYER_TYPES];
-	extra_stamina = new double[Self::PLAYER_TYPES];
-	effort_max = new double[Self::PLAYER_TYPES];
-	effort_min = new double[Self::PLAYER_TYPES];
-	kick_power_rate = new double[Self::PLAYER_TYPES];
-	foul_detect_probability = new double[Self::PLAYER_TYPES];
-	catchable_area_l_stretch = new double[Self::PLAYER_TYPES];
 	if (side.compare("r")) {
 		body = 180.0;
 	}
 	Flag::initializeField();
+	resizeSenseBodyRing(Configs::BUFFER_MAX_HISTORY);
 }
 
 Self::~Self() {
 	if (Configs::VERBOSE) std::cout << "Self out" << std::endl;
-	if (types_id)                 delete[] types_id;
-	if (player_speed_max)         delete[] player_speed_max;
-	if (stamina_inc_max)          delete[] stamina_inc_max;
-	if (player_decay)             delete[] player_decay;
-	if (inertia_moment)           delete[] inertia_moment;
-	if (dash_power_rate)          delete[] dash_power_rate;
-	if (player_size)              delete[] player_size;
-	if (kickable_margin)          delete[] kickable_margin;
-	if (kick_rand)                delete[] kick_rand;
-	if (extra_stamina)            delete[] extra_stamina;
-	if (effort_max)               delete[] effort_max;
-	if (effort_min)               delete[] effort_min;
-	if (kick_power_rate)          delete[] kick_power_rate;
-	if (foul_detect_probability)  delete[] foul_detect_probability;
-	if (catchable_area_l_stretch) delete[] catchable_area_l_stretch;
+	if (sense_body_ring)          delete[] sense_body_ring;
+	sense_body_ring = 0;
+	sense_body_size = 0;
 }
 
 void Self::addPlayerType(std::string player_type) {
-	int id = atoi((getPlayerTypeParameter(player_type, "id")).c_str());
-	types_id[id]                 = id;
-	player_speed_max[id]         = atof((getPlayerTypeParameter(player_type, "player_speed_max")).c_str());
-	stamina_inc_max[id]          = atof((getPlayerTypeParameter(player_type, "stamina_inc_max")).c_str());
-	player_decay[id]             = atof((getPlayerTypeParameter(player_type, "player_decay")).c_str());
-	inertia_moment[id]           = atof((getPlayerTypeParameter(player_type, "inertia_moment")).c_str());
-	dash_power_rate[id]          = atof((getPlayerTypeParameter(player_type, "dash_power_rate")).c_str());
-	player_size[id]              = atof((getPlayerTypeParameter(player_type, "player_size")).c_str());
-	kickable_margin[id]          = atof((getPlayerTypeParameter(player_type, "player_size")).c_str());
-	kick_rand[id]                = atof((getPlayerTypeParameter(player_type, "kick_rand")).c_str());
-	extra_stamina[id]            = atof((getPlayerTypeParameter(player_type, "extra_stamina")).c_str());
-	effort_max[id]               = atof((getPlayerTypeParameter(player_type, "effort_max")).c_str());
-	effort_min[id]               = atof((getPlayerTypeParameter(player_type, "effort_min")).c_str());
-	kick_power_rate[id]          = atof((getPlayerTypeParameter(player_type, "kick_power_rate")).c_str());
-	foul_detect_probability[id]  = atof((getPlayerTypeParameter(player_type, "foul_detect_probability")).c_str());
-	catchable_area_l_stretch[id] = atof((getPlayerTypeParameter(player_type, "catchable_area_l_stretch")).c_str());
+	PlayerType::addPlayerType(PlayerType(player_type));
+}
+
+/*
+ * Resolves the pending commands of the given type with the number of commands executed since
+ * the previous sense_body, returns the newest command executed
+ */
+static Command* confirmCommand(COMMAND_TYPE type, int executed) {
+	SlotsLock lock;
+	_slot &slot = command_slots[type];
+	Command* last_executed = 0;
+	int kept = 0;
+	for (int i = 0; i < slot.size; ++i) {
+		Command* command = slot.pending[i];
+		if (executed > 0) {
+			command->changeStatusTo(EXECUTED);
+			command_stats[type].executed++;
+			last_executed = command;
+			executed--;
+		} else if (slot.ages[i] > 0) {
+			command->changeStatusTo(LOST);
+			command_stats[type].lost++;
+		} else {
+			slot.pending[kept] = command;
+			slot.ages[kept] = 1;
+			kept++;
+		}
+	}
+	slot.size = kept;
+	return last_executed;
 }
 
 void Self::processSenseBody(std::string sense_body) {
 	u[0] = u[1] = u[2] = 0.0;
 	boost::cmatch match;
 	if (boost::regex_match(sense_body.c_str(), match, sense_body_regex)) {
-		Command* kick_ptr = 0;
-		Command* dash_ptr = 0;
-		Command* turn_ptr = 0;
-		Command* say_ptr = 0;
-		Command* turn_neck_ptr = 0;
-		Command* catch_ptr = 0;
-		Command* move_ptr = 0;
-		Command* change_view_ptr = 0;
-		Command* point_to_ptr = 0;
-		Command* tackle_ptr = 0;
-		for (std::list<Command*>::iterator it = last_commands_sent.begin(); it != last_commands_sent.end(); ++it) {
-			switch ((*it)->getCommandType()) {
-			case KICK:
-				kick_ptr = *it;
-				break;
-			case DASH:
-				dash_ptr = *it;
-				break;
-			case TURN:
-				turn_ptr = *it;
-				break;
-			case SAY:
-				say_ptr = *it;
-				break;
-			case TURN_NECK:
-				turn_neck_ptr = *it;
-				break;
-			case CATCH:
-				catch_ptr = *it;
-				break;
-			case MOVE:
-				move_ptr = *it;
-				break;
-			case CHANGE_VIEW:
-				change_view_ptr = *it;
-				break;
-			case POINT:
-				point_to_ptr = *it;
-				break;
-			case TACKLE:
-				tackle_ptr = *it;
-				break;
-			default:
-				break;
-			}
+		if (sense_body_size != Configs::BUFFER_MAX_HISTORY) {
+			resizeSenseBodyRing(Configs::BUFFER_MAX_HISTORY);
 		}
-		//view_mode_quality
-		Self::VIEW_MODE_QUALITY = match[1];
-		view_mode_quality_buffer.push_front(Self::VIEW_MODE_QUALITY);
-		//view_mode_width
-		Self::VIEW_MODE_WIDTH = match[2];
-		view_mode_width_buffer.push_front(Self::VIEW_MODE_WIDTH);
-		//stamina
-		Self::STAMINA = atof((std::string() + match[3]).c_str());
-		stamina_buffer.push_front(Self::STAMINA);
-		//effort
-		Self::EFFORT = atof((std::string() + match[4]).c_str());
-		effort_buffer.push_front(Self::EFFORT);
-		//stamina_capacity
-		Self::STAMINA_CAPACITY = atof((std::string() + match[5]).c_str());
-		stamina_capacity_buffer.push_front(Self::STAMINA_CAPACITY);
-		//amount_of_speed
-		Self::AMOUNT_OF_SPEED = atof((std::string() + match[6]).c_str());
-		amount_of_speed_buffer.push_front(Self::AMOUNT_OF_SPEED);
-		//direction_of_speed
-		Self::DIRECTION_OF_SPEED = atof((std::string() + match[7]).c_str());
-		direction_of_speed_buffer.push_front(Self::DIRECTION_OF_SPEED);
-		velocity = Geometry::Vector2D(AMOUNT_OF_SPEED, DIRECTION_OF_SPEED, true);
-		//head_angle
-		Self::HEAD_ANGLE = atof((std::string() + match[8]).c_str());
-		head_angle_buffer.push_front(Self::HEAD_ANGLE);
-		//kick_count
-		Self::KICK_COUNT = atoi((std::string() + match[9]).c_str());
-		if (Self::KICK_COUNT > Self::getKickCountAtTime(0)) {
-			if (kick_ptr) kick_ptr->changeStatusTo(EXECUTED);
+		const SenseBody &last = sense_body_ring[sense_body_head];
+		SenseBody record;
+		record.time = atoi(sense_body.c_str() + 11);
+		copyToken(record.view_mode_quality, sizeof(record.view_mode_quality), match[1]);
+		copyToken(record.view_mode_width, sizeof(record.view_mode_width), match[2]);
+		record.stamina = atof(match[3].first);
+		record.effort = atof(match[4].first);
+		record.stamina_capacity = atof(match[5].first);
+		record.amount_of_speed = atof(match[6].first);
+		record.direction_of_speed = atof(match[7].first);
+		record.head_angle = atof(match[8].first);
+		record.kick_count = atoi(match[9].first);
+		record.dash_count = atoi(match[10].first);
+		record.turn_count = atoi(match[11].first);
+		record.say_count = atoi(match[12].first);
+		record.turn_neck_count = atoi(match[13].first);
+		record.catch_count = atoi(match[14].first);
+		record.move_count = atoi(match[15].first);
+		record.change_view_count = atoi(match[16].first);
+		record.arm_movable = atoi(match[17].first);
+		record.arm_expires = atoi(match[18].first);
+		record.arm_dist = atof(match[19].first);
+		record.arm_dir = atof(match[20].first);
+		record.arm_count = atoi(match[21].first);
+		copyToken(record.focus_target, sizeof(record.focus_target), match[22]);
+		record.focus_count = atoi(match[23].first);
+		record.tackle_expires = atoi(match[24].first);
+		record.tackle_count = atoi(match[25].first);
+		// The regex only keeps the last collision, the whole collision section is searched instead
+		record.collisions = COLLISION_NONE;
+		if (containsToken(match[25].second, match[27].first, "(ball)")) record.collisions |= COLLISION_BALL;
+		if (containsToken(match[25].second, match[27].first, "(player)")) record.collisions |= COLLISION_PLAYER;
+		if (containsToken(match[25].second, match[27].first, "(post)")) record.collisions |= COLLISION_POST;
+		record.foul_charged = atoi(match[27].first);
+		copyToken(record.foul_card, sizeof(record.foul_card), match[28]);
+		// The commands are confirmed against the previous record
+		confirmCommand(KICK, record.kick_count - last.kick_count);
+		Command* dash_ptr = confirmCommand(DASH, record.dash_count - last.dash_count);
+		if (dash_ptr) {
+			u[0] = dash_ptr->getDashPower();
+			u[1] = dash_ptr->getDashDirection();
 		}
-		kick_count_buffer.push_front(Self::KICK_COUNT);
-		//dash_count
-		Self::DASH_COUNT = atoi((std::string() + match[10]).c_str());
-		if (Self::DASH_COUNT > Self::getDashCountAtTime(0)) {
-			if (dash_ptr) {
-				u[0] = dash_ptr->getDashPower();
-				u[1] = dash_ptr->getDashDirection();
-				dash_ptr->changeStatusTo(EXECUTED);
-			}
+		Command* turn_ptr = confirmCommand(TURN, record.turn_count - last.turn_count);
+		if (turn_ptr) {
+			u[2] = turn_ptr->getTurnMoment();
 		}
-		dash_count_buffer.push_front(Self::DASH_COUNT);
-		//turn_count
-		Self::TURN_COUNT = atoi((std::string() + match[11]).c_str());
-		if (Self::TURN_COUNT > Self::getTurnCountAtTime(0)) {
-			if (turn_ptr) {
-				u[2] = turn_ptr->getTurnMoment();
-				turn_ptr->changeStatusTo(EXECUTED);
+		confirmCommand(SAY, record.say_count - last.say_count);
+		confirmCommand(TURN_NECK, record.turn_neck_count - last.turn_neck_count);
+		confirmCommand(CATCH, record.catch_count - last.catch_count);
+		Command* move_ptr = confirmCommand(MOVE, record.move_count - last.move_count);
+		if (move_ptr) {
+			x = move_ptr->getMoveX();
+			y = move_ptr->getMoveY();
+			position = Position(x, y, body);
+//			pfilter.initWithBelief(x, y, theta, 5.0, 5.0, 10.0);
+			if (Configs::LOCALIZATION.compare("particlefilter") == 0) {
+				double mus[4];
+				mus[0] = x;
+				mus[1] = y;
+				mus[2] = cos(body * Math::PI / 180.0);
+				mus[3] = sin(body * Math::PI / 180.0);
+				double devs[] = {5.0, 5.0, 0.2, 0.2};
+				pfilter.initWithBelief(mus, devs);
 			}
+			positioned = true;
 		}
-		turn_count_buffer.push_front(Self::TURN_COUNT);
-		//say_count
-		Self::SAY_COUNT = atoi((std::string() + match[12]).c_str());
-		if (Self::SAY_COUNT > Self::getSayCountAtTime(0)) {
-			if (say_ptr) say_ptr->changeStatusTo(EXECUTED);
-		}
-		say_count_buffer.push_front(Self::SAY_COUNT);
-		//turn_neck_count
-		Self::TURN_NECK_COUNT = atoi((std::string() + match[13]).c_str());
-		if (Self::TURN_NECK_COUNT > Self::getTurnNeckCountAtTime(0)) {
-			if (turn_neck_ptr) turn_neck_ptr->changeStatusTo(EXECUTED);
-		}
-		turn_neck_count_buffer.push_front(Self::TURN_NECK_COUNT);
-		//catch_count
-		Self::CATCH_COUNT = atoi((std::string() + match[14]).c_str());
-		if (Self::CATCH_COUNT > Self::getCatchCountAtTime(0)) {
-			if (catch_ptr) catch_ptr->changeStatusTo(EXECUTED);
-		}
-		catch_count_buffer.push_front(Self::CATCH_COUNT);
-		//move_count
-		Self::MOVE_COUNT = atoi((std::string() + match[15]).c_str());
-		if (Self::MOVE_COUNT > Self::getMoveCountAtTime(0)) {
-			if (move_ptr) {
-				x = move_ptr->getMoveX();
-				y = move_ptr->getMoveY();
-				position = Position(x, y, body);
-//				pfilter.initWithBelief(x, y, theta, 5.0, 5.0, 10.0);
-				if (Configs::LOCALIZATION.compare("particlefilter") == 0) {
-					double mus[4];
-					mus[0] = x;
-					mus[1] = y;
-					mus[2] = cos(body * Math::PI / 180.0);
-					mus[3] = sin(body * Math::PI / 180.0);
-					double devs[] = {5.0, 5.0, 0.2, 0.2};
-					pfilter.initWithBelief(mus, devs);
-				}
-				positioned = true;
-				move_ptr->changeStatusTo(EXECUTED);
-			}
-		}
-		move_count_buffer.push_front(Self::MOVE_COUNT);
-		//change_view_count
-		Self::CHANGE_VIEW_COUNT = atoi((std::string() + match[16]).c_str());
-		if (Self::CHANGE_VIEW_COUNT > Self::getChangeViewCountAtTime(0)) {
-			if (change_view_ptr) change_view_ptr->changeStatusTo(EXECUTED);
-		}
-		change_view_count_buffer.push_front(Self::CHANGE_VIEW_COUNT);
-		//arm_movable
-		Self::ARM_MOVABLE = atoi((std::string() + match[17]).c_str());
-		arm_movable_buffer.push_front(Self::ARM_MOVABLE);
-		//arm_expires
-		Self::ARM_EXPIRES = atoi((std::string() + match[18]).c_str());
-		arm_expires_buffer.push_front(Self::ARM_EXPIRES);
-		//arm_dist
-		Self::ARM_DIST = atof((std::string() + match[19]).c_str());
-		arm_dist_buffer.push_front(Self::ARM_DIST);
-		//arm_dir
-		Self::ARM_DIR = atof((std::string() + match[20]).c_str());
-		arm_dir_buffer.push_front(Self::ARM_DIR);
-		//arm_count
-		Self::ARM_COUNT = atoi((std::string() + match[21]).c_str());
-		if (Self::ARM_COUNT > Self::getArmCountAtTime(0)) {
-			if (point_to_ptr) point_to_ptr->changeStatusTo(EXECUTED);
+		confirmCommand(CHANGE_VIEW, record.change_view_count - last.change_view_count);
+		confirmCommand(POINT, record.arm_count - last.arm_count);
+		confirmCommand(TACKLE, record.tackle_count - last.tackle_count);
+		if (record.collisions != last.collisions || Self::COLLISION.empty()) {
+			Self::COLLISION.clear();
+			if (record.collisions & COLLISION_BALL) Self::COLLISION.push_back("(ball)");
+			if (record.collisions & COLLISION_PLAYER) Self::COLLISION.push_back("(player)");
+			if (record.collisions & COLLISION_POST) Self::COLLISION.push_back("(post)");
+			if (Self::COLLISION.empty()) Self::COLLISION.push_back("none");
 		}
-		arm_count_buffer.push_front(Self::ARM_COUNT);
-		//focus_target
-		Self::FOCUS_TARGET = match[22];
-		focus_target_buffer.push_front(Self::FOCUS_TARGET);
-		//focus_count
-		Self::FOCUS_COUNT = atoi((std::string() + match[23]).c_str());
-		focus_count_buffer.push_front(Self::FOCUS_COUNT);
-		//tackle_expires
-		Self::TACKLE_EXPIRES = atoi((std::string() + match[24]).c_str());
-		tackle_expires_buffer.push_front(Self::TACKLE_EXPIRES);
-		//tackle_count
-		Self::TACKLE_COUNT = atoi((std::string() + match[25]).c_str());
-		if (Self::TACKLE_COUNT > Self::getTackleCountAtTime(0)) {
-			if (tackle_ptr) tackle_ptr->changeStatusTo(EXECUTED);
-		}
-		tackle_count_buffer.push_front(Self::TACKLE_COUNT);
-		//collisions
-		std::string stream = std::string() + match[26];
-		std::stringstream ss(stream);
-		std::string token;
-		std::list<std::string> collisions;
-		while(std::getline(ss, token, ' ')) {
-			collisions.push_back(token);
-		}
-		Self::COLLISION = collisions;
-		collisions_buffer.push_front(Self::COLLISION);
-		//foul_charged
-		Self::FOUL_CHARGED = atoi((std::string() + match[27]).c_str());
-		foul_charged_buffer.push_front(Self::FOUL_CHARGED);
-		//foul_card
-		Self::FOUL_CARD = match[28];
-		foul_card_buffer.push_front(Self::FOUL_CARD);
+		sense_body_head = (sense_body_head + 1) % sense_body_size;
+		sense_body_ring[sense_body_head] = record;
+		Self::VIEW_MODE_QUALITY = record.view_mode_quality;
+		Self::VIEW_MODE_WIDTH = record.view_mode_width;
+		Self::STAMINA = record.stamina;
+		Self::EFFORT = record.effort;
+		Self::STAMINA_CAPACITY = record.stamina_capacity;
+		Self::AMOUNT_OF_SPEED = record.amount_of_speed;
+		Self::DIRECTION_OF_SPEED = record.direction_of_speed;
+		velocity = Geometry::Vector2D(AMOUNT_OF_SPEED, DIRECTION_OF_SPEED, true);
+		Self::HEAD_ANGLE = record.head_angle;
+		Self::KICK_COUNT = record.kick_count;
+		Self::DASH_COUNT = record.dash_count;
+		Self::TURN_COUNT = record.turn_count;
+		Self::SAY_COUNT = record.say_count;
+		Self::TURN_NECK_COUNT = record.turn_neck_count;
+		Self::CATCH_COUNT = record.catch_count;
+		Self::MOVE_COUNT = record.move_count;
+		Self::CHANGE_VIEW_COUNT = record.change_view_count;
+		Self::ARM_MOVABLE = record.arm_movable;
+		Self::ARM_EXPIRES = record.arm_expires;
+		Self::ARM_DIST = record.arm_dist;
+		Self::ARM_DIR = record.arm_dir;
+		Self::ARM_COUNT = record.arm_count;
+		Self::FOCUS_TARGET = record.focus_target;
+		Self::FOCUS_COUNT = record.focus_count;
+		Self::TACKLE_EXPIRES = record.tackle_expires;
+		Self::TACKLE_COUNT = record.tackle_count;
+		Self::FOUL_CHARGED = record.foul_charged;
+		Self::FOUL_CARD = record.foul_card;
 	} else {
 		std::cerr << "Self::processSenseBody(string) -> failed to match " << sense_body << std::endl;
 	}
 }
 
 void Self::changePlayerType(int type) {
-	if (type < Self::PLAYER_TYPES) {
-		Self::PLAYER_SPEED_MAX         = player_speed_max[type];
-		Self::STAMINA_INC_MAX          = stamina_inc_max[type];
-		Self::PLAYER_DECAY             = player_decay[type];
-		Self::INERTIA_MOMENT           = inertia_moment[type];
-		Self::DASH_POWER_RATE          = dash_power_rate[type];
-		Self::PLAYER_SIZE              = player_size[type];
-		Self::KICKABLE_MARGIN          = kickable_margin[type];
-		Self::KICK_RAND                = kick_rand[type];
-		Self::EXTRA_STAMINA            = extra_stamina[type];
-		Self::EFFORT_MAX               = effort_max[type];
-		Self::EFFORT_MIN               = effort_min[type];
-		Self::KICK_POWER_RATE          = kick_power_rate[type];
-		Self::FOUL_DETECT_PROBABILITY  = foul_detect_probability[type];
-		Self::CATCHABLE_AREA_L_STRETCH = catchable_area_l_stretch[type];
+	if (type < 0 || type >= Self::PLAYER_TYPES) {
+		std::cerr << "Self::changePlayerType(int) -> invalid type " << type << std::endl;
+		return;
 	}
+	const PlayerType* player_type = PlayerType::getPlayerType(type);
+	Self::TYPE_ID                  = type;
+	Self::PLAYER_SPEED_MAX         = player_type->getPlayerSpeedMax();
+	Self::STAMINA_INC_MAX          = player_type->getStaminaIncMax();
+	Self::PLAYER_DECAY             = player_type->getPlayerDecay();
+	Self::INERTIA_MOMENT           = player_type->getInertiaMoment();
+	Self::DASH_POWER_RATE          = player_type->getDashPowerRate();
+	Self::PLAYER_SIZE              = player_type->getPlayerSize();
+	Self::KICKABLE_MARGIN          = player_type->getKickableMargin();
+	Self::KICK_RAND                = player_type->getKickRand();
+	Self::EXTRA_STAMINA            = player_type->getExtraStamina();
+	Self::EFFORT_MAX               = player_type->getEffortMax();
+	Self::EFFORT_MIN               = player_type->getEffortMin();
+	Self::KICK_POWER_RATE          = player_type->getKickPowerRate();
+	Self::FOUL_DETECT_PROBABILITY  = player_type->getFoulDetectProbability();
+	Self::CATCHABLE_AREA_L_STRETCH = player_type->getCatchableAreaLStretch();
+	PlayerType::setPlayerTypeFor(true, Self::UNIFORM_NUMBER, type);
+}
+
+const PlayerType* Self::getPlayerType() {
+	return PlayerType::getPlayerType(Self::TYPE_ID);
 }
 
 /**
@@ -590,8 +528,8 @@ bool flagsTriangulation(Flag* flag0, Flag* flag1, double &x_t, double &y_t, doub
 			return false;
 		}
 	}
-	double d0 = sqrt(pow(x0 - x, 2.0) + pow(y0 - y, 2.0));
-	double d1 = sqrt(pow(x1 - x, 2.0) + pow(y1 - y, 2.0));
+	double d0 = Geometry::squaredDistance(x0, y0, x, y);
+	double d1 = Geometry::squaredDistance(x1, y1, x, y);
 	double gamma0, gamma1;
 	if (d0 < d1) {
 		x_t = x0;
@@ -638,14 +576,27 @@ void predict(Filters::Particle<4> &particle) {
 	particle.dimension[3] = sin(Math::PI * direction / 180.0);
 }
 
+/*
+ * Deviation (degrees) of the direction of a flag seen from a particle, the server rounds the
+ * directions to a degree, the position of the particle is not exact and the turns not confirmed
+ * by the sense_body are not predicted
+ */
+static const double FLAG_DIRECTION_DEV = 8.0;
+
 void update(Filters::Particle<4> &particle) {
 	particle.weight = 1.0;
+	double heading = Geometry::bearing(particle.dimension[2], particle.dimension[3]) + Self::HEAD_ANGLE;
 	for (std::vector<Flag>::iterator it = current_flags.begin(); it != current_flags.end(); ++it) {
-		double x = sqrt(pow(particle.dimension[0] - it->getX(), 2.0) + pow(particle.dimension[1] - it->getY(), 2.0));
+		double rx = it->getX() - particle.dimension[0];
+		double ry = it->getY() - particle.dimension[1];
+		double x = sqrt(rx * rx + ry * ry);
 		double a = it->getDistance() - 2.0 * it->getDistanceError();
 		double b = it->getDistance() + it->getDistanceError();
-		Math::Uniform u(a, b);
-		particle.weight *= u.evaluate(x); //Math::uniform(u, x);
+		// Gaussian over the interval of the flag so a particle slightly outside is not discarded
+		double r = (x - 0.5 * (a + b)) / (0.5 * (b - a) + 0.1);
+		// The direction of the flag relative to the head weights the heading of the particle
+		double e = Geometry::angleDifference(Geometry::bearing(rx, ry) - heading, it->getDirection()) / FLAG_DIRECTION_DEV;
+		particle.weight *= exp(-0.5 * (r * r + e * e));
 	}
 }
 
@@ -723,8 +674,15 @@ void lowpassfilter(std::vector<Flag> flags) {
 	body = Geometry::toDegrees(Math::arcsMean(thetas)) - Self::HEAD_ANGLE; //theta = angleMean(thetas);
 }
 
+/*
+ * The particles are weighted with the distances and the directions of the flags, so the filter
+ * estimates the position and the heading.  The position noise grows with the speed of the agent,
+ * the heading noise (about 10 degrees on the cosine and the sine) covers the turns not predicted
+ */
 void particlefilter(std::vector<Flag> flags) {
 	pfilter.predict(predict);
+	double devs[] = {0.05 + Server::PLAYER_RAND * velc, 0.05 + Server::PLAYER_RAND * velc, 0.2, 0.2};
+	pfilter.diffuse(devs);
 	if (flags.size() > 0) {
 		current_flags = flags;
 		pfilter.update(update);
@@ -732,7 +690,7 @@ void particlefilter(std::vector<Flag> flags) {
 	pfilter.resample();
 	x = pfilter.getMean(0);
 	y = pfilter.getMean(1);
-	body = 180.0 * atan2(pfilter.getMean(3), pfilter.getMean(4)) / Math::PI;
+	body = 180.0 * atan2(pfilter.getMean(3), pfilter.getMean(2)) / Math::PI;
 }
 
 void Self::localize(std::vector<Flag> flags) {
@@ -762,115 +720,215 @@ const Geometry::Vector2D* Self::getVelocity() {
 }
 
 void Self::setLastCommandsSet(std::list<Command*> last_commands_sent_t) {
-	last_commands_sent.swap(last_commands_sent_t);
+	Command* commands[Commands::QUEUE_SIZE];
+	int size = 0;
+	for (std::list<Command*>::iterator it = last_commands_sent_t.begin(); it != last_commands_sent_t.end() && size < Commands::QUEUE_SIZE; ++it) {
+		commands[size++] = *it;
+	}
+	setLastCommandsSet(commands, size);
+}
+
+void Self::setLastCommandsSet(Command** last_commands_sent_t, int size) {
+	SlotsLock lock;
+	for (int i = 0; i < size; ++i) {
+		int type = last_commands_sent_t[i]->getCommandType();
+		// Only the commands reported by the sense_body sensor can be confirmed
+		if (type < MOVE || type > CHANGE_VIEW) continue;
+		_slot &slot = command_slots[type];
+		// A command not seen by any sense_body yet is replaced by the newer one
+		if (slot.size > 0 && slot.ages[slot.size - 1] == 0) {
+			slot.pending[slot.size - 1]->changeStatusTo(LOST);
+			command_stats[type].overridden++;
+			slot.size--;
+		}
+		slot.pending[slot.size] = last_commands_sent_t[i];
+		slot.ages[slot.size] = 0;
+		slot.size++;
+		command_stats[type].sent++;
+	}
+}
+
+CommandStats Self::getCommandStats(int command_type) {
+	if (command_type < 0 || command_type >= COMMAND_TYPES) {
+		CommandStats stats = {0, 0, 0, 0};
+		return stats;
+	}
+	SlotsLock lock;
+	return command_stats[command_type];
+}
+
+double Self::getCommandLossRate(int command_type) {
+	CommandStats stats = getCommandStats(command_type);
+	unsigned int lost = stats.lost + stats.overridden;
+	if (stats.executed + lost == 0) return 0.0;
+	return (double)lost / (double)(stats.executed + lost);
+}
+
+const SenseBody* Self::getSenseBodyAtTime(unsigned int time) {
+	if (time >= sense_body_size) return 0;
+	return &sense_body_ring[(sense_body_head + sense_body_size - time) % sense_body_size];
+}
+
+unsigned int Self::getHistory(double SenseBody::*field, double* values, unsigned int cycles) {
+	unsigned int size = (cycles < sense_body_size) ? cycles : sense_body_size;
+	for (unsigned int i = 0; i < size; ++i) {
+		values[i] = sense_body_ring[(sense_body_head + sense_body_size - i) % sense_body_size].*field;
+	}
+	return size;
+}
+
+unsigned int Self::getHistory(int SenseBody::*field, int* values, unsigned int cycles) {
+	unsigned int size = (cycles < sense_body_size) ? cycles : sense_body_size;
+	for (unsigned int i = 0; i < size; ++i) {
+		values[i] = sense_body_ring[(sense_body_head + sense_body_size - i) % sense_body_size].*field;
+	}
+	return size;
 }
 
 std::string Self::getViewModeWidthAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? view_mode_width_buffer[time] : "";
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? std::string(record->view_mode_width) : std::string("");
 }
 
 std::string Self::getViewModeQualityAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? view_mode_quality_buffer[time] : "";
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? std::string(record->view_mode_quality) : std::string("");
 }
 
 double Self::getStaminaAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? stamina_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->stamina : 0.0;
 }
 
 double Self::getEffortAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? effort_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->effort : 0.0;
 }
 
 double Self::getStaminaCapacityAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? stamina_capacity_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->stamina_capacity : 0.0;
 }
 
 double Self::getAmountOfSpeedAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? amount_of_speed_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->amount_of_speed : 0.0;
 }
 
 double Self::getDirectionOfSpeedAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? direction_of_speed_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->direction_of_speed : 0.0;
+}
+
+double Self::getHeadAngleAtTime(unsigned int time) {
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->head_angle : 0.0;
 }
 
 int Self::getKickCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? kick_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->kick_count : 0;
 }
 
 int Self::getDashCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? dash_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->dash_count : 0;
 }
 
 int Self::getTurnCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? turn_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->turn_count : 0;
 }
 
 int Self::getSayCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? say_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->say_count : 0;
 }
 
 int Self::getTurnNeckCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? turn_neck_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->turn_neck_count : 0;
 }
 
 int Self::getCatchCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? catch_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->catch_count : 0;
 }
 
 int Self::getMoveCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? move_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->move_count : 0;
 }
 
 int Self::getChangeViewCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? change_view_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->change_view_count : 0;
 }
 
 int Self::getArmMovableAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? arm_movable_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->arm_movable : 0;
 }
 
 int Self::getArmExpiresAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? arm_expires_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->arm_expires : 0;
 }
 
 double Self::getArmDistAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? arm_dist_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->arm_dist : 0.0;
 }
 
 double Self::getArmDirAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? arm_dir_buffer[time] : 0.0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->arm_dir : 0.0;
 }
 
 int Self::getArmCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? arm_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->arm_count : 0;
 }
 
 std::string Self::getFocusTargetAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? focus_target_buffer[time] : "";
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? std::string(record->focus_target) : std::string("");
 }
 
 int Self::getFocusCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? focus_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->focus_count : 0;
 }
 
 int Self::getTackleExpiresAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? tackle_expires_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->tackle_expires : 0;
 }
 
 int Self::getTackleCountAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? tackle_count_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->tackle_count : 0;
 }
 
 std::list<std::string> Self::getCollisionsAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? collisions_buffer[time] : empty_vector;
+	std::list<std::string> collisions;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	if (!record) return collisions;
+	if (record->collisions & COLLISION_BALL) collisions.push_back("(ball)");
+	if (record->collisions & COLLISION_PLAYER) collisions.push_back("(player)");
+	if (record->collisions & COLLISION_POST) collisions.push_back("(post)");
+	if (collisions.empty()) collisions.push_back("none");
+	return collisions;
 }
 
 int Self::getFoulChargedAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? foul_charged_buffer[time] : 0;
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? record->foul_charged : 0;
 }
 
 std::string Self::getFoulCardAtTime(unsigned int time) {
-	return (time < Configs::BUFFER_MAX_HISTORY) ? foul_card_buffer[time] : "";
+	const SenseBody* record = getSenseBodyAtTime(time);
+	return record ? std::string(record->foul_card) : std::string("");
 }
 
 }
@@ -88,9 +88,8 @@ bool testHypothesisFor(Player* past, Player* current) {
 	Position* pp = past->getPosition();
 	Position* cp = current->getPosition();
 	double stdv = current->getDistanceError() + past->getDistanceError();
-	double x = cp->getDistanceTo(pp) / stdv;
-	// Using a 90% confidence interval
-	if (x < 1.64) {
+	// Using a 90% confidence interval, d / stdv < 1.64 compared squared
+	if (cp->getSquaredDistanceTo(pp) < 1.64 * 1.64 * stdv * stdv) {
 		return true;
 	} else {
 		return false;
@@ -116,13 +115,13 @@ void World::identifyPlayers(std::vector<Player> &new_players) {
 		}
 	}
 	for (std::vector<Player>::iterator it = new_players.begin(); it != new_players.end(); ++it) {
-		double min_d = 1000.0;
+		double min_d = 1.0e6;
 		Player* _nearest = 0;
 		if ((*it).getTeam().compare("opp") == 0 && (*it).getUniformNumber() == 0) {
 			for (std::vector<Player>::iterator it_fs = fs_players.begin(); it_fs != fs_players.end(); ++it_fs) {
 				// If the full state player team is equal to the player team and the full state team is not already added to vector opps, then
 				if ((*it_fs).getTeam().compare("opp") == 0 && std::find(opps.begin(), opps.end(), (*it_fs).getUniformNumber()) == opps.end()) {
-					double d = it->getPosition()->getDistanceTo(it_fs->getPosition());
+					double d = it->getPosition()->getSquaredDistanceTo(it_fs->getPosition());
 					if (d < min_d) {
 						min_d = d;
 						_nearest = &(*it_fs);
@@ -138,7 +137,7 @@ void World::identifyPlayers(std::vector<Player> &new_players) {
 			for (std::vector<Player>::iterator it_fs = fs_players.begin(); it_fs != fs_players.end(); ++it_fs) {
 				// If the full state player team is equal to the player team and the full state team is not already added to vector ours, then
 				if ((*it_fs).getTeam().compare("our") == 0 && std::find(ours.begin(), ours.end(), (*it_fs).getUniformNumber()) == ours.end()) {
-					double d = it->getPosition()->getDistanceTo(it_fs->getPosition());
+					double d = it->getPosition()->getSquaredDistanceTo(it_fs->getPosition());
 					if (d < min_d) {
 						min_d = d;
 						_nearest = &(*it_fs);
@@ -153,12 +152,12 @@ void World::identifyPlayers(std::vector<Player> &new_players) {
 	}
 	for (std::vector<Player>::iterator it = new_players.begin(); it != new_players.end(); ++it) {
 		if ((*it).getTeam().compare("undefined") == 0 && (*it).getUniformNumber() == 0) {
-			double min_d = 1000.0;
+			double min_d = 1.0e6;
 			Player* _nearest = 0;
 			for (std::vector<Player>::iterator it_fs = fs_players.begin(); it_fs != fs_players.end(); ++it_fs) {
 				int unum = (*it_fs).getUniformNumber();
 				if (std::find(ours.begin(), ours.end(), unum) == ours.end() && std::find(opps.begin(), opps.end(), unum) == opps.end()) {
-					double d = it->getPosition()->getDistanceTo(it_fs->getPosition());
+					double d = it->getPosition()->getSquaredDistanceTo(it_fs->getPosition());
 					if (d < min_d) {
 						min_d = d;
 						_nearest = &(*it_fs);
@@ -201,12 +200,14 @@ void World::matchPlayers(std::vector<Player> &past_players, std::vector<Player>
 	std::multiset<_cell*, bool(*)(_cell*, _cell*)> hso(fn_pt);
 	int column = 0;
 	int row = 0;
+	std::vector<double> angles(new_players.size());
+	std::vector<double> likelihoods(new_players.size());
+	Math::Gaussian g(0.0, 90.0);
 	for (std::vector<Player>::iterator p = past_players.begin(); p != past_players.end(); ++p) {
 		column = 0;
 		double dt = 0.0; // total euclidean distance
 		int nt = 0; // total of players with same teams
 		int mt = 0; // total of players with undefined teams
-		Math::Gaussian g(0.0, 90.0);
 		bool exact = false; // true if one of the new players is the same player (same team and same uniform number)
 		for (std::vector<Player>::iterator n = new_players.begin(); n != new_players.end(); ++n) {
 			hv[row][column].row = row;
@@ -237,21 +238,28 @@ void World::matchPlayers(std::vector<Player> &past_players, std::vector<Player>
 			}
 			Position p_n = n->position;
 			Position p_p = p->position;
-			double d = sqrt(pow(p_n.getX() - p_p.getX(), 2.0) + pow(p_n.getY() - p_p.getY(), 2.0));
+			double d = Geometry::distance(p_n.getX(), p_n.getY(), p_p.getX(), p_p.getY());
 			if (d < 0.1) d = 0.1;
 			dt += 1.0 / d;
 			hv[row][column].d = 1.0 / d;
 			if (p->has_body) {
 				double a = 0.0;
 				if (p_n.getX() != p_p.getX() || p_n.getY() != p_p.getY()) {
-					a = fabs(p_p.getDirection() - Geometry::toDegrees(atan2(p_n.getY() - p_p.getY(), p_n.getX() - p_p.getX())));
+					a = fabs(Geometry::angleDifference(p_p.getDirection(), Geometry::bearing(p_n.getX() - p_p.getX(), p_n.getY() - p_p.getY())));
 				}
-				hv[row][column].v = g.evaluate(a);
+				angles[column] = a;
 			} else {
 				hv[row][column].v = 1.0 / new_players.size();
 			}
 			column++;
 		}
+		if (p->has_body && !angles.empty()) {
+			// The likelihoods of the row are evaluated at once
+			g.evaluate(&angles[0], &likelihoods[0], angles.size());
+			for (unsigned int i = 0; i < likelihoods.size(); ++i) {
+				hv[row][i].v = likelihoods[i];
+			}
+		}
 		if (!exact) {
 			// If there is no player with the same id
 			double pi = 1.0 / (2.0 * nt + mt);
@@ -292,8 +300,8 @@ void World::matchPlayers(std::vector<Player> &past_players, std::vector<Player>
 				Player* pp = &past_players[(*it)->row];
 				double dx = np->getPosition()->getX() - pp->getPosition()->getX();
 				double dy = np->getPosition()->getY() - pp->getPosition()->getY();
-				double d = sqrt(dx * dx + dy * dy);
-				if (d > (pp->getDistanceError() + np->getDistanceError()) * Configs::TRACKING_THRESHOLD) {
+				double gate = (pp->getDistanceError() + np->getDistanceError()) * Configs::TRACKING_THRESHOLD;
+				if (dx * dx + dy * dy > gate * gate) {
 					// If the distance between the two players is greater than theirs errors plus the threshold we do not accept the tracking
 					// std::cout << Game::GAME_TIME << ": reject match with value " << (*it)->h << std::endl;
 					continue;
@@ -307,7 +315,7 @@ void World::matchPlayers(std::vector<Player> &past_players, std::vector<Player>
 					np->velocity = new_vel;
 				}
 				if (!np->has_body) {
-					np->body = Geometry::toDegrees(atan2(dy, dx));
+					np->body = Geometry::bearing(dx, dy);
 				}
 				// We update id information
 				if (pp->team.compare("undefined") != 0) {
@@ -409,8 +417,8 @@ void World::matchPlayersPF(std::vector<Player> &new_players) {
 					Player* pp = &players[(*it)->row];
 					double dx = np->getPosition()->getX() - pp->getPosition()->getX();
 					double dy = np->getPosition()->getY() - pp->getPosition()->getY();
-					double d = sqrt(dx * dx + dy * dy);
-					if (d > (pp->getDistanceError() + np->getDistanceError()) * Configs::TRACKING_THRESHOLD) {
+					double gate = (pp->getDistanceError() + np->getDistanceError()) * Configs::TRACKING_THRESHOLD;
+					if (dx * dx + dy * dy > gate * gate) {
 						// If the distance between the two players is greater than theirs errors times the threshold we do not accept the tracking
 						// std::cout << Game::GAME_TIME << ": reject match with value " << (*it)->h << std::endl;
 						continue;
@@ -424,7 +432,7 @@ void World::matchPlayersPF(std::vector<Player> &new_players) {
 						np->velocity = new_vel;
 					}
 					if (!np->has_body) {
-						np->body = Geometry::toDegrees(atan2(dy, dx));
+						np->body = Geometry::bearing(dx, dy);
 					}
 					// We update id information
 					if (pp->team.compare("undefined") != 0) {
@@ -24,25 +24,157 @@
 
 #include "WorldModel.hpp"
 #include <list>
+#include <map>
 #include <iostream>
 #include "Controller.hpp"
+#include "Interception.hpp"
+#include "PlayerType.hpp"
+#include "Self.hpp"
 
 namespace Phoenix {
 
+const int WorldModel::NO_PLAYER;
+const int WorldModel::SELF_PLAYER;
+
+/* Features cache, shared by the copies of a snapshot */
+static unsigned long snapshots = 0;
+static unsigned long cached_snapshot = 0;
+static std::vector<feature> features;
+static std::vector<double> values;
+static std::vector<char> computed;
+static std::map<std::string, int> feature_ids;
+
 Position positionToCompare;
 
 bool compareDistances(Player* player0, Player* player1) {
-	double distance0 = player0->getPosition()->getDistanceTo(&positionToCompare);
-	double distance1 = player1->getPosition()->getDistanceTo(&positionToCompare);
+	double distance0 = player0->getPosition()->getSquaredDistanceTo(&positionToCompare);
+	double distance1 = player1->getPosition()->getSquaredDistanceTo(&positionToCompare);
 	return (distance0 < distance1);
 }
 
+/*
+ * Index of the player of a team nearest to the ball
+ */
+static double nearestToBall(WorldModel &world_model, std::string team) {
+	std::vector<Player*> players = world_model.getPlayers();
+	Position* ball = world_model.getBall()->getPosition();
+	int nearest = WorldModel::NO_PLAYER;
+	double min_distance = 1.0e12;
+	for (unsigned int i = 0; i < players.size(); ++i) {
+		if (players[i]->getTeam().compare(team) != 0) continue;
+		double distance = players[i]->getPosition()->getSquaredDistanceTo(ball);
+		if (distance < min_distance) {
+			min_distance = distance;
+			nearest = i;
+		}
+	}
+	return nearest;
+}
+
+static double ourNearestToBall(WorldModel &world_model) {
+	return nearestToBall(world_model, "our");
+}
+
+static double oppNearestToBall(WorldModel &world_model) {
+	return nearestToBall(world_model, "opp");
+}
+
+static double offsideLine(WorldModel &world_model) {
+	std::vector<Player*> players = world_model.getPlayers();
+	double first = 0.0;
+	double second = 0.0;
+	for (std::vector<Player*>::iterator it = players.begin(); it != players.end(); ++it) {
+		if ((*it)->getTeam().compare("opp") != 0) continue;
+		double x = (*it)->getPosition()->getX();
+		if (x > first) {
+			second = first;
+			first = x;
+		} else if (x > second) {
+			second = x;
+		}
+	}
+	double ball_x = world_model.getBall()->getPosition()->getX();
+	return ball_x > second ? ball_x : second;
+}
+
+static double defensiveLine(WorldModel &world_model) {
+	double line = Self::getPosition()->getX();
+	std::vector<Player*> players = world_model.getPlayers();
+	for (std::vector<Player*>::iterator it = players.begin(); it != players.end(); ++it) {
+		if ((*it)->getTeam().compare("our") != 0 || (*it)->isGoalie()) continue;
+		double x = (*it)->getPosition()->getX();
+		if (x < line) line = x;
+	}
+	return line;
+}
+
+/*
+ * The interceptors follow the agent and then the players in the order of getPlayers()
+ */
+static double fastestInterceptor(WorldModel &world_model) {
+	Interception::update(world_model);
+	const Interceptor* fastest = Interception::getFastest();
+	if (!fastest) return WorldModel::NO_PLAYER;
+	if (fastest->self) return WorldModel::SELF_PLAYER;
+	for (int i = 1; i < Interception::getCount(); ++i) {
+		if (Interception::getInterceptor(i) == fastest) return i - 1;
+	}
+	return WorldModel::NO_PLAYER;
+}
+
+static double fastestCycles(WorldModel &world_model) {
+	Interception::update(world_model);
+	const Interceptor* fastest = Interception::getFastest();
+	return fastest ? fastest->cycles : -1.0;
+}
+
+static double ballOwner(WorldModel &world_model) {
+	Position* ball = world_model.getBall()->getPosition();
+	int owner = WorldModel::NO_PLAYER;
+	double min_distance = Self::getPosition()->getSquaredDistanceTo(ball);
+	double kickable = Self::getPlayerType()->getKickableRadius();
+	if (min_distance <= kickable * kickable) {
+		owner = WorldModel::SELF_PLAYER;
+	}
+	std::vector<Player*> players = world_model.getPlayers();
+	for (unsigned int i = 0; i < players.size(); ++i) {
+		Player* player = players[i];
+		double distance = player->getPosition()->getSquaredDistanceTo(ball);
+		if (owner != WorldModel::NO_PLAYER && distance >= min_distance) continue;
+		const PlayerType* type = PlayerType::getPlayerType(0);
+		int unum = player->getUniformNumber();
+		if (unum > 0 && player->getTeam().compare("undefined") != 0) {
+			type = PlayerType::getPlayerTypeFor(player->getTeam().compare("our") == 0, unum);
+		}
+		kickable = type->getKickableRadius();
+		if (distance > kickable * kickable) continue;
+		min_distance = distance;
+		owner = i;
+	}
+	return owner;
+}
+
+static void registerBuiltins() {
+	static bool registered = false;
+	if (registered) return;
+	registered = true;
+	WorldModel::registerFeature("our_nearest_to_ball", ourNearestToBall);
+	WorldModel::registerFeature("opp_nearest_to_ball", oppNearestToBall);
+	WorldModel::registerFeature("offside_line", offsideLine);
+	WorldModel::registerFeature("defensive_line", defensiveLine);
+	WorldModel::registerFeature("fastest_interceptor", fastestInterceptor);
+	WorldModel::registerFeature("fastest_cycles", fastestCycles);
+	WorldModel::registerFeature("ball_owner", ballOwner);
+}
+
 WorldModel::WorldModel(std::vector<Player> players, Ball ball) {
+	snapshot = ++snapshots;
 	this->players = players;
 	this->ball = ball;
 }
 
 WorldModel::WorldModel(std::vector<Player> players, Ball ball, std::vector<Player> fs_players, Ball fs_ball) {
+	snapshot = ++snapshots;
 	this->players = players;
 	this->ball = ball;
 	if (Controller::AGENT_TYPE == 'p' || Controller::AGENT_TYPE == 'g') {
@@ -74,6 +206,15 @@ std::vector<Player*> WorldModel::getPlayers() {
 	return all_players;
 }
 
+int WorldModel::getPlayersCount() {
+	return players.size();
+}
+
+Player* WorldModel::getPlayer(int index) {
+	if (index < 0 || (unsigned int)index >= players.size()) return 0;
+	return &players[index];
+}
+
 std::vector<Player*> WorldModel::getPlayersOrderedByDistanceTo(Position position) {
 	std::list<Player*> all_players;
 	positionToCompare = position;
@@ -178,4 +319,65 @@ Ball* WorldModel::getExactBall() {
 	return &fs_ball;
 }
 
+double WorldModel::getFeature(int id) {
+	registerBuiltins();
+	if (id < 0 || (unsigned int)id >= features.size()) {
+		std::cerr << "WorldModel::getFeature(int) -> feature " << id << " not registered" << std::endl;
+		return 0.0;
+	}
+	if (cached_snapshot != snapshot) {
+		cached_snapshot = snapshot;
+		computed.assign(features.size(), 0);
+	}
+	if (!computed[id]) {
+		values[id] = features[id](*this);
+		computed[id] = 1;
+	}
+	return values[id];
+}
+
+double WorldModel::getFeature(std::string name) {
+	return getFeature(getFeatureId(name));
+}
+
+Player* WorldModel::getFeaturePlayer(int id) {
+	int index = (int)getFeature(id);
+	if (index < 0 || (unsigned int)index >= players.size()) return 0;
+	return &players[index];
+}
+
+void WorldModel::invalidateFeatures() {
+	if (cached_snapshot == snapshot) {
+		computed.assign(features.size(), 0);
+	}
+	// The interceptor features read the interceptions of the snapshot
+	Interception::invalidate();
+}
+
+unsigned long WorldModel::getSnapshot() const {
+	return snapshot;
+}
+
+int WorldModel::registerFeature(std::string name, feature function) {
+	registerBuiltins();
+	std::map<std::string, int>::iterator it = feature_ids.find(name);
+	if (it != feature_ids.end()) {
+		features[it->second] = function;
+		computed[it->second] = 0;
+		return it->second;
+	}
+	int id = features.size();
+	features.push_back(function);
+	values.push_back(0.0);
+	computed.push_back(0);
+	feature_ids[name] = id;
+	return id;
+}
+
+int WorldModel::getFeatureId(std::string name) {
+	registerBuiltins();
+	std::map<std::string, int>::iterator it = feature_ids.find(name);
+	return it != feature_ids.end() ? it->second : -1;
+}
+
 }
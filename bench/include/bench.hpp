@@ -0,0 +1,82 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_HPP_
+#define BENCH_HPP_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Microbenchmark harness used by `make bench`.  Every benchmark is calibrated until
+ * it runs for at least the minimum time and it is reported as one JSON object per line:
+ *
+ * {"name": "parser.see", "iterations": 4096, "ns_per_op": 51234.2, "allocs_per_op": 412.0, "bytes_per_op": 18342.5}
+ *
+ * Allocations are counted by replacing the global operator new of the benchmark binary.
+ * A benchmark may also report its own metrics (e.g. accuracy), they are appended as extra keys.
+ */
+namespace Phoenix {
+class Self;
+}
+
+namespace Bench {
+
+typedef void (*Setup)();
+typedef void (*Function)(unsigned long iteration);
+
+struct Result {
+	std::string name;
+	unsigned long iterations;
+	double ns_per_op;
+	double allocs_per_op;
+	double bytes_per_op;
+	std::vector<std::pair<std::string, double> > metrics;
+};
+
+typedef void (*Report)(Result &result);
+
+void add(std::string name, Function function, Setup setup = 0, Report report = 0);
+void setMinimumTime(double seconds);
+Result run(std::string name, Function function);
+void report(const Result &result);
+int runAll(const std::vector<std::string> &filters);
+std::vector<std::string> loadMessages(std::string file);
+void setupAgent();
+Phoenix::Self* getAgent();
+void positionSelf(double x, double y);
+
+/*
+ * Prevents the compiler from optimizing away a benchmark result
+ */
+template <class T>
+inline void keep(const T &value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+void registerBaseBenchmarks();
+void registerUtilsBenchmarks();
+void registerSceneBenchmarks();
+void registerAIBenchmarks();
+
+}
+
+#endif /* BENCH_HPP_ */
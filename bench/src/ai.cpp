@@ -0,0 +1,87 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+#include "Ball.hpp"
+#include "Parser.hpp"
+#include "Player.hpp"
+#include "SceneGenerator.hpp"
+#include "WorldModel.hpp"
+#include "pass.hpp"
+
+namespace Bench {
+
+/*
+ * Benchmarks for the AI layer.  The world is the fullstate of a random scene, so the 22
+ * players are known, the agent is the player 7 of the left team
+ */
+
+static Phoenix::WorldModel* world_model = 0;
+static Phoenix::Ball ball;
+static std::vector<pass::Target> targets;
+static std::vector<double> speeds;
+static std::vector<pass::Candidate> candidates;
+static pass::Workspace workspace;
+
+static void setupWorld() {
+	if (world_model) return;
+	setupAgent();
+	Phoenix::SceneGenerator scene("Phoenix2D", "Opponent", 11);
+	scene.randomize(10);
+	scene.setObserver('l', 7);
+	std::vector<Phoenix::Player> players;
+	Phoenix::Parser::parseFullstate(scene.getFullstate(0), players, ball);
+	world_model = new Phoenix::WorldModel(players, ball);
+}
+
+/* Pass evaluation, the teammates and a grid of points with 8 speeds */
+
+static void setupPass() {
+	setupWorld();
+	targets.clear();
+	speeds.clear();
+	pass::addReceivers(*world_model, targets);
+	for (int i = 0; i < 16; ++i) {
+		targets.push_back(pass::Target(-40.0 + 6.0 * i, -20.0 + 10.0 * (i % 5)));
+	}
+	for (int s = 0; s < 8; ++s) {
+		speeds.push_back(1.0 + 0.25 * s);
+	}
+}
+
+static void evaluatePass(unsigned long) {
+	Geometry::Point from(ball.getPosition()->getX(), ball.getPosition()->getY());
+	pass::evaluate(*world_model, from, targets, speeds, candidates, workspace);
+	keep(candidates[0]);
+}
+
+static void reportPass(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("candidates"), (double)candidates.size()));
+	result.metrics.push_back(std::make_pair(std::string("best_probability"), candidates.empty() ? 0.0 : candidates[0].probability));
+}
+
+void registerAIBenchmarks() {
+	add("pass.evaluate", evaluatePass, setupPass, reportPass);
+}
+
+}
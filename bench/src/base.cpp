@@ -0,0 +1,448 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "Ball.hpp"
+#include "Command.hpp"
+#include "Anytime.hpp"
+#include "Commands.hpp"
+#include "Configs.hpp"
+#include "Connect.hpp"
+#include "Controller.hpp"
+#include "Flag.hpp"
+#include "Game.hpp"
+#include "Interception.hpp"
+#include "KickPlanner.hpp"
+#include "Message.hpp"
+#include "Parser.hpp"
+#include "Player.hpp"
+#include "Position.hpp"
+#include "PlayerType.hpp"
+#include "ReachTable.hpp"
+#include "Self.hpp"
+#include "World.hpp"
+#include "geometry.hpp"
+
+namespace Bench {
+
+/*
+ * Benchmarks for the sensor parsing, self localization and world tracking.  The agent
+ * is the player 7 of Phoenix2D on the left side, the messages in bench/data follow
+ * the rcssserver 15 protocol for that agent.
+ */
+
+static Phoenix::Self* self = 0;
+static Phoenix::World* world = 0;
+static std::vector<std::string> see_messages;
+static std::vector<std::string> sense_body_messages;
+static std::vector<std::string> fullstate_messages;
+static std::vector<std::string> hear_messages;
+static std::vector<std::vector<Phoenix::Flag> > see_flags;
+static std::vector<std::vector<Phoenix::Player> > see_players;
+static std::vector<Phoenix::Ball> see_balls;
+
+/* Buffers reused across iterations, as the parser does with its globals */
+static std::vector<Phoenix::Flag> flags;
+static std::vector<Phoenix::Player> players;
+static std::vector<Phoenix::Message> messages;
+static Phoenix::Ball ball;
+
+/*
+ * Confirms a move command so the agent is positioned, otherwise localize returns early
+ */
+void positionSelf(double x, double y) {
+	std::stringstream move_ss;
+	move_ss << "(move " << x << " " << y << ")";
+	Phoenix::Command move(move_ss.str(), 1, Phoenix::MOVE);
+	move.setArgs((void *)&x, (void *)&y);
+	Phoenix::Command* sent[] = {&move};
+	Phoenix::Self::setLastCommandsSet(sent, 1);
+	std::stringstream ss;
+	ss << "(move " << Phoenix::Self::getMoveCountAtTime(0) + 1 << ")";
+	std::string sense_body = sense_body_messages[0];
+	sense_body.replace(sense_body.find("(move 1)"), 8, ss.str());
+	self->processSenseBody(sense_body);
+}
+
+void setupAgent() {
+	if (self) return;
+	Phoenix::Controller::AGENT_TYPE = 'p';
+	std::vector<std::string> player_param = loadMessages("player_param.log");
+	std::vector<std::string> player_types = loadMessages("player_type.log");
+	self = new Phoenix::Self(player_param[0], "Phoenix2D", 7, "l");
+	for (std::vector<std::string>::iterator it = player_types.begin(); it != player_types.end(); ++it) {
+		self->addPlayerType(*it);
+	}
+	self->changePlayerType(0);
+	world = new Phoenix::World();
+	see_messages = loadMessages("see.log");
+	sense_body_messages = loadMessages("sense_body.log");
+	fullstate_messages = loadMessages("fullstate.log");
+	hear_messages = loadMessages("hear.log");
+	positionSelf(-12.0, 4.0);
+	for (std::vector<std::string>::iterator it = see_messages.begin(); it != see_messages.end(); ++it) {
+		std::vector<Phoenix::Flag> see_flag;
+		std::vector<Phoenix::Player> see_player;
+		Phoenix::Ball see_ball;
+		std::string raw_ball = Phoenix::Parser::parseSee(*it, 0, see_flag, see_player);
+		const Phoenix::Position* position = Phoenix::Self::getPosition();
+		const Geometry::Vector2D* velocity = Phoenix::Self::getVelocity();
+		if (raw_ball.length() > 0) {
+			see_ball.initForPlayer(raw_ball, position, velocity);
+		}
+		for (std::vector<Phoenix::Player>::iterator it_p = see_player.begin(); it_p != see_player.end(); ++it_p) {
+			it_p->initForPlayer(position, velocity);
+		}
+		see_flags.push_back(see_flag);
+		see_players.push_back(see_player);
+		see_balls.push_back(see_ball);
+	}
+}
+
+Phoenix::Self* getAgent() {
+	return self;
+}
+
+/* Parsing */
+
+static void parseSee(unsigned long i) {
+	flags.clear();
+	players.clear();
+	std::string raw_ball = Phoenix::Parser::parseSee(see_messages[i % see_messages.size()], 0, flags, players);
+	const Phoenix::Position* position = Phoenix::Self::getPosition();
+	const Geometry::Vector2D* velocity = Phoenix::Self::getVelocity();
+	if (raw_ball.length() > 0) {
+		ball.initForPlayer(raw_ball, position, velocity);
+	}
+	for (std::vector<Phoenix::Player>::iterator it = players.begin(); it != players.end(); ++it) {
+		it->initForPlayer(position, velocity);
+	}
+	keep(players);
+}
+
+static void parseFullstate(unsigned long i) {
+	players.clear();
+	Phoenix::Parser::parseFullstate(fullstate_messages[i % fullstate_messages.size()], players, ball);
+	keep(players);
+}
+
+static void parseHear(unsigned long i) {
+	messages.clear();
+	std::string play_mode;
+	Phoenix::Parser::parseHear(hear_messages[i % hear_messages.size()], messages, play_mode);
+	keep(messages);
+}
+
+/* Self */
+
+static void processSenseBody(unsigned long i) {
+	// Every cycle the agent confirms the commands sent in the previous cycle, a command not
+	// counted yet stays pending for another cycle so they outlive the iteration
+	static Phoenix::Command dash("(dash 80 0)", 1, Phoenix::DASH);
+	static Phoenix::Command turn_neck("(turn_neck 10)", 0, Phoenix::TURN_NECK);
+	double power = 80.0;
+	double direction = 0.0;
+	dash.setArgs((void *)&power, (void *)&direction);
+	turn_neck.setArgs((void *)&direction);
+	Phoenix::Command* sent[] = {&dash, &turn_neck};
+	Phoenix::Self::setLastCommandsSet(sent, 2);
+	self->processSenseBody(sense_body_messages[i % sense_body_messages.size()]);
+}
+
+static void setupTriangulation() {
+	setupAgent();
+	Phoenix::Configs::LOCALIZATION = "triangulation";
+	positionSelf(-12.0, 4.0);
+}
+
+static void setupLowPassFilter() {
+	setupAgent();
+	Phoenix::Configs::LOCALIZATION = "lowpassfilter";
+	positionSelf(-12.0, 4.0);
+}
+
+static void setupParticleFilter() {
+	setupAgent();
+	Phoenix::Configs::LOCALIZATION = "particlefilter";
+	positionSelf(-12.0, 4.0);
+}
+
+static void localize(unsigned long i) {
+	self->localize(see_flags[i % see_flags.size()]);
+	keep(*Phoenix::Self::getPosition());
+}
+
+/* Commands, sent to a sink socket of the bench on an ephemeral port */
+
+static Phoenix::Connect* connect = 0;
+static Phoenix::Commands* commands = 0;
+static int sink = -1;
+
+/*
+ * Binds the sink socket on an ephemeral port of the loopback, returns the port or 0 on error
+ */
+static int openSink() {
+	sink = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sink < 0) {
+		std::cerr << "Bench::openSink() -> can not open socket" << std::endl;
+		return 0;
+	}
+	struct sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(0);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t length = sizeof(address);
+	if (bind(sink, (struct sockaddr *)&address, sizeof(address)) < 0 || getsockname(sink, (struct sockaddr *)&address, &length) < 0) {
+		std::cerr << "Bench::openSink() -> can not bind socket" << std::endl;
+		return 0;
+	}
+	return ntohs(address.sin_port);
+}
+
+static void drainSink() {
+	char buffer[Phoenix::Commands::QUEUE_SIZE * Phoenix::Command::BUFFER_SIZE];
+	while (recv(sink, buffer, sizeof(buffer), MSG_DONTWAIT) > 0);
+}
+
+static void setupCommands() {
+	setupAgent();
+	if (commands) return;
+	int port = openSink();
+	if (port == 0) std::exit(1);
+	connect = new Phoenix::Connect("127.0.0.1", port);
+	commands = new Phoenix::Commands(connect);
+}
+
+static void sendCommands(unsigned long i) {
+	double offset = 0.001 * (i % 1000);
+	commands->dash(80.0 + offset, -45.0 + offset);
+	commands->turnNeck(30.0 - offset);
+	commands->say("pass");
+	commands->changeView("narrow");
+	commands->sendCommands();
+	commands->flush();
+	if (i % 64 == 0) drainSink();
+}
+
+/* World */
+
+static void setupQualifier() {
+	setupAgent();
+	Phoenix::Configs::PLAYER_HISTORY = true;
+	Phoenix::Configs::PLAYER_TRACKING = true;
+	Phoenix::Configs::TRACKING = "qualifier";
+}
+
+static void setupPFilters() {
+	setupAgent();
+	Phoenix::Configs::PLAYER_HISTORY = true;
+	Phoenix::Configs::PLAYER_TRACKING = true;
+	Phoenix::Configs::TRACKING = "pfilters";
+}
+
+static void updateWorld(unsigned long i) {
+	size_t k = i % see_players.size();
+	std::vector<Phoenix::Player> fs_players;
+	world->updateWorld(see_players[k], see_balls[k], fs_players, Phoenix::Ball());
+}
+
+/* Interception, computed for the world of the first see message */
+
+static Phoenix::WorldModel* interception_model = 0;
+
+static void setupInterception() {
+	setupAgent();
+	if (interception_model) return;
+	Phoenix::Configs::PLAYER_HISTORY = true;
+	Phoenix::Configs::PLAYER_TRACKING = true;
+	Phoenix::Configs::TRACKING = "qualifier";
+	std::vector<Phoenix::Player> fs_players;
+	world->updateWorld(see_players[0], see_balls[0], fs_players, Phoenix::Ball());
+	interception_model = new Phoenix::WorldModel(world->getWorldModel());
+}
+
+static void computeInterception(unsigned long) {
+	Phoenix::Interception::compute(*interception_model);
+	keep(*Phoenix::Interception::getSelf());
+}
+
+static void reportInterception(Result &result) {
+	const Phoenix::Interceptor* fastest = Phoenix::Interception::getFastest();
+	result.metrics.push_back(std::make_pair(std::string("interceptors"), (double)Phoenix::Interception::getCount()));
+	result.metrics.push_back(std::make_pair(std::string("fastest_cycles"), fastest ? (double)fastest->cycles : -1.0));
+}
+
+/* Reach tables of the default type, lookups against the rollouts they replace */
+
+static Phoenix::ReachTable* reach_table = 0;
+
+static void setupReachTable() {
+	setupAgent();
+	if (reach_table) return;
+	std::string cache = Phoenix::Configs::REACH_CACHE;
+	Phoenix::Configs::REACH_CACHE = "";
+	reach_table = new Phoenix::ReachTable(Phoenix::PlayerType::getPlayerType(0));
+	Phoenix::Configs::REACH_CACHE = cache;
+}
+
+static void buildReachTable(unsigned long i) {
+	std::string cache = Phoenix::Configs::REACH_CACHE;
+	Phoenix::Configs::REACH_CACHE = "";
+	Phoenix::ReachTable table(Phoenix::PlayerType::getPlayerType(i % Phoenix::Self::PLAYER_TYPES));
+	Phoenix::Configs::REACH_CACHE = cache;
+	keep(table.getErrorBound());
+}
+
+static void lookupReachTable(unsigned long i) {
+	double cycles = reach_table->getCycles(0.37 * (i % 100), 1.7 * (i % 100), 0.01 * (i % 100));
+	keep(cycles);
+}
+
+static void simulateReach(unsigned long i) {
+	int cycles = reach_table->simulateCycles(0.37 * (i % 100), 1.7 * (i % 100), 0.01 * (i % 100));
+	keep(cycles);
+}
+
+static void reportReachTable(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("error_bound"), reach_table->getErrorBound()));
+}
+
+/* World model features, computed for a new snapshot and then read from the cache */
+
+static void setupFeatures() {
+	setupInterception();
+}
+
+static void computeFeatures(unsigned long) {
+	interception_model->invalidateFeatures();
+	double sum = 0.0;
+	for (int id = 0; id < Phoenix::BUILTIN_FEATURES; ++id) {
+		sum += interception_model->getFeature(id);
+	}
+	keep(sum);
+}
+
+static void cachedFeatures(unsigned long) {
+	double sum = 0.0;
+	for (int id = 0; id < Phoenix::BUILTIN_FEATURES; ++id) {
+		sum += interception_model->getFeature(id);
+	}
+	keep(sum);
+}
+
+static void reportFeatures(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("offside_line"), interception_model->getFeature(Phoenix::OFFSIDE_LINE)));
+	result.metrics.push_back(std::make_pair(std::string("defensive_line"), interception_model->getFeature(Phoenix::DEFENSIVE_LINE)));
+	result.metrics.push_back(std::make_pair(std::string("ball_owner"), interception_model->getFeature(Phoenix::BALL_OWNER)));
+}
+
+/* Kick plans for a fast pass with the ball around the body, one opponent close to the agent */
+
+static const int KICK_SCENES = 16;
+static Phoenix::KickPlan kick_plans[KICK_SCENES];
+static Geometry::Point kick_opponent(0.0, -1.5);
+
+static Physics::State kickScene(unsigned long i) {
+	Physics::State state;
+	double angle = (i % KICK_SCENES) * 360.0 / KICK_SCENES * Math::PI / 180.0;
+	state.x = 0.0;
+	state.y = 0.0;
+	state.vx = 0.1;
+	state.vy = 0.0;
+	state.body = 0.0;
+	state.stamina = 8000.0;
+	state.ball_x = 0.7 * cos(angle);
+	state.ball_y = 0.7 * sin(angle);
+	state.ball_vx = 0.0;
+	state.ball_vy = 0.0;
+	return state;
+}
+
+static void setupKickPlanner() {
+	setupAgent();
+	Phoenix::KickPlanner::buildTables(Phoenix::PlayerType::getPlayerType(0));
+}
+
+static void planKick(unsigned long i) {
+	Physics::State state = kickScene(i);
+	Phoenix::KickPlan plan = Phoenix::KickPlanner::plan(state, 2.7, 0.0, &kick_opponent, 0, 1);
+	kick_plans[i % KICK_SCENES] = plan;
+	keep(plan.noise);
+}
+
+static void reportKickPlanner(Result &result) {
+	double reached = 0.0;
+	double kicks = 0.0;
+	for (unsigned long i = 0; i < KICK_SCENES; ++i) {
+		planKick(i);
+		if (kick_plans[i].reached) reached++;
+		kicks += kick_plans[i].kicks;
+	}
+	result.metrics.push_back(std::make_pair(std::string("reached"), reached / KICK_SCENES));
+	result.metrics.push_back(std::make_pair(std::string("mean_kicks"), kicks / KICK_SCENES));
+}
+
+/* Cost of reading the cycle deadline, it bounds how often an anytime search checks the clock */
+
+static void remainingTime(unsigned long) {
+	keep(Phoenix::Game::getRemainingTime());
+}
+
+static void anytimeSearch(unsigned long i) {
+	Phoenix::Anytime<unsigned long> search(1000.0, 8);
+	for (unsigned long n = 0; n < 64 && search.running(); ++n) {
+		search.offer(n, (double)((n * 2654435761UL + i) % 1000));
+	}
+	keep(search.getBest());
+}
+
+void registerBaseBenchmarks() {
+	add("parser.see", parseSee, setupAgent);
+	add("parser.fullstate", parseFullstate, setupAgent);
+	add("parser.hear", parseHear, setupAgent);
+	add("self.process_sense_body", processSenseBody, setupAgent);
+	add("self.localize.triangulation", localize, setupTriangulation);
+	add("self.localize.lowpassfilter", localize, setupLowPassFilter);
+	add("self.localize.particlefilter", localize, setupParticleFilter);
+	add("commands.send", sendCommands, setupCommands);
+	add("world.match_players", updateWorld, setupQualifier);
+	add("world.match_players_pf", updateWorld, setupPFilters);
+	add("interception.compute", computeInterception, setupInterception, reportInterception);
+	add("reach.build", buildReachTable, setupReachTable);
+	add("reach.lookup", lookupReachTable, setupReachTable, reportReachTable);
+	add("reach.simulate", simulateReach, setupReachTable);
+	add("world.features.compute", computeFeatures, setupFeatures, reportFeatures);
+	add("world.features.cached", cachedFeatures, setupFeatures);
+	add("kick.plan", planKick, setupKickPlanner, reportKickPlanner);
+	add("game.remaining_time", remainingTime, setupAgent);
+	add("anytime.search", anytimeSearch, setupAgent);
+}
+
+}
@@ -0,0 +1,179 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.hpp"
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <new>
+#include <fstream>
+#include <iostream>
+
+/*------------------------
+ | Allocation counters   |
+ ------------------------*/
+
+static unsigned long allocations = 0;
+static unsigned long allocated_bytes = 0;
+
+void* operator new(std::size_t size) {
+	__sync_fetch_and_add(&allocations, 1);
+	__sync_fetch_and_add(&allocated_bytes, size);
+	void* ptr = std::malloc(size > 0 ? size : 1);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) throw() {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) throw() {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) throw() {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) throw() {
+	std::free(ptr);
+}
+
+namespace Bench {
+
+struct _case {
+	std::string name;
+	Function function;
+	Setup setup;
+	Report report;
+};
+
+static std::vector<_case> cases;
+static double minimum_time = 0.25;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void add(std::string name, Function function, Setup setup, Report report) {
+	_case c;
+	c.name = name;
+	c.function = function;
+	c.setup = setup;
+	c.report = report;
+	cases.push_back(c);
+}
+
+void setMinimumTime(double seconds) {
+	minimum_time = seconds;
+}
+
+Result run(std::string name, Function function) {
+	// Warm up caches and lazily initialized statics before measuring
+	for (unsigned long i = 0; i < 4; ++i) {
+		function(i);
+	}
+	unsigned long iterations = 1;
+	double elapsed = 0.0;
+	unsigned long allocs = 0;
+	unsigned long bytes = 0;
+	while (true) {
+		unsigned long allocs_start = allocations;
+		unsigned long bytes_start = allocated_bytes;
+		double start = now();
+		for (unsigned long i = 0; i < iterations; ++i) {
+			function(i);
+		}
+		elapsed = now() - start;
+		allocs = allocations - allocs_start;
+		bytes = allocated_bytes - bytes_start;
+		if (elapsed >= minimum_time || iterations >= (1UL << 30)) {
+			break;
+		}
+		// Aim a little above the minimum time to avoid an extra round
+		double factor = (elapsed > 0.0) ? 1.2 * minimum_time / elapsed : 100.0;
+		if (factor > 100.0) factor = 100.0;
+		if (factor < 2.0) factor = 2.0;
+		iterations = (unsigned long)(iterations * factor);
+	}
+	Result result;
+	result.name = name;
+	result.iterations = iterations;
+	result.ns_per_op = 1e9 * elapsed / iterations;
+	result.allocs_per_op = (double)allocs / iterations;
+	result.bytes_per_op = (double)bytes / iterations;
+	return result;
+}
+
+void report(const Result &result) {
+	std::printf("{\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f",
+			result.name.c_str(), result.iterations, result.ns_per_op, result.allocs_per_op, result.bytes_per_op);
+	for (std::vector<std::pair<std::string, double> >::const_iterator it = result.metrics.begin(); it != result.metrics.end(); ++it) {
+		std::printf(", \"%s\": %.4f", it->first.c_str(), it->second);
+	}
+	std::printf("}\n");
+	std::fflush(stdout);
+}
+
+int runAll(const std::vector<std::string> &filters) {
+	int executed = 0;
+	for (std::vector<_case>::iterator it = cases.begin(); it != cases.end(); ++it) {
+		bool selected = filters.empty();
+		for (std::vector<std::string>::const_iterator it_f = filters.begin(); it_f != filters.end(); ++it_f) {
+			if (it->name.find(*it_f) != std::string::npos) {
+				selected = true;
+				break;
+			}
+		}
+		if (!selected) continue;
+		if (it->setup) it->setup();
+		Result result = run(it->name, it->function);
+		if (it->report) it->report(result);
+		report(result);
+		executed++;
+	}
+	return executed;
+}
+
+std::vector<std::string> loadMessages(std::string file) {
+	std::vector<std::string> messages;
+	std::string path = std::string(BENCH_DATA_DIR) + "/" + file;
+	std::ifstream stream(path.c_str());
+	if (!stream.is_open()) {
+		std::cerr << "Bench::loadMessages(string) -> cannot open " << path << std::endl;
+		std::exit(1);
+	}
+	std::string line;
+	while (std::getline(stream, line)) {
+		if (line.length() > 0) {
+			messages.push_back(line);
+		}
+	}
+	return messages;
+}
+
+}
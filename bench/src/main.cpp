@@ -0,0 +1,50 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "bench.hpp"
+
+/*
+ * usage: ./bench [--time <seconds>] [filter ...]
+ * Only the benchmarks whose name contains one of the filters are executed
+ */
+int main(int argc, char **argv) {
+	std::vector<std::string> filters;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.compare("--time") == 0 && i + 1 < argc) {
+			Bench::setMinimumTime(atof(argv[++i]));
+		} else {
+			filters.push_back(arg);
+		}
+	}
+	Bench::registerBaseBenchmarks();
+	Bench::registerUtilsBenchmarks();
+	Bench::registerSceneBenchmarks();
+	Bench::registerAIBenchmarks();
+	if (Bench::runAll(filters) == 0) {
+		std::cerr << "No benchmark matches the given filters" << std::endl;
+		return 1;
+	}
+	return 0;
+}
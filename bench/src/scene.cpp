@@ -0,0 +1,220 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+#include "Ball.hpp"
+#include "Configs.hpp"
+#include "Flag.hpp"
+#include "Parser.hpp"
+#include "Player.hpp"
+#include "Position.hpp"
+#include "SceneGenerator.hpp"
+#include "Self.hpp"
+#include "Server.hpp"
+#include "World.hpp"
+#include "WorldModel.hpp"
+
+namespace Bench {
+
+/*
+ * Accuracy and cost of the localization and tracking methods over a random scene of
+ * SCENE_CYCLES cycles.  The agent (player 7 of Phoenix2D, left side) is the observer,
+ * the ground truth comes from the same scene so the errors are exact.
+ */
+
+static const int SCENE_CYCLES = 100;
+static Phoenix::SceneGenerator* scene = 0;
+static std::vector<std::string> scene_sense_body;
+static std::vector<std::vector<Phoenix::Flag> > scene_flags;
+static std::vector<std::vector<Phoenix::Player> > scene_players;
+static std::vector<Phoenix::Ball> scene_balls;
+static std::vector<std::vector<Phoenix::Player> > scene_fs_players;
+static std::vector<Phoenix::Ball> scene_fs_balls;
+
+/* Accumulated between the setup and the report of each benchmark */
+static double error_sum = 0.0;
+static double error_max = 0.0;
+static unsigned long error_count = 0;
+static Phoenix::World* world = 0;
+static unsigned long tracked_cycles = 0;
+static int start_real = 0;
+static int start_method = 0;
+static int start_correct = 0;
+
+/*
+ * Generates the scene and the messages received by the agent.  The observed players and
+ * ball are placed with the position given by the triangulation, as the agent does
+ */
+static void setupScene() {
+	if (scene) return;
+	setupAgent();
+	scene = new Phoenix::SceneGenerator("Phoenix2D", "Opponent", 7);
+	scene->randomize(SCENE_CYCLES);
+	scene->setObserver('l', 7);
+	Phoenix::Self* self = getAgent();
+	Phoenix::Configs::LOCALIZATION = "triangulation";
+	Phoenix::SceneState start = scene->getObserverState(0);
+	positionSelf(start.x, start.y);
+	for (int t = 0; t < SCENE_CYCLES; ++t) {
+		std::vector<Phoenix::Flag> flags;
+		std::vector<Phoenix::Player> players;
+		std::vector<Phoenix::Player> fs_players;
+		Phoenix::Ball ball;
+		Phoenix::Ball fs_ball;
+		std::string sense_body = scene->getSenseBody(t);
+		std::string raw_ball = Phoenix::Parser::parseSee(scene->getSee(t), t, flags, players);
+		self->processSenseBody(sense_body);
+		self->localize(flags);
+		const Phoenix::Position* position = Phoenix::Self::getPosition();
+		const Geometry::Vector2D* velocity = Phoenix::Self::getVelocity();
+		if (raw_ball.length() > 0) {
+			ball.initForPlayer(raw_ball, position, velocity);
+		}
+		for (std::vector<Phoenix::Player>::iterator it = players.begin(); it != players.end(); ++it) {
+			it->initForPlayer(position, velocity);
+		}
+		Phoenix::Parser::parseFullstate(scene->getFullstate(t), fs_players, fs_ball);
+		scene_sense_body.push_back(sense_body);
+		scene_flags.push_back(flags);
+		scene_players.push_back(players);
+		scene_balls.push_back(ball);
+		scene_fs_players.push_back(fs_players);
+		scene_fs_balls.push_back(fs_ball);
+	}
+}
+
+/* Generation */
+
+static void generate(unsigned long i) {
+	int t = (int)(i % SCENE_CYCLES);
+	std::string see = scene->getSee(t);
+	std::string sense_body = scene->getSenseBody(t);
+	std::string fullstate = scene->getFullstate(t);
+	keep(see);
+	keep(sense_body);
+	keep(fullstate);
+}
+
+/* Localization */
+
+static void setupLocalization(std::string method) {
+	setupScene();
+	Phoenix::Configs::LOCALIZATION = method;
+	Phoenix::SceneState start = scene->getObserverState(0);
+	positionSelf(start.x, start.y);
+	error_sum = 0.0;
+	error_max = 0.0;
+	error_count = 0;
+}
+
+static void setupTriangulation() {
+	setupLocalization("triangulation");
+}
+
+static void setupLowPassFilter() {
+	setupLocalization("lowpassfilter");
+}
+
+static void setupParticleFilter() {
+	setupLocalization("particlefilter");
+}
+
+static void localize(unsigned long i) {
+	int t = (int)(i % SCENE_CYCLES);
+	// The scene starts over, the agent is moved back to the start (every round of the
+	// measurement starts again from i = 0)
+	if (t == 0) {
+		Phoenix::SceneState start = scene->getObserverState(0);
+		positionSelf(start.x, start.y);
+	}
+	Phoenix::Self* self = getAgent();
+	self->processSenseBody(scene_sense_body[t]);
+	self->localize(scene_flags[t]);
+	Phoenix::SceneState truth = scene->getObserverState(t);
+	const Phoenix::Position* position = Phoenix::Self::getPosition();
+	double error = sqrt(pow(position->getX() - truth.x, 2.0) + pow(position->getY() - truth.y, 2.0));
+	error_sum += error;
+	if (error > error_max) error_max = error;
+	error_count++;
+}
+
+static void reportLocalization(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("mean_error"), error_count > 0 ? error_sum / error_count : 0.0));
+	result.metrics.push_back(std::make_pair(std::string("max_error"), error_max));
+}
+
+/* Tracking */
+
+static void setupTracking(std::string method) {
+	setupScene();
+	if (!world) world = new Phoenix::World();
+	Phoenix::Configs::PLAYER_HISTORY = true;
+	Phoenix::Configs::PLAYER_TRACKING = true;
+	Phoenix::Configs::TRACKING = method;
+	// The fullstate is needed by the world to count the correct matches
+	Phoenix::Server::FULLSTATE_L = 1;
+	Phoenix::Server::FULLSTATE_R = 1;
+	Phoenix::WorldModel model = world->getWorldModel();
+	start_real = model.real_matches;
+	start_method = model.method_matches;
+	start_correct = model.correct_matches;
+	tracked_cycles = 0;
+}
+
+static void setupQualifier() {
+	setupTracking("qualifier");
+}
+
+static void setupPFilters() {
+	setupTracking("pfilters");
+}
+
+static void track(unsigned long i) {
+	int t = (int)(i % SCENE_CYCLES);
+	world->updateWorld(scene_players[t], scene_balls[t], scene_fs_players[t], scene_fs_balls[t]);
+	tracked_cycles++;
+}
+
+static void reportTracking(Result &result) {
+	Phoenix::WorldModel model = world->getWorldModel();
+	double real = model.real_matches - start_real;
+	double method = model.method_matches - start_method;
+	double correct = model.correct_matches - start_correct;
+	result.metrics.push_back(std::make_pair(std::string("real_matches_per_cycle"), tracked_cycles > 0 ? real / tracked_cycles : 0.0));
+	result.metrics.push_back(std::make_pair(std::string("method_matches_per_cycle"), tracked_cycles > 0 ? method / tracked_cycles : 0.0));
+	result.metrics.push_back(std::make_pair(std::string("correct_ratio"), method > 0.0 ? correct / method : 0.0));
+	Phoenix::Server::FULLSTATE_L = 0;
+	Phoenix::Server::FULLSTATE_R = 0;
+}
+
+void registerSceneBenchmarks() {
+	add("scene.generate", generate, setupScene);
+	add("scene.localize.triangulation", localize, setupTriangulation, reportLocalization);
+	add("scene.localize.lowpassfilter", localize, setupLowPassFilter, reportLocalization);
+	add("scene.localize.particlefilter", localize, setupParticleFilter, reportLocalization);
+	add("scene.tracking.qualifier", track, setupQualifier, reportTracking);
+	add("scene.tracking.pfilters", track, setupPFilters, reportTracking);
+}
+
+}
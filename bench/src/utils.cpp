@@ -0,0 +1,629 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013, 2014 Nelson Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/random.hpp>
+#include "bench.hpp"
+#include "fuzzy.hpp"
+#include "functions.hpp"
+#include "geometry.hpp"
+#include "CMAES.hpp"
+#include "FitnessCache.hpp"
+#include "GAlgorithm.hpp"
+#include "Islands.hpp"
+#include "PFields.hpp"
+#include "PFilter.hpp"
+#include "Physics.hpp"
+#include "TaskPool.hpp"
+
+namespace Bench {
+
+/*
+ * Benchmarks for the generic utilities: particle filters, math functions, fuzzy engine, potential
+ * fields, genetic algorithm and physics simulator
+ */
+
+/* Particle filter, same model used by the self localization */
+
+static Filters::PFilter<4> pfilter;
+static const double landmarks[][2] = {{52.5, -34.0}, {52.5, 34.0}, {36.0, -20.0}, {36.0, 0.0}, {36.0, 20.0}, {0.0, 0.0}};
+static const double distances[] = {70.1, 46.5, 53.8, 48.2, 50.9, 12.6};
+
+static void predictParticle(Filters::Particle<4> &particle) {
+	particle.dimension[0] += 0.3 * particle.dimension[2];
+	particle.dimension[1] += 0.3 * particle.dimension[3];
+}
+
+static void updateParticle(Filters::Particle<4> &particle) {
+	particle.weight = 1.0;
+	for (int i = 0; i < 6; ++i) {
+		double x = sqrt(pow(particle.dimension[0] - landmarks[i][0], 2.0) + pow(particle.dimension[1] - landmarks[i][1], 2.0));
+		Math::Uniform u(distances[i] - 5.0, distances[i] + 5.0);
+		particle.weight *= u.evaluate(x);
+	}
+}
+
+static void setupPFilter() {
+	double mus[] = {-12.0, 4.0, 1.0, 0.0};
+	double devs[] = {5.0, 5.0, 0.2, 0.2};
+	pfilter.initWithBelief(mus, devs);
+}
+
+static void pfilterPredict(unsigned long) {
+	pfilter.predict(predictParticle);
+}
+
+static void pfilterUpdate(unsigned long) {
+	pfilter.update(updateParticle);
+}
+
+static void pfilterResample(unsigned long) {
+	pfilter.resample();
+}
+
+/* Membership and kernel functions over FUNCTION_POINTS points, through the base pointer */
+
+static const int FUNCTION_POINTS = 256;
+static double function_xs[FUNCTION_POINTS];
+static double function_ys[FUNCTION_POINTS];
+static Math::Function* gaussian = 0;
+static Math::Function* fast_gaussian = 0;
+static Math::Function* triangular = 0;
+
+static void setupFunctions() {
+	if (gaussian) return;
+	gaussian = new Math::Gaussian(0.0, 90.0);
+	fast_gaussian = new Math::Gaussian(0.0, 90.0, true);
+	triangular = new Math::Triangular(-60.0, 0.0, 60.0);
+	for (int n = 0; n < FUNCTION_POINTS; ++n) {
+		function_xs[n] = -180.0 + 360.0 * n / FUNCTION_POINTS;
+	}
+}
+
+static void gaussianScalar(unsigned long i) {
+	for (int n = 0; n < FUNCTION_POINTS; ++n) {
+		function_ys[n] = gaussian->evaluate(function_xs[n]);
+	}
+	keep(function_ys[i % FUNCTION_POINTS]);
+}
+
+static void gaussianBatch(unsigned long i) {
+	gaussian->evaluate(function_xs, function_ys, FUNCTION_POINTS);
+	keep(function_ys[i % FUNCTION_POINTS]);
+}
+
+static void gaussianFast(unsigned long i) {
+	fast_gaussian->evaluate(function_xs, function_ys, FUNCTION_POINTS);
+	keep(function_ys[i % FUNCTION_POINTS]);
+}
+
+/* Largest relative difference between fastExp and exp */
+static void reportGaussianFast(Result &result) {
+	double error = 0.0;
+	for (int n = 0; n < FUNCTION_POINTS; ++n) {
+		double exact = gaussian->evaluate(function_xs[n]);
+		double difference = fabs(function_ys[n] - exact) / exact;
+		if (difference > error) error = difference;
+	}
+	result.metrics.push_back(std::make_pair(std::string("max_rel_error"), error));
+}
+
+static void triangularScalar(unsigned long i) {
+	for (int n = 0; n < FUNCTION_POINTS; ++n) {
+		function_ys[n] = triangular->evaluate(function_xs[n]);
+	}
+	keep(function_ys[i % FUNCTION_POINTS]);
+}
+
+static void triangularBatch(unsigned long i) {
+	triangular->evaluate(function_xs, function_ys, FUNCTION_POINTS);
+	keep(function_ys[i % FUNCTION_POINTS]);
+}
+
+/* Fuzzy engine, the example described in FEngine.hpp */
+
+static Fuzzy::FEngine* engine = 0;
+static std::map<std::string, double> inputs;
+
+static void setupFEngine() {
+	if (engine) return;
+	engine = new Fuzzy::FEngine();
+	Fuzzy::FVariable* v = new Fuzzy::FVariable("speed", 0.0, 1.0);
+	v->addMembershipFunction("slow", new Math::RampDesc(0.2, 0.4));
+	v->addMembershipFunction("medium", new Math::Trapezoidal(0.3, 0.5, 0.6, 0.8));
+	v->addMembershipFunction("fast", new Math::RampAsc(0.6, 0.7));
+	engine->addVariable(v);
+	v = new Fuzzy::FVariable("stamina", 0.0, 8000.0);
+	v->addMembershipFunction("low", new Math::RampDesc(4000.0, 6000.0));
+	v->addMembershipFunction("high", new Math::RampAsc(4000.0, 6000.0));
+	engine->addVariable(v);
+	v = new Fuzzy::FVariable("dash", 0.0, 100.0);
+	v->addMembershipFunction("low", new Math::RampDesc(30.0, 50.0));
+	v->addMembershipFunction("medium", new Math::Trapezoidal(20.0, 40.0, 60.0, 80.0));
+	v->addMembershipFunction("high", new Math::RampAsc(60.0, 80.0));
+	engine->addVariable(v);
+	engine->addRule(Fuzzy::FRule("speed = slow   & stamina = low  -> dash = low"));
+	engine->addRule(Fuzzy::FRule("speed = slow   & stamina = high -> dash = high"));
+	engine->addRule(Fuzzy::FRule("speed = medium & stamina = low  -> dash = low"));
+	engine->addRule(Fuzzy::FRule("speed = medium & stamina = high -> dash = high"));
+	engine->addRule(Fuzzy::FRule("speed = fast   & stamina = low  -> dash = low"));
+	engine->addRule(Fuzzy::FRule("speed = fast   & stamina = high -> dash = medium"));
+}
+
+static void fengineEvaluate(unsigned long i) {
+	inputs["speed"] = (double)(i % 100) / 100.0;
+	inputs["stamina"] = (double)(i % 80) * 100.0;
+	std::map<std::string, double> outputs = engine->evaluate(inputs);
+	keep(outputs);
+}
+
+static double compiled_in[2];
+static double compiled_out[1];
+static const int FUZZY_BATCH = 256;
+static double batch_in[FUZZY_BATCH * 2];
+static double batch_out[FUZZY_BATCH];
+
+static void setupCompiledFEngine() {
+	setupFEngine();
+	engine->compile();
+	int speed = engine->getInputIndex("speed");
+	int stamina = engine->getInputIndex("stamina");
+	for (int n = 0; n < FUZZY_BATCH; ++n) {
+		batch_in[n * 2 + speed] = (double)(n % 100) / 100.0;
+		batch_in[n * 2 + stamina] = (double)(n % 80) * 100.0;
+	}
+}
+
+static void fengineEvaluateCompiled(unsigned long i) {
+	compiled_in[engine->getInputIndex("speed")] = (double)(i % 100) / 100.0;
+	compiled_in[engine->getInputIndex("stamina")] = (double)(i % 80) * 100.0;
+	engine->evaluate(compiled_in, compiled_out);
+	keep(compiled_out[0]);
+}
+
+static void fengineEvaluateBatch(unsigned long i) {
+	engine->evaluate(batch_in, batch_out, FUZZY_BATCH);
+	keep(batch_out[i % FUZZY_BATCH]);
+}
+
+/* Largest difference between the compiled and the map evaluations */
+static void reportCompiledFEngine(Result &result) {
+	double error = 0.0;
+	for (int n = 0; n < FUZZY_BATCH; ++n) {
+		inputs["speed"] = (double)(n % 100) / 100.0;
+		inputs["stamina"] = (double)(n % 80) * 100.0;
+		std::map<std::string, double> outputs = engine->evaluate(inputs);
+		double difference = fabs(outputs["dash"] - batch_out[n]);
+		if (difference > error) error = difference;
+	}
+	result.metrics.push_back(std::make_pair(std::string("max_error"), error));
+}
+
+/* Baked control surface of the same engine */
+
+static Fuzzy::FSurface surface;
+
+static void setupFSurface() {
+	setupCompiledFEngine();
+	if (surface.getInputCount() == 0) surface.bake(*engine, 33);
+}
+
+static void fsurfaceEvaluate(unsigned long i) {
+	compiled_in[surface.getInputIndex("speed")] = (double)(i % 100) / 100.0;
+	compiled_in[surface.getInputIndex("stamina")] = (double)(i % 80) * 100.0;
+	surface.evaluate(compiled_in, compiled_out);
+	keep(compiled_out[0]);
+}
+
+static void reportFSurface(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("max_error"), surface.getMaxError()));
+}
+
+/* Distances from the ball to 256 points of the field, one by one and with the one to many kernels */
+
+static const int GEOMETRY_POINTS = 256;
+static double geometry_xs[GEOMETRY_POINTS];
+static double geometry_ys[GEOMETRY_POINTS];
+static double geometry_ds[GEOMETRY_POINTS];
+static int geometry_indices[GEOMETRY_POINTS];
+
+static void setupGeometry() {
+	for (int i = 0; i < GEOMETRY_POINTS; ++i) {
+		geometry_xs[i] = -52.5 + 0.41 * i;
+		geometry_ys[i] = -34.0 + 0.27 * ((i * 37) % GEOMETRY_POINTS);
+	}
+}
+
+static void geometryDistancesScalar(unsigned long i) {
+	double x = 0.01 * (i % 100);
+	for (int k = 0; k < GEOMETRY_POINTS; ++k) {
+		geometry_ds[k] = sqrt(pow(geometry_xs[k] - x, 2.0) + pow(geometry_ys[k] - 4.0, 2.0));
+	}
+	keep(geometry_ds[i % GEOMETRY_POINTS]);
+}
+
+static void geometryDistances(unsigned long i) {
+	Geometry::distances(0.01 * (i % 100), 4.0, geometry_xs, geometry_ys, geometry_ds, GEOMETRY_POINTS);
+	keep(geometry_ds[i % GEOMETRY_POINTS]);
+}
+
+static void geometryWithinRadius(unsigned long i) {
+	size_t count = Geometry::withinRadius(0.01 * (i % 100), 4.0, geometry_xs, geometry_ys, GEOMETRY_POINTS, 20.0, geometry_indices);
+	keep(count);
+}
+
+/* Potential fields, every player on the field is an obstacle */
+
+static std::vector<Geometry::Point> obstacles;
+
+static void setupPFields() {
+	obstacles.clear();
+	for (int i = 0; i < 22; ++i) {
+		obstacles.push_back(Geometry::Point(-50.0 + 4.7 * i, -30.0 + 13.0 * (i % 5)));
+	}
+}
+
+static void pfieldsComputePotential(unsigned long i) {
+	Geometry::PFields<Math::RampDesc, Math::Linear> pfields(Math::RampDesc(0.0, 10.0), Math::Linear(-0.01, 0.0));
+	Geometry::Point position(-12.0 + 0.01 * (i % 100), 4.0);
+	Geometry::Vector2D potential = pfields.computePotential(position, obstacles, Geometry::Point(52.5, 0.0));
+	keep(potential);
+}
+
+/* Map of the field at 1 m, every obstacle or two of them move every cycle */
+
+static Geometry::PFields<Math::RampDesc, Math::Linear> pfields(Math::RampDesc(0.0, 10.0), Math::Linear(-0.01, 0.0));
+static unsigned long pfields_passes = 0;
+static unsigned long pfields_updates = 0;
+
+static void setupPFieldsMap() {
+	setupPFields();
+	pfields.setGrid(Geometry::Point(-52.0, -34.0), 1.0, 105, 69);
+	pfields.update(obstacles, Geometry::Point(52.5, 0.0));
+	pfields_passes = 0;
+	pfields_updates = 0;
+}
+
+static void pfieldsMapUpdate(unsigned long i, int moving) {
+	for (int k = 0; k < moving; ++k) {
+		Geometry::Point &obstacle = obstacles[(i * moving + k) % obstacles.size()];
+		obstacle.x += (i & 1) ? 0.1 : -0.1;
+	}
+	pfields.update(obstacles, Geometry::Point(52.5, 0.0));
+	pfields_passes += pfields.getObstaclePasses();
+	pfields_updates++;
+	keep(pfields.getPotential(i % 105, i % 69));
+}
+
+static void pfieldsMapFull(unsigned long i) {
+	pfieldsMapUpdate(i, obstacles.size());
+}
+
+static void pfieldsMapIncremental(unsigned long i) {
+	pfieldsMapUpdate(i, 2);
+}
+
+static void reportPFieldsMap(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("passes"), pfields_updates > 0 ? (double)pfields_passes / pfields_updates : 0.0));
+}
+
+/* Genetic algorithm, bin packing example described in GAlgorithm.hpp */
+
+static Genetics::GAlgorithm* ga = 0;
+static const int objects[] = {99, 94, 79, 64, 50, 46, 43, 37, 32, 19, 18, 7, 6, 3};
+
+static void evaluatePopulation() {
+	for (std::vector<Genetics::Individual>::iterator it = ga->begin(); it != ga->end(); ++it) {
+		int bins[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		int used = 0;
+		for (size_t i = 0; i < it->variables.size(); ++i) {
+			int bin = it->variables[i] & 7;
+			if (bins[bin] == 0) used++;
+			bins[bin] += objects[i];
+		}
+		int fit = 5 * used;
+		for (int b = 0; b < 8; ++b) {
+			if (bins[b] > 100) {
+				fit += 5 * (bins[b] - 100);
+			} else if (bins[b] > 0) {
+				fit += 100 - bins[b];
+			}
+		}
+		it->fit = 1.0 / fit;
+	}
+}
+
+static void setupGAlgorithm() {
+	if (ga) delete ga;
+	ga = new Genetics::GAlgorithm(0.8, 0.2);
+	for (int i = 0; i < 14; ++i) {
+		ga->addVariable(3);
+	}
+	ga->generatePopulation(50);
+}
+
+static void galgorithmRunGeneration(unsigned long) {
+	evaluatePopulation();
+	ga->runGeneration(true);
+}
+
+/* 2048 individuals of 40 variables of 8 bits, the fitness is set on the packed population */
+
+static Genetics::GAlgorithm* large_ga = 0;
+
+static void setupLargeGAlgorithm() {
+	if (large_ga) delete large_ga;
+	large_ga = new Genetics::GAlgorithm(0.8, 0.2, 42);
+	for (int i = 0; i < 40; ++i) {
+		large_ga->addVariable(8);
+	}
+	large_ga->generatePopulation(2048);
+}
+
+static void galgorithmRunGenerationLarge(unsigned long i) {
+	for (int p = 0; p < large_ga->getSize(); ++p) {
+		large_ga->setFit(p, 1.0 + large_ga->getVariable(p, p % 40));
+	}
+	large_ga->runGeneration(i % 2 == 0);
+}
+
+/* Physics simulator, ROLLOUT_CANDIDATES action sequences of ROLLOUT_CYCLES cycles each */
+
+static const int ROLLOUT_CANDIDATES = 64;
+static const int ROLLOUT_CYCLES = 10;
+static Physics::Simulator simulator;
+static Physics::State rollout_start;
+static Physics::Action rollout_actions[ROLLOUT_CANDIDATES * ROLLOUT_CYCLES];
+static Physics::State rollout_results[ROLLOUT_CANDIDATES];
+
+static void setupPhysics() {
+	rollout_start.x = -12.0;
+	rollout_start.y = 4.0;
+	rollout_start.vx = 0.2;
+	rollout_start.vy = 0.0;
+	rollout_start.body = 0.0;
+	rollout_start.stamina = 8000.0;
+	rollout_start.ball_x = -11.3;
+	rollout_start.ball_y = 4.2;
+	rollout_start.ball_vx = 0.5;
+	rollout_start.ball_vy = 0.1;
+	// Each candidate kicks in a different direction and then turns and dashes after the ball
+	for (int c = 0; c < ROLLOUT_CANDIDATES; ++c) {
+		Physics::Action* actions = rollout_actions + c * ROLLOUT_CYCLES;
+		double direction = -180.0 + 360.0 * c / ROLLOUT_CANDIDATES;
+		actions[0] = Physics::Action(Physics::KICK, 50.0 + c % 50, direction);
+		actions[1] = Physics::Action(Physics::TURN, direction);
+		for (int t = 2; t < ROLLOUT_CYCLES; ++t) {
+			actions[t] = Physics::Action(Physics::DASH, 100.0, (t % 3) * 45.0);
+		}
+	}
+}
+
+static void physicsRollouts(unsigned long i) {
+	rollout_start.vx = 0.001 * (i % 100);
+	simulator.rollouts(rollout_start, rollout_actions, ROLLOUT_CANDIDATES, ROLLOUT_CYCLES, rollout_results);
+	keep(rollout_results[i % ROLLOUT_CANDIDATES]);
+}
+
+/* The rollouts of 1024 candidates spread over the task pool */
+
+static const int PARALLEL_CANDIDATES = 1024;
+static Physics::State parallel_results[PARALLEL_CANDIDATES];
+
+struct RolloutBody {
+	void operator()(int begin, int end) {
+		for (int c = begin; c < end; ++c) {
+			parallel_results[c] = rollout_start;
+			simulator.rollout(parallel_results[c], rollout_actions + (c % ROLLOUT_CANDIDATES) * ROLLOUT_CYCLES, ROLLOUT_CYCLES);
+		}
+	}
+};
+
+static void setupSerialFor() {
+	setupPhysics();
+	Tasks::TaskPool::start(1);
+}
+
+static void setupParallelFor() {
+	setupPhysics();
+	Tasks::TaskPool::start(4);
+}
+
+static void parallelFor(unsigned long i) {
+	RolloutBody body;
+	Tasks::TaskPool::parallelFor(0, PARALLEL_CANDIDATES, body, 16);
+	keep(parallel_results[i % PARALLEL_CANDIDATES]);
+}
+
+static void reportParallelFor(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("threads"), (double)Tasks::TaskPool::getThreads()));
+	Tasks::TaskPool::stop();
+}
+
+/* Fitness of 256 kicks, each one simulated with a noisy start, over the task pool */
+
+static Genetics::GAlgorithm* kicks_ga = 0;
+
+static double kickFitness(const Genetics::Individual &individual, unsigned int seed, void*) {
+	boost::mt19937 rng(seed);
+	boost::uniform_real<> noise(-0.1, 0.1);
+	Physics::State state = rollout_start;
+	state.ball_x += noise(rng);
+	state.ball_y += noise(rng);
+	Physics::Action actions[ROLLOUT_CYCLES];
+	actions[0] = Physics::Action(Physics::KICK, 100.0 * individual.variables[0] / 255.0, -90.0 + 180.0 * individual.variables[1] / 255.0);
+	for (int t = 1; t < ROLLOUT_CYCLES; ++t) {
+		actions[t] = Physics::Action(Physics::DASH, 100.0, 0.0);
+	}
+	simulator.rollout(state, actions, ROLLOUT_CYCLES);
+	return 1.0 / (1.0 + sqrt(pow(52.5 - state.ball_x, 2.0) + pow(state.ball_y, 2.0)));
+}
+
+static void setupKicksGAlgorithm() {
+	setupPhysics();
+	if (kicks_ga) delete kicks_ga;
+	kicks_ga = new Genetics::GAlgorithm(0.8, 0.2, 42);
+	kicks_ga->addVariable(8);
+	kicks_ga->addVariable(8);
+	kicks_ga->generatePopulation(256);
+}
+
+static void setupSerialKicks() {
+	setupKicksGAlgorithm();
+	Tasks::TaskPool::start(1);
+}
+
+static void setupParallelKicks() {
+	setupKicksGAlgorithm();
+	Tasks::TaskPool::start(4);
+}
+
+static void galgorithmEvaluate(unsigned long) {
+	kicks_ga->evaluate(kickFitness, 0, 8);
+	keep(kicks_ga->begin()->fit);
+}
+
+/* Generations of the kicks with a cache of two evaluations per genome */
+
+static Genetics::FitnessCache kicks_cache(2);
+static unsigned long cached_individuals = 0;
+
+static void setupCachedKicks() {
+	setupKicksGAlgorithm();
+	kicks_cache.clear();
+	cached_individuals = 0;
+	kicks_ga->setCache(&kicks_cache);
+	Tasks::TaskPool::start(1);
+}
+
+static void galgorithmGenerationCached(unsigned long) {
+	kicks_ga->evaluate(kickFitness, 0, 8);
+	kicks_ga->runGeneration(true);
+	cached_individuals += kicks_ga->getSize();
+}
+
+/* Fraction of the individuals that were evaluated */
+static void reportCachedKicks(Result &result) {
+	double evaluated = cached_individuals > 0 ? (double)kicks_cache.getEvaluations() / cached_individuals : 0.0;
+	result.metrics.push_back(std::make_pair(std::string("evaluated"), evaluated));
+	Tasks::TaskPool::stop();
+}
+
+static void galgorithmGeneration(unsigned long) {
+	kicks_ga->evaluate(kickFitness, 0, 8);
+	kicks_ga->runGeneration(true);
+}
+
+/* 4 islands of 64 kicks, one generation and a migration every 5 */
+
+static Genetics::Islands* islands = 0;
+
+static void setupIslands() {
+	setupPhysics();
+	if (islands) delete islands;
+	islands = new Genetics::Islands(4, 0.8, 0.2, 42);
+	islands->addVariable(8);
+	islands->addVariable(8);
+	islands->generatePopulation(64);
+	islands->setMigration(5, 4);
+	Tasks::TaskPool::start(4);
+}
+
+static void galgorithmIslands(unsigned long) {
+	islands->run(1, kickFitness);
+	keep(islands->getIsland(0).getFit(0));
+}
+
+/* The kicks with real power and direction, one generation of the default size per iteration */
+
+static Genetics::CMAES* cmaes = 0;
+
+static double kickContinuousFitness(const double* x, int, unsigned int seed, void*) {
+	boost::mt19937 rng(seed);
+	boost::uniform_real<> noise(-0.1, 0.1);
+	Physics::State state = rollout_start;
+	state.ball_x += noise(rng);
+	state.ball_y += noise(rng);
+	Physics::Action actions[ROLLOUT_CYCLES];
+	actions[0] = Physics::Action(Physics::KICK, x[0], x[1]);
+	for (int t = 1; t < ROLLOUT_CYCLES; ++t) {
+		actions[t] = Physics::Action(Physics::DASH, 100.0, 0.0);
+	}
+	simulator.rollout(state, actions, ROLLOUT_CYCLES);
+	return 1.0 / (1.0 + sqrt(pow(52.5 - state.ball_x, 2.0) + pow(state.ball_y, 2.0)));
+}
+
+static void setupCMAES() {
+	setupPhysics();
+	if (cmaes) delete cmaes;
+	cmaes = new Genetics::CMAES(0.3, 42);
+	cmaes->addVariable(0.0, 100.0, 50.0);
+	cmaes->addVariable(-90.0, 90.0, 0.0);
+	cmaes->generatePopulation();
+	Tasks::TaskPool::start(1);
+}
+
+static void cmaesGeneration(unsigned long) {
+	cmaes->evaluate(kickContinuousFitness);
+	cmaes->runGeneration();
+}
+
+static void reportCMAES(Result &result) {
+	result.metrics.push_back(std::make_pair(std::string("size"), (double)cmaes->getSize()));
+	result.metrics.push_back(std::make_pair(std::string("best"), cmaes->getBestFit()));
+	Tasks::TaskPool::stop();
+}
+
+void registerUtilsBenchmarks() {
+	add("pfilter.predict", pfilterPredict, setupPFilter);
+	add("pfilter.update", pfilterUpdate, setupPFilter);
+	add("pfilter.resample", pfilterResample, setupPFilter);
+	add("functions.gaussian.scalar", gaussianScalar, setupFunctions);
+	add("functions.gaussian.batch", gaussianBatch, setupFunctions);
+	add("functions.gaussian.fast", gaussianFast, setupFunctions, reportGaussianFast);
+	add("functions.triangular.scalar", triangularScalar, setupFunctions);
+	add("functions.triangular.batch", triangularBatch, setupFunctions);
+	add("fengine.evaluate", fengineEvaluate, setupFEngine);
+	add("fengine.evaluate.compiled", fengineEvaluateCompiled, setupCompiledFEngine);
+	add("fengine.evaluate.batch", fengineEvaluateBatch, setupCompiledFEngine, reportCompiledFEngine);
+	add("fsurface.evaluate", fsurfaceEvaluate, setupFSurface, reportFSurface);
+	add("geometry.distances.scalar", geometryDistancesScalar, setupGeometry);
+	add("geometry.distances", geometryDistances, setupGeometry);
+	add("geometry.within_radius", geometryWithinRadius, setupGeometry);
+	add("pfields.compute_potential", pfieldsComputePotential, setupPFields);
+	add("pfields.map.full", pfieldsMapFull, setupPFieldsMap, reportPFieldsMap);
+	add("pfields.map.incremental", pfieldsMapIncremental, setupPFieldsMap, reportPFieldsMap);
+	add("galgorithm.run_generation", galgorithmRunGeneration, setupGAlgorithm);
+	add("galgorithm.run_generation.large", galgorithmRunGenerationLarge, setupLargeGAlgorithm);
+	add("physics.rollouts", physicsRollouts, setupPhysics);
+	add("tasks.parallel_for.1", parallelFor, setupSerialFor, reportParallelFor);
+	add("tasks.parallel_for.4", parallelFor, setupParallelFor, reportParallelFor);
+	add("galgorithm.evaluate.1", galgorithmEvaluate, setupSerialKicks, reportParallelFor);
+	add("galgorithm.evaluate.4", galgorithmEvaluate, setupParallelKicks, reportParallelFor);
+	add("galgorithm.generation", galgorithmGeneration, setupSerialKicks, reportParallelFor);
+	add("galgorithm.generation.cached", galgorithmGenerationCached, setupCachedKicks, reportCachedKicks);
+	add("galgorithm.islands.4", galgorithmIslands, setupIslands, reportParallelFor);
+	add("cmaes.generation", cmaesGeneration, setupCMAES, reportCMAES);
+}
+
+}
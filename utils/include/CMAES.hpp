@@ -0,0 +1,146 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CMAES_HPP_
+#define CMAES_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace Genetics {
+
+/*!
+ * Fitness of a candidate of n real variables, bigger is better.  The seed depends only on the seed of
+ * the optimizer, the generation and the candidate, like the GAlgorithm fitness.  The function is called
+ * from several threads at the same time when the task pool is running.
+ */
+typedef double (*ContinuousFitness)(const double* x, int n, unsigned int seed, void* data);
+
+/*!
+ * Covariance matrix adaptation evolution strategy for real variables, with the same loop as GAlgorithm
+ * (generatePopulation, evaluate, runGeneration).  Every generation samples candidates from a normal
+ * distribution, the best half moves the mean and adapts the covariance matrix and the step size, so it
+ * learns the scale and the correlations of the variables and needs far fewer evaluations than a bit
+ * string on smooth problems.  The variables are searched in [min, max] normalized to [0, 1] (sigma is
+ * in those units), the samples out of the bounds are reflected into them.  The state can be saved and
+ * loaded to resume a run.
+ *
+ * Example (tuning two constants of the tracking):
+ *		double match(const double* x, int n, unsigned int seed, void* data) {
+ *			... // Score of a scripted episode with threshold x[0] and offset x[1]
+ *		}
+ *
+ *		Tasks::TaskPool::start(4);
+ *		CMAES cmaes(0.3, 42);
+ *		cmaes.addVariable(0.0, 1.0, 0.5);
+ *		cmaes.addVariable(0.0, 50.0, 20.0);
+ *		cmaes.generatePopulation();
+ *		for (int j = 0; j < 50; ++j) {
+ *			cmaes.evaluate(match);
+ *			cmaes.runGeneration();
+ *		}
+ *		const double* best = cmaes.getBest();
+ */
+class CMAES {
+public:
+	CMAES(double sigma = 0.3, unsigned int seed = 0);
+	~CMAES();
+	void addVariable(double min, double max, double initial);
+	/*!
+	 * Samples the first generation, 0 uses the default size 4 + 3 ln(n)
+	 */
+	void generatePopulation(int size = 0);
+	/*!
+	 * Assigns the fit of every candidate, in parallel over the task pool in chunks of grain candidates
+	 */
+	void evaluate(ContinuousFitness fitness, void* data = 0, int grain = 1);
+	/*!
+	 * Updates the distribution with the fits and samples the next generation
+	 */
+	void runGeneration();
+	void setSeed(unsigned int seed);
+	unsigned int getSeed() const;
+	int getGenerations() const;
+	int getSize() const;
+	int getVariables() const;
+	const double* getCandidate(int candidate) const;
+	double getFit(int candidate) const;
+	void setFit(int candidate, double fit);
+	/*!
+	 * Best candidate evaluated so far and its fit
+	 */
+	const double* getBest() const;
+	double getBestFit() const;
+	/*!
+	 * Mean of the distribution, in the units of the variables
+	 */
+	const double* getMean();
+	double getSigma() const;
+	bool save(const std::string &filename);
+	bool load(const std::string &filename);
+private:
+	int n;
+	int lambda;
+	int mu;
+	double sigma;
+	double initial_sigma;
+	unsigned int seed;
+	int generations;
+	boost::mt19937 rng;
+	std::vector<double> min;
+	std::vector<double> max;
+	std::vector<double> initial;
+	// Strategy parameters
+	std::vector<double> weights;
+	double mueff;
+	double cc;
+	double cs;
+	double c1;
+	double cmu;
+	double damps;
+	double chin;
+	// State, in normalized units
+	std::vector<double> mean;
+	std::vector<double> pc;
+	std::vector<double> ps;
+	std::vector<double> C;			// n * n
+	std::vector<double> B;			// Eigenvectors of C by columns
+	std::vector<double> D;			// Square roots of the eigenvalues of C
+	int eigen_generation;
+	// Generation
+	std::vector<double> samples;	// lambda * n, normalized
+	std::vector<double> candidates;	// lambda * n, in the units of the variables
+	std::vector<double> fits;
+	std::vector<int> order;
+	std::vector<double> best;
+	double best_fit;
+	bool has_best;
+	std::vector<double> mean_x;
+	std::vector<double> z;
+	std::vector<double> y;
+	void setParameters();
+	void sample();
+	void decompose();
+};
+
+}
+
+#endif /* CMAES_HPP_ */
@@ -96,6 +96,21 @@ namespace Fuzzy {
  *		}
  *		return 0;
  * }
+ *
+ * After the rules are loaded the engine can be compiled: the variables and the sets are resolved to
+ * indices, the rules to arrays of indices and the output sets are sampled once, the samples are used
+ * by the defuzzification of the variables that are not piecewise linear.
+ * The compiled evaluation takes the inputs in the order of getInputIndex and does not allocate memory:
+ *
+ *		engine.compile();
+ *		double in[2];
+ *		double out[1];
+ *		in[engine.getInputIndex("speed")] = 0.4;
+ *		in[engine.getInputIndex("stamina")] = 7000.0;
+ *		engine.evaluate(in, out);
+ *		std::cout << "dash " << out[engine.getOutputIndex("dash")] << std::endl;
+ *
+ * The compiled evaluation uses buffers of the engine, an engine can not be evaluated by two threads.
  */
 class FEngine : private boost::noncopyable {
 public:
@@ -107,11 +122,54 @@ public:
 	std::vector<FRule>::iterator begin();
 	std::vector<FRule>::iterator end();
 	std::map<std::string, double> evaluate(std::map<std::string, double> inputs);
+	/*!
+	 * Resolves the variables, sets and rules to indices, it is done by the first compiled evaluation
+	 * if it was not called after the last variable or rule was added
+	 */
+	void compile();
+	bool isCompiled() const;
+	int getInputCount() const;
+	int getOutputCount() const;
+	/*!
+	 * Index of a variable in the inputs or outputs arrays, -1 if it is not used by the rules
+	 */
+	int getInputIndex(std::string name) const;
+	int getOutputIndex(std::string name) const;
+	std::string getInputName(int index) const;
+	std::string getOutputName(int index) const;
+	/*!
+	 * Evaluates one vector of inputs (getInputCount values) into one vector of outputs (getOutputCount values)
+	 */
+	void evaluate(const double* in, double* out);
+	/*!
+	 * Evaluates count vectors of inputs stored one after the other, the outputs are stored in the same way
+	 */
+	void evaluate(const double* in, double* out, int count);
 private:
 	std::map<std::string, FVariable*> variables;
 	std::vector<FRule> rules;
 	std::map<std::string, std::map<std::string, double> > outputs;
 	void reload();
+	// Compiled engine
+	struct CompiledRule {
+		int first_input;
+		int first_set;
+		int second_input;
+		int second_set;
+		int output_set;
+	};
+	bool compiled;
+	std::vector<std::string> input_names;
+	std::vector<std::string> output_names;
+	std::vector<FVariable*> output_variables;
+	std::vector<Math::Function*> input_functions;	// Input sets used by the rules
+	std::vector<int> input_function_variable;		// Input of each input set
+	std::vector<CompiledRule> compiled_rules;
+	std::vector<int> output_offsets;				// First output set of each output, plus the end
+	std::vector<double> output_samples;				// STEPS memberships per output set
+	std::vector<double> output_x;					// STEPS abscissas per output
+	std::vector<double> memberships;
+	std::vector<double> strengths;
 };
 
 }
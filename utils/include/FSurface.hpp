@@ -0,0 +1,94 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSURFACE_HPP_
+#define FSURFACE_HPP_
+
+#include <string>
+#include <vector>
+#include "FEngine.hpp"
+
+namespace Fuzzy {
+
+/*!
+ * Control surface of an FEngine: the outputs of the engine sampled on a regular grid over the ranges
+ * of its inputs.  The evaluation interpolates the grid linearly in every input (bilinear for the usual
+ * two inputs), the inputs out of range are clamped.  The maximum difference against the engine is
+ * measured at the center of every cell when the surface is baked.  The surface can be saved and
+ * loaded, so the controllers tuned offline are only read in the matches.
+ *
+ * Example:
+ *		FSurface surface;
+ *		surface.bake(engine, 33);
+ *		std::cout << "error " << surface.getMaxError() << std::endl;
+ *		surface.save("dash.fsf");
+ *		...
+ *		FSurface dash;
+ *		if (dash.load("dash.fsf")) {
+ *			double in[2] = {0.4, 7000.0};	// in the order of getInputIndex
+ *			double out[1];
+ *			dash.evaluate(in, out);
+ *		}
+ */
+class FSurface {
+public:
+	static const int MAX_INPUTS = 8;
+	FSurface();
+	~FSurface();
+	/*!
+	 * Bakes the surface with the same resolution (points per input, at least 2) in every input
+	 */
+	bool bake(FEngine &engine, int resolution);
+	/*!
+	 * Bakes the surface with a resolution per input, in the order of the engine inputs
+	 */
+	bool bake(FEngine &engine, const std::vector<int> &resolutions);
+	/*!
+	 * Interpolates the outputs for one vector of inputs, it does not allocate memory
+	 */
+	void evaluate(const double* in, double* out) const;
+	/*!
+	 * Maximum difference between the surface and the engine measured when it was baked
+	 */
+	double getMaxError() const;
+	int getInputCount() const;
+	int getOutputCount() const;
+	int getInputIndex(std::string name) const;
+	int getOutputIndex(std::string name) const;
+	bool save(const std::string &filename) const;
+	bool load(const std::string &filename);
+private:
+	int inputs;
+	int outputs;
+	std::vector<std::string> input_names;
+	std::vector<std::string> output_names;
+	int resolution[MAX_INPUTS];
+	int stride[MAX_INPUTS];		// Nodes between two consecutive points of an input
+	double min[MAX_INPUTS];
+	double max[MAX_INPUTS];
+	double step[MAX_INPUTS];
+	std::vector<double> values;	// Outputs of every node, the first input changes faster
+	double max_error;
+	void index();
+};
+
+}
+
+#endif /* FSURFACE_HPP_ */
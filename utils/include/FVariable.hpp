@@ -23,6 +23,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "functions.hpp"
 
 namespace Fuzzy {
@@ -36,12 +37,29 @@ public:
 	void addMembershipFunction(std::string set, Math::Function* f);
 	double getMembershipFor(std::string set, double value);
 	std::string getName();
+	double getMin() const;
+	double getMax() const;
 	double defuzzify(std::map<std::string, double> memberships);
+	/*!
+	 * Centroid of the sets clipped by the memberships, given in the order of the set names.  It is exact
+	 * when all the sets are piecewise linear, otherwise the sets are sampled STEPS times
+	 */
+	double defuzzify(const double* memberships);
+	bool isPiecewiseLinear() const;
+	static const int MAX_LINEAR_SETS = 16;	///< Sets above it use the sampled centroid
 private:
 	double min;
 	double max;
 	std::string name;
 	std::map<std::string, Math::Function*> mfuncs;
+	std::vector<Math::Function*> functions;	///< mfuncs in the order of the set names
+	std::vector<double> knots;				///< Knots of all the sets inside [min, max], min and max included
+	std::vector<double> segment_start;		///< Value of each set at the start of each interval between knots
+	std::vector<double> segment_end;		///< Value of each set at the end of each interval between knots
+	bool linear;
+	void index();
+	double exactCentroid(const double* memberships);
+	double sampledCentroid(const double* memberships);
 };
 
 }
@@ -0,0 +1,87 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FITNESSCACHE_HPP_
+#define FITNESSCACHE_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Genetics {
+
+/*!
+ * Fits of the genomes already evaluated, keyed by a hash of the packed genome.  A genome is evaluated
+ * until it has max_evaluations evaluations, its fit is the mean of them, so a noisy fitness (a scripted
+ * episode) is averaged while it is repeated and then it is not evaluated anymore.  With 1 every genome
+ * is evaluated once.  The cache can be saved and loaded to be kept between runs of the same variables.
+ *
+ * Example:
+ *		FitnessCache cache(3);
+ *		cache.load("tuning.cache");
+ *		ga.setCache(&cache);
+ *		for (int j = 0; j < 100; ++j) {
+ *			ga.evaluate(episode);
+ *			ga.runGeneration(true);
+ *		}
+ *		cache.save("tuning.cache");
+ */
+class FitnessCache {
+public:
+	FitnessCache(int max_evaluations = 1);
+	~FitnessCache();
+	void setMaxEvaluations(int max_evaluations);
+	int getMaxEvaluations() const;
+	/*!
+	 * Stores the mean fit of a genome, returns false if it has to be evaluated again (it is not in the
+	 * cache or it has less than max_evaluations evaluations)
+	 */
+	bool lookup(const unsigned int* genome, int words, double &fit);
+	/*!
+	 * Adds one evaluation of a genome and returns its mean fit
+	 */
+	double add(const unsigned int* genome, int words, double fit);
+	/*!
+	 * Returns the evaluations of a genome
+	 */
+	int getCount(const unsigned int* genome, int words) const;
+	int getSize() const;
+	unsigned long getHits() const;
+	unsigned long getEvaluations() const;
+	void clear();
+	bool save(const std::string &filename) const;
+	bool load(const std::string &filename);
+	static unsigned long long hash(const unsigned int* genome, int words);
+private:
+	struct Entry {
+		std::vector<unsigned int> genome;
+		double sum;
+		int count;
+	};
+	std::map<unsigned long long, Entry> entries;
+	int max_evaluations;
+	unsigned long hits;
+	unsigned long evaluations;
+	const Entry* find(const unsigned int* genome, int words) const;
+};
+
+}
+
+#endif /* FITNESSCACHE_HPP_ */
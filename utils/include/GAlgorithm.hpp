@@ -21,13 +21,18 @@
 #ifndef GALGORITHM_HPP_
 #define GALGORITHM_HPP_
 
+#include <string>
 #include <vector>
+#include <boost/random/mersenne_twister.hpp>
 
 namespace Genetics {
 
+class FitnessCache;
+
 struct Variable {
 	int bits;
 	int ones;
+	int offset;		// Position of the lowest bit in the genome
 };
 
 struct Individual {
@@ -36,6 +41,32 @@ struct Individual {
 };
 
 /*!
+ * Fitness of an individual.  The seed is different for every evaluation and depends only on the seed of
+ * the algorithm, the generation and the position of the individual, so a fitness that simulates noisy
+ * scenarios gives the same results with any number of threads.  data is the pointer given to evaluate().
+ * The function is called from several threads at the same time when the task pool is running.
+ */
+typedef double (*Fitness)(const Individual &individual, unsigned int seed, void* data);
+
+/*!
+ * Seed given to the fitness of an individual of a generation
+ */
+unsigned int evaluationSeed(unsigned int seed, int generation, int individual);
+
+/*!
+ * The population is one matrix of bit packed genomes, GENOME_WORD_BITS bits per word and the same words
+ * per individual, with the variables one after the other from the highest bits (the first variable) to
+ * the lowest, so the crossover is a mask over whole words.  The next generation is built in a second
+ * matrix that is swapped at the end, no memory is allocated by runGeneration once the buffers are
+ * sized.  begin() / end() give Individual copies of the genomes, the changes made through them (fit
+ * and variables) are written back by runGeneration; getVariable(), getFit() and setFit() work on the
+ * packed population without the copies.
+ *
+ * The random numbers come from one generator seeded in the constructor (the time when the seed is 0),
+ * so two runs with the same seed and the same fitness give the same generations.  The fitness can be
+ * assigned by the caller (iterating begin() / end()) or computed by evaluate(), that spreads the
+ * individuals over the task pool.
+ *
  * Example:
  * Bin packing problem: http://people.sc.fsu.edu/~jburkardt/datasets/bin_packing/bin_packing.html dataset P02
  *
@@ -83,14 +114,67 @@ struct Individual {
  *		return 0;
  * }
  *
+ * The same loop with the fitness evaluated in parallel, reproducible with the seed 42:
+ *
+ * double binPacking(const Individual &individual, unsigned int seed, void* data) {
+ *		... // the fit computed above
+ * }
+ *
+ *		Tasks::TaskPool::start(4);
+ *		GAlgorithm ga(0.8, 0.2, 42);
+ *		...
+ *		for (int j = 0; j < 100; ++j) {
+ *			ga.evaluate(binPacking);
+ *			ga.runGeneration(true);
+ *		}
+ *
  */
 class GAlgorithm {
 public:
-	GAlgorithm(double p_cross, double p_mutation);
+	static const int GENOME_WORD_BITS = 32;
+	GAlgorithm(double p_cross, double p_mutation, unsigned int seed = 0);
 	~GAlgorithm();
 	void addVariable(int bits);
 	void generatePopulation(int size);
 	void runGeneration(bool per_individual = false);
+	/*!
+	 * Assigns the fit of every individual of the current generation, the individuals are evaluated in
+	 * parallel over the task pool in chunks of grain individuals
+	 */
+	void evaluate(Fitness fitness, void* data = 0, int grain = 1);
+	/*!
+	 * With a cache evaluate() only calls the fitness for the genomes the cache can not answer, and once
+	 * for the copies of a genome in the same generation.  The cache is only used by the thread calling
+	 * evaluate(), so the islands evaluated at the same time need one cache each.  The cache is not
+	 * deleted, 0 removes it
+	 */
+	void setCache(FitnessCache* cache);
+	/*!
+	 * Restarts the random numbers, 0 uses the time
+	 */
+	void setSeed(unsigned int seed);
+	unsigned int getSeed() const;
+	int getGenerations() const;
+	int getSize() const;
+	int getGenomeWords() const;
+	const unsigned int* getGenome(int individual) const;
+	int getVariable(int individual, int variable) const;
+	double getFit(int individual) const;
+	void setFit(int individual, double fit);
+	/*!
+	 * Stores the individuals sorted by fit, the best first
+	 */
+	void getRanking(std::vector<int> &ranking) const;
+	/*!
+	 * Replaces an individual, the genome has getGenomeWords() words
+	 */
+	void setIndividual(int individual, const unsigned int* genome, double fit);
+	/*!
+	 * Saves the variables, the population, the fits and the state of the random numbers, so a run loaded
+	 * later continues with the same generations
+	 */
+	bool save(const std::string &filename);
+	bool load(const std::string &filename);
 	std::vector<Individual>::iterator begin();
 	std::vector<Individual>::iterator end();
 private:
@@ -98,10 +182,25 @@ private:
 	double p_cross;
 	double p_mutation;
 	std::vector<Variable> variables;
-	std::vector<Individual> generation;
 	int generations;
-	int cross(int ind_a, int ind_b, int index, int bit);
-	int mutate(int ind, int bit);
+	unsigned int seed;
+	boost::mt19937 rng;
+	int size;
+	int genome_bits;
+	int words;
+	std::vector<unsigned int> genomes;		// size * words
+	std::vector<unsigned int> next;			// Next generation, swapped with genomes
+	std::vector<double> fits;
+	std::vector<double> next_fits;
+	std::vector<unsigned int> mask;			// Crossover mask of one child
+	std::vector<Individual> generation;		// Copies given by begin() / end()
+	FitnessCache* cache;
+	std::vector<int> pending;				// Individuals evaluated by evaluate()
+	std::vector<int> sources;				// Individual with the same genome evaluated instead
+	bool copies;							// True if the copies were given and must be written back
+	void decode(int individual, Individual &copy) const;
+	void encode(const Individual &copy, int individual);
+	void writeBack();
 };
 
 }
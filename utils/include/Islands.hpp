@@ -0,0 +1,121 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISLANDS_HPP_
+#define ISLANDS_HPP_
+
+#include <string>
+#include <vector>
+#include "GAlgorithm.hpp"
+
+namespace Genetics {
+
+/*!
+ * Island model: several populations (islands) of the same variables evolve independently, every
+ * island in its own task of the task pool, and every migration interval the best individuals of each
+ * island replace the worst individuals of the next one (a ring).  The islands can be spread over
+ * several processes (or hosts sharing a directory): the ring continues from the last island of a
+ * process to the first island of the next process through a file per process in the channel
+ * directory.  The processes do not wait for each other, an island takes the migrants of the previous
+ * process when there are new ones.  With a checkpoint prefix every island is saved every checkpoint
+ * interval and load() resumes the run.
+ *
+ * Example (process 0 of 2, the other one runs with process 1):
+ *		Tasks::TaskPool::start(4);
+ *		Islands islands(4, 0.8, 0.2, 42);
+ *		for (int i = 0; i < 14; ++i) {
+ *			islands.addVariable(3);
+ *		}
+ *		islands.setChannel("/tmp/tuning", 0, 2);
+ *		islands.generatePopulation(200);
+ *		islands.setMigration(10, 5);
+ *		islands.setCheckpoint("/tmp/tuning/run", 50);
+ *		islands.load("/tmp/tuning/run");	// Resumes if there is a checkpoint
+ *		islands.run(1000, binPacking);
+ */
+class Islands {
+public:
+	Islands(int islands, double p_cross, double p_mutation, unsigned int seed = 0);
+	~Islands();
+	void addVariable(int bits);
+	/*!
+	 * Generates the population of every island
+	 */
+	void generatePopulation(int size);
+	/*!
+	 * Every interval generations the best elites individuals of each island migrate
+	 */
+	void setMigration(int interval, int elites);
+	/*!
+	 * Extends the ring to processes processes, this one is process (from 0).  It changes the seeds of
+	 * the islands, so it is called before generatePopulation()
+	 */
+	void setChannel(const std::string &directory, int process, int processes);
+	/*!
+	 * Every interval generations the islands are saved in prefix.<island>.<generation> and the state of
+	 * the run in prefix.islands.<process>, the files of the previous checkpoint are removed
+	 */
+	void setCheckpoint(const std::string &prefix, int interval);
+	/*!
+	 * Runs generations generations, every island is evaluated after each one
+	 */
+	void run(int generations, Fitness fitness, void* data = 0, bool per_individual = false);
+	/*!
+	 * Moves the migrants between the islands, run() calls it every migration interval
+	 */
+	void migrate();
+	bool save(const std::string &prefix);
+	bool load(const std::string &prefix);
+	int getIslands() const;
+	GAlgorithm& getIsland(int island);
+	/*!
+	 * Returns the best fit of all the islands and stores the island and the individual
+	 */
+	double getBest(int &island, int &individual) const;
+private:
+	std::vector<GAlgorithm*> islands;
+	unsigned int seed;
+	int interval;
+	int elites;
+	std::string directory;
+	int process;
+	int processes;
+	std::string checkpoint;
+	int checkpoint_interval;
+	int generations;
+	bool evaluated;
+	int migrations;
+	int received;							// Last migration read from the previous process
+	int saved_generations;					// Generation of the last checkpoint saved or loaded, -1 if none
+	std::vector<unsigned int> migrants;
+	std::vector<double> migrant_fits;
+	std::vector<int> ranking;
+	std::string islandFile(const std::string &prefix, int island, int generation) const;
+	std::string channelFile(int process) const;
+	bool sendMigrants(const GAlgorithm &island);
+	bool receiveMigrants(GAlgorithm &island);
+	void replaceWorst(GAlgorithm &island, const unsigned int* genomes, const double* fits, int count);
+	Islands(const Islands&);
+	Islands& operator=(const Islands&);
+};
+
+}
+
+#endif /* ISLANDS_HPP_ */
@@ -22,25 +22,81 @@
 #define PFIELDS_HPP_
 
 #include "geometry.hpp"
+#include <iostream>
 #include <vector>
 
 namespace Geometry {
 
+/*!
+ * Potential field of the obstacles (U, repulsive, only its positive values are used) and the goal (V)
+ * for a position or a map over a grid.  The force of a source is the potential along the unit vector
+ * from the source to the position.  U and V are Math functions of the distance.
+ *
+ * The map is updated every cycle with the obstacles in the same order, only the obstacles that moved
+ * since the last update are subtracted at their old position and added at the new one, and the whole
+ * map is recomputed when most of them moved or every REFRESH updates to drop the rounding drift.
+ *
+ * Example:
+ *		PFields<Math::RampDesc, Math::Linear> pfields(Math::RampDesc(0.0, 10.0), Math::Linear(-0.01, 0.0));
+ *		pfields.setGrid(Point(-52.0, -34.0), 1.0, 105, 69);
+ *		while (...) {
+ *			pfields.update(opponents, Point(52.5, 0.0));
+ *			Vector2D force = pfields.getPotential(column, row);
+ *		}
+ */
 template <class U, class V>
 class PFields {
 public:
+	static const int REFRESH = 64;
 	PFields(U u, V v);
 	~PFields();
-	Vector2D computePotential(Point position, std::vector<Point> obstacles, Point goal);
+	Vector2D computePotential(Point position, const std::vector<Point> &obstacles, Point goal);
+	/*!
+	 * Map of columns x rows cells from origin, the cell (column, row) is at origin + step * (column, row)
+	 */
+	void setGrid(Point origin, double step, int columns, int rows);
+	void update(const std::vector<Point> &obstacles, Point goal);
+	Vector2D getPotential(int column, int row) const;
+	Point getPosition(int column, int row) const;
+	int getColumns() const;
+	int getRows() const;
+	/*!
+	 * Passes of an obstacle over the grid done by the last update, two per moved obstacle
+	 */
+	int getObstaclePasses() const;
 private:
 	U u;
 	V v;
+	int columns;
+	int rows;
+	std::vector<double> xs;
+	std::vector<double> ys;
+	std::vector<double> obstacles_dx;
+	std::vector<double> obstacles_dy;
+	std::vector<double> goal_dx;
+	std::vector<double> goal_dy;
+	std::vector<Point> last_obstacles;
+	Point last_goal;
+	bool has_goal;
+	int updates;
+	int passes;
+	template <class F>
+	void addSource(F &f, bool positive, Point source, double sign, const double* x, const double* y, int count, double* dx, double* dy);
+	void recompute(const std::vector<Point> &obstacles);
 };
 
+template <class U, class V>
+const int PFields<U, V>::REFRESH;
+
 template <class U, class V>
 PFields<U, V>::PFields(U u, V v) {
 	this->u = u;
 	this->v = v;
+	columns = 0;
+	rows = 0;
+	has_goal = false;
+	updates = 0;
+	passes = 0;
 }
 
 template <class U, class V>
@@ -48,26 +104,159 @@ PFields<U, V>::~PFields() {
 
 }
 
+/*
+ * Adds sign times the force of the source at count positions, the distance, the potential and the
+ * force are computed in the same pass over the coordinate arrays.  U and V are stored by value, the
+ * qualified call to evaluate is not dispatched and is inlined.
+ */
+template <class U, class V>
+template <class F>
+void PFields<U, V>::addSource(F &f, bool positive, Point source, double sign, const double* x, const double* y, int count, double* dx, double* dy) {
+	for (int i = 0; i < count; ++i) {
+		double rx = x[i] - source.x;
+		double ry = y[i] - source.y;
+		double d = sqrt(rx * rx + ry * ry);
+		double p = f.F::evaluate(d);
+		if (positive && !(p > 0.0)) continue;
+		// On the source the direction is 0 like atan2(0, 0)
+		if (d > 0.0) {
+			double k = sign * p / d;
+			dx[i] += k * rx;
+			dy[i] += k * ry;
+		} else {
+			dx[i] += sign * p;
+		}
+	}
+}
+
 template <class U, class V>
-Vector2D PFields<U, V>::computePotential(Point position, std::vector<Point> obstacles, Point goal) {
+Vector2D PFields<U, V>::computePotential(Point position, const std::vector<Point> &obstacles, Point goal) {
 	Vector2D potential;
-	for (std::vector<Point>::iterator it = obstacles.begin(); it != obstacles.end(); ++it) {
-		double d = sqrt(pow(position.x - it->x, 2.0) + pow(position.y - it->y, 2.0));
-		double a = atan2(position.y - it->y, position.x - it->x);
+	for (std::vector<Point>::const_iterator it = obstacles.begin(); it != obstacles.end(); ++it) {
+		double rx = position.x - it->x;
+		double ry = position.y - it->y;
+		double d = distance(position, *it);
 		double p = u.evaluate(d);
 		if (p > 0) {
-			potential.dx += p * cos(a);
-			potential.dy += p * sin(a);
+			double k = d > 0.0 ? p / d : 0.0;
+			potential.dx += d > 0.0 ? k * rx : p;
+			potential.dy += k * ry;
 		}
 	}
-	double d = sqrt(pow(position.x - goal.x, 2.0) + pow(position.y - goal.y, 2.0));
-	double a = atan2(position.y - goal.y, position.x - goal.x);
+	double rx = position.x - goal.x;
+	double ry = position.y - goal.y;
+	double d = distance(position, goal);
 	double p = v.evaluate(d);
-	potential.dx += p * cos(a);
-	potential.dy += p * sin(a);
+	double k = d > 0.0 ? p / d : 0.0;
+	potential.dx += d > 0.0 ? k * rx : p;
+	potential.dy += k * ry;
 	return potential;
 }
 
+template <class U, class V>
+void PFields<U, V>::setGrid(Point origin, double step, int columns, int rows) {
+	if (columns < 1 || rows < 1) {
+		std::cerr << "PFields::setGrid(Point, double, int, int) -> empty grid " << columns << "x" << rows << std::endl;
+		return;
+	}
+	this->columns = columns;
+	this->rows = rows;
+	xs.resize(columns * rows);
+	ys.resize(columns * rows);
+	for (int r = 0; r < rows; ++r) {
+		for (int c = 0; c < columns; ++c) {
+			xs[r * columns + c] = origin.x + step * c;
+			ys[r * columns + c] = origin.y + step * r;
+		}
+	}
+	obstacles_dx.assign(columns * rows, 0.0);
+	obstacles_dy.assign(columns * rows, 0.0);
+	goal_dx.assign(columns * rows, 0.0);
+	goal_dy.assign(columns * rows, 0.0);
+	last_obstacles.clear();
+	has_goal = false;
+	updates = 0;
+}
+
+template <class U, class V>
+void PFields<U, V>::recompute(const std::vector<Point> &obstacles) {
+	int cells = columns * rows;
+	for (int i = 0; i < cells; ++i) {
+		obstacles_dx[i] = 0.0;
+		obstacles_dy[i] = 0.0;
+	}
+	for (std::vector<Point>::const_iterator it = obstacles.begin(); it != obstacles.end(); ++it) {
+		addSource(u, true, *it, 1.0, &xs[0], &ys[0], cells, &obstacles_dx[0], &obstacles_dy[0]);
+	}
+	passes = obstacles.size();
+	updates = 0;
+}
+
+template <class U, class V>
+void PFields<U, V>::update(const std::vector<Point> &obstacles, Point goal) {
+	if (columns == 0) {
+		std::cerr << "PFields::update(vector<Point>, Point) -> the grid was not set" << std::endl;
+		return;
+	}
+	int cells = columns * rows;
+	if (!has_goal || goal.x != last_goal.x || goal.y != last_goal.y) {
+		for (int i = 0; i < cells; ++i) {
+			goal_dx[i] = 0.0;
+			goal_dy[i] = 0.0;
+		}
+		addSource(v, false, goal, 1.0, &xs[0], &ys[0], cells, &goal_dx[0], &goal_dy[0]);
+		last_goal = goal;
+		has_goal = true;
+	}
+	int moved = 0;
+	if (obstacles.size() == last_obstacles.size()) {
+		for (unsigned int i = 0; i < obstacles.size(); ++i) {
+			if (obstacles[i].x != last_obstacles[i].x || obstacles[i].y != last_obstacles[i].y) moved++;
+		}
+	} else {
+		moved = obstacles.size() + 1;
+	}
+	if (2 * moved > (int)obstacles.size() || updates >= REFRESH) {
+		recompute(obstacles);
+	} else {
+		passes = 0;
+		for (unsigned int i = 0; i < obstacles.size(); ++i) {
+			if (obstacles[i].x == last_obstacles[i].x && obstacles[i].y == last_obstacles[i].y) continue;
+			addSource(u, true, last_obstacles[i], -1.0, &xs[0], &ys[0], cells, &obstacles_dx[0], &obstacles_dy[0]);
+			addSource(u, true, obstacles[i], 1.0, &xs[0], &ys[0], cells, &obstacles_dx[0], &obstacles_dy[0]);
+			passes += 2;
+		}
+		updates++;
+	}
+	last_obstacles = obstacles;
+}
+
+template <class U, class V>
+Vector2D PFields<U, V>::getPotential(int column, int row) const {
+	int i = row * columns + column;
+	return Vector2D(obstacles_dx[i] + goal_dx[i], obstacles_dy[i] + goal_dy[i]);
+}
+
+template <class U, class V>
+Point PFields<U, V>::getPosition(int column, int row) const {
+	return Point(xs[row * columns + column], ys[row * columns + column]);
+}
+
+template <class U, class V>
+int PFields<U, V>::getColumns() const {
+	return columns;
+}
+
+template <class U, class V>
+int PFields<U, V>::getRows() const {
+	return rows;
+}
+
+template <class U, class V>
+int PFields<U, V>::getObstaclePasses() const {
+	return passes;
+}
+
 }
 
 #endif /* PFIELDS_HPP_ */
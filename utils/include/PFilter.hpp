@@ -48,6 +48,11 @@ public:
 	void initWithBelief(double mu[N], double dev[N]);
 	void update(void(* weight)(Particle<N> &p));
 	void predict(void(* predict)(Particle<N> &p));
+	/*
+	 * Adds gaussian noise with the given deviation to every dimension of the particles, the
+	 * process noise that keeps the resampled particles apart
+	 */
+	void diffuse(double dev[N]);
 	void resample();
 	double getMean(int n);
 	double getVariance(int n);
@@ -58,12 +63,13 @@ private:
 	double variances[N];
 	double total_w;
 	double fit;
+	boost::mt19937 rng;
 	void computeParameters();
 };
 
 template <unsigned int N>
-PFilter<N>::PFilter() {
-	for (int i = 0; i < N; ++i) {
+PFilter<N>::PFilter() : rng(time(0)) {
+	for (unsigned int i = 0; i < N; ++i) {
 		means[i] = 0.0;
 		variances[i] = 0.0;
 	}
@@ -79,7 +85,7 @@ PFilter<N>::~PFilter() {
 template <unsigned int N>
 void PFilter<N>::initWithBelief(double mu[N], double dev[N]) {
 	boost::mt19937 rng(time(0));
-	for (int i = 0; i < N; ++i) {
+	for (unsigned int i = 0; i < N; ++i) {
 		boost::uniform_int<> dist(0, 200 * dev[i]);
 		for (int j = 0; j < PARTICLES; ++j) {
 			particles[j].dimension[i] = mu[i] - dev[i] + (double)dist(rng) / 100.0;
@@ -97,7 +103,7 @@ void PFilter<N>::resample() {
 	boost::uniform_int<> rdist(0, 1000);
 	double r = (1.0 / PARTICLES) * ((double)rdist(rng)) / 1000.0;
 	double c = particles[0].weight;
-	int i = 1;
+	int i = 0;
 	for (int j = 0; j < PARTICLES; ++j) {
 		double u = r + ((double)j) * (1.0 / PARTICLES);
 		while (u > c) {
@@ -119,6 +125,7 @@ void PFilter<N>::resample() {
 		total_w_bu += particles[i].weight;
 	}
 	total_w = total_w_bu;
+	computeParameters();
 }
 
 template <unsigned int N>
@@ -128,6 +135,17 @@ void PFilter<N>::predict(void(* predict)(Particle<N> &p)) {
 	}
 }
 
+template <unsigned int N>
+void PFilter<N>::diffuse(double dev[N]) {
+	for (unsigned int i = 0; i < N; ++i) {
+		if (!(dev[i] > 0.0)) continue;
+		boost::normal_distribution<> noise(0.0, dev[i]);
+		for (int j = 0; j < PARTICLES; ++j) {
+			particles[j].dimension[i] += noise(rng);
+		}
+	}
+}
+
 template <unsigned int N>
 void PFilter<N>::update(void(* update)(Particle<N> &p)) {
 	total_w = 0.0;
@@ -136,6 +154,13 @@ void PFilter<N>::update(void(* update)(Particle<N> &p)) {
 		total_w += particles[i].weight;
 	}
 	fit = total_w;
+	// No particle explains the observation, the belief is kept
+	if (!(total_w > 0.0)) {
+		for (int i = 0; i < PARTICLES; ++i) {
+			particles[i].weight = 1.0;
+		}
+		total_w = PARTICLES;
+	}
 	// Re-normalize
 	double total_w_bu = 0.0;
 	for (int i = 0; i < PARTICLES; ++i) {
@@ -143,6 +168,7 @@ void PFilter<N>::update(void(* update)(Particle<N> &p)) {
 		total_w_bu += particles[i].weight;
 	}
 	total_w = total_w_bu;
+	computeParameters();
 }
 
 template <unsigned int N>
@@ -162,7 +188,7 @@ double PFilter<N>::getFit() {
 
 template <unsigned int N>
 void PFilter<N>::computeParameters() {
-	for (int i = 0; i < N; ++i) {
+	for (unsigned int i = 0; i < N; ++i) {
 		means[i] = 0.0;
 		variances[i] = 0.0;
 		for (int j = 0; j < PARTICLES; ++j) {
@@ -0,0 +1,163 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Based on:
+ *     rcssserver 15 movement model (player.cpp, object.cpp)
+ */
+
+#ifndef PHYSICS_HPP_
+#define PHYSICS_HPP_
+
+namespace Physics {
+
+/*!
+ * Parameters of the movement model, the server parameters combined with the player type.
+ * The default values are the ones of rcssserver 15 for the default player type.
+ */
+struct Model {
+	double ball_accel_max;
+	double ball_decay;
+	double ball_size;
+	double ball_speed_max;
+	double player_accel_max;
+	double player_decay;
+	double player_size;
+	double player_speed_max;
+	double dash_power_rate;
+	double effort;
+	double inertia_moment;
+	double kickable_margin;
+	double kick_power_rate;
+	double stamina_inc_max;
+	double stamina_max;
+	double extra_stamina;
+	double max_dash_power;
+	double min_dash_power;
+	double max_dash_angle;
+	double min_dash_angle;
+	double dash_angle_step;
+	double side_dash_rate;
+	double back_dash_rate;
+	double maxmoment;
+	double minmoment;
+	double maxpower;
+	double minpower;
+	double tackle_dist;
+	double tackle_back_dist;
+	double tackle_width;
+	double tackle_exponent;
+	double tackle_power_rate;
+	double max_tackle_power;
+	double max_back_tackle_power;
+	Model();
+};
+
+/*!
+ * State of a player and the ball, positions and velocities are absolute and the body
+ * direction is in degrees
+ */
+struct State {
+	double x;
+	double y;
+	double vx;
+	double vy;
+	double body;
+	double stamina;
+	double ball_x;
+	double ball_y;
+	double ball_vx;
+	double ball_vy;
+};
+
+enum ACTION_TYPE {
+	NONE,
+	DASH,
+	TURN,
+	KICK,
+	TACKLE
+};
+
+/*!
+ * Action of a cycle, the arguments follow the server commands:
+ * DASH power direction, TURN moment, KICK power direction, TACKLE direction
+ */
+struct Action {
+	ACTION_TYPE type;
+	double arg0;
+	double arg1;
+	Action() : type(NONE), arg0(0.0), arg1(0.0) {};
+	Action(ACTION_TYPE type, double arg0, double arg1 = 0.0) : type(type), arg0(arg0), arg1(arg1) {};
+};
+
+/*!
+ * Deterministic forward simulator of the server movement model.  The noise of the server
+ * (kick_rand, player_rand, ball_rand) and the collisions are not simulated, the tackle is
+ * applied whenever the ball is inside the tackle area.  None of the methods allocates memory,
+ * the rollouts write into buffers supplied by the caller.
+ *
+ * Example:
+ *     Physics::Simulator simulator(model);
+ *     Physics::Action actions[CANDIDATES * CYCLES];
+ *     Physics::State results[CANDIDATES];
+ *     // fill actions, the candidate i uses actions[i * CYCLES] to actions[i * CYCLES + CYCLES - 1]
+ *     simulator.rollouts(start, actions, CANDIDATES, CYCLES, results);
+ */
+class Simulator {
+public:
+	Simulator();
+	Simulator(const Model &model);
+	~Simulator();
+	void setModel(const Model &model);
+	const Model& getModel() const;
+	/*!
+	 * Applies the action and moves the player and the ball one cycle
+	 */
+	void step(State &state, const Action &action) const;
+	/*!
+	 * Applies length actions, if trajectory is not null the state after each cycle is stored in it
+	 */
+	void rollout(State &state, const Action* actions, int length, State* trajectory = 0) const;
+	/*!
+	 * Simulates count candidates of length actions each from the same start, the actions of the
+	 * candidate i start at actions[i * length] and its final state is stored in results[i]
+	 */
+	void rollouts(const State &start, const Action* actions, int count, int length, State* results) const;
+	/*!
+	 * Moves the ball cycles cycles without any action
+	 */
+	void predictBall(State &state, int cycles) const;
+	bool isKickable(const State &state) const;
+	/*!
+	 * Returns the probability of a successful tackle, 0 if the ball is out of the tackle area
+	 */
+	double getTackleProbability(const State &state) const;
+	double getKickEffectiveRate(const State &state) const;
+	double getDashAcceleration(double power, double direction) const;
+private:
+	Model model;
+	void dash(State &state, double power, double direction, double &ax, double &ay) const;
+	void kick(State &state, double power, double direction, double &bax, double &bay) const;
+	void tackle(State &state, double direction, double &bax, double &bay) const;
+};
+
+}
+
+#endif /* PHYSICS_HPP_ */
@@ -0,0 +1,175 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TASKPOOL_HPP_
+#define TASKPOOL_HPP_
+
+namespace Tasks {
+
+typedef void (*Function)(void* arg);
+
+class TaskGroup;
+
+/*!
+ * Task queued in the pool, the function is called with arg and the group is notified when it ends
+ */
+struct Task {
+	Function function;
+	void* arg;
+	TaskGroup* group;
+};
+
+/*!
+ * Group of tasks that are waited together (fork / join).  The thread that waits executes tasks
+ * of the pool until all the tasks of the group end, so the groups can be nested.
+ *
+ * Example:
+ *     Tasks::TaskGroup group;
+ *     group.run(evaluateLeft, &left);
+ *     group.run(evaluateRight, &right);
+ *     group.wait();
+ */
+class TaskGroup {
+public:
+	TaskGroup();
+	/*!
+	 * Waits the pending tasks
+	 */
+	~TaskGroup();
+	/*!
+	 * Queues a task, it is executed by the calling thread if the pool is not running or its queue is full
+	 */
+	void run(Function function, void* arg);
+	/*!
+	 * Executes tasks of the pool until the tasks of the group end
+	 */
+	void wait();
+	/*!
+	 * Returns the tasks queued and not finished
+	 */
+	int getPending() const;
+	/*!
+	 * Called by the pool when a task of the group ends
+	 */
+	void finish();
+private:
+	volatile int pending;
+	TaskGroup(const TaskGroup&);
+	TaskGroup& operator=(const TaskGroup&);
+};
+
+/*!
+ * Work stealing pool of threads.  Every thread (the workers and a shared slot for the threads out of
+ * the pool, like the main thread) has a bounded queue of tasks: the owner pushes and pops the newest
+ * tasks and the idle threads steal the oldest ones from the other queues.  The workers sleep when all
+ * the queues are empty.  The pool is started once with the number of threads, counting the calling
+ * thread, and optionally binds each worker to a core.  No memory is allocated after start().
+ *
+ * Example:
+ *     struct Evaluate {
+ *         void operator()(int begin, int end) {
+ *             for (int i = begin; i < end; ++i) scores[i] = evaluate(candidates[i]);
+ *         }
+ *     };
+ *     Tasks::TaskPool::start(4, true);
+ *     Evaluate body;
+ *     Tasks::TaskPool::parallelFor(0, candidates.size(), body);
+ */
+class TaskPool {
+public:
+	static const int MAX_THREADS = 64;		///< Maximum threads in the pool
+	static const int QUEUE_SIZE = 1024;		///< Tasks per queue
+	static const int MAX_CHUNKS = 256;		///< Maximum chunks of a parallel for
+	/*!
+	 * Starts the workers, threads counts the calling thread so 1 runs everything inline.  With affinity
+	 * the worker i is bound to the core (first_core + i) modulo the cores online, so the agents sharing
+	 * a host can use different cores
+	 */
+	static void start(int threads, bool affinity = false, int first_core = 0);
+	/*!
+	 * Stops and joins the workers, the queued tasks are executed before
+	 */
+	static void stop();
+	/*!
+	 * Returns the threads of the pool, the calling thread included
+	 */
+	static int getThreads();
+	/*!
+	 * Returns true if the workers are running
+	 */
+	static bool isRunning();
+	/*!
+	 * Queues a task in the queue of the calling thread, returns false if the queue is full
+	 */
+	static bool push(const Task &task);
+	/*!
+	 * Executes one queued task, the own queue first and then the others, returns false if there were none
+	 */
+	static bool runPending();
+	/*!
+	 * Calls body(chunk_begin, chunk_end) over [begin, end) split in chunks of at least grain indices,
+	 * the chunks are executed in parallel and the call returns when all of them end
+	 */
+	template <typename Body>
+	static void parallelFor(int begin, int end, Body &body, int grain = 1);
+private:
+	template <typename Body>
+	struct Chunk {
+		Body* body;
+		int begin;
+		int end;
+	};
+	template <typename Body>
+	static void runChunk(void* arg) {
+		Chunk<Body>* chunk = static_cast<Chunk<Body>*>(arg);
+		(*chunk->body)(chunk->begin, chunk->end);
+	}
+};
+
+template <typename Body>
+void TaskPool::parallelFor(int begin, int end, Body &body, int grain) {
+	if (end <= begin) return;
+	int length = end - begin;
+	if (grain < 1) grain = 1;
+	int chunks = getThreads() * 4;
+	if (chunks > MAX_CHUNKS) chunks = MAX_CHUNKS;
+	if (chunks > length / grain) chunks = length / grain;
+	if (chunks <= 1 || !isRunning()) {
+		body(begin, end);
+		return;
+	}
+	Chunk<Body> ranges[MAX_CHUNKS];
+	TaskGroup group;
+	for (int c = 0; c < chunks; ++c) {
+		ranges[c].body = &body;
+		ranges[c].begin = begin + (int)((long)length * c / chunks);
+		ranges[c].end = begin + (int)((long)length * (c + 1) / chunks);
+	}
+	// The first chunk is kept for the calling thread
+	for (int c = 1; c < chunks; ++c) {
+		group.run(runChunk<Body>, &ranges[c]);
+	}
+	runChunk<Body>(&ranges[0]);
+	group.wait();
+}
+
+}
+
+#endif /* TASKPOOL_HPP_ */
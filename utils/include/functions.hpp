@@ -23,10 +23,72 @@
 
 #include <vector>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "constants.hpp"
 
 namespace Math {
 
+/*
+ * exp(x) without the libm call: x = k * ln(2) + r with |r| <= ln(2) / 2, exp(r) by its Taylor
+ * polynomial of degree 7 and 2^k built in the exponent bits.  The relative error is below 1e-8 for
+ * x in [-708, 709], the inputs out of that range are clamped (exp(-708) ~ 3e-308, exp(709) ~ 8e307)
+ * and NaN is not supported.  It has no branches, so the batch loops that use it are vectorized.
+ */
+inline double fastExp(double x) {
+	const double shifter = 6755399441055744.0; // 1.5 * 2^52, the sum rounds x * log2(e) to an integer
+	x = x < -708.0 ? -708.0 : x;
+	x = x > 709.0 ? 709.0 : x;
+	double t = x * 1.4426950408889634 + shifter;
+	double k = t - shifter;
+	double r = x - k * 6.93147180369123816490e-01 - k * 1.90821492927058770002e-10; // ln(2) in two parts
+	double p = 1.0 + r * (1.0 + r * (0.5 + r * (1.0 / 6.0 + r * (1.0 / 24.0 + r * (1.0 / 120.0 + r * (1.0 / 720.0 + r * (1.0 / 5040.0)))))));
+	int64_t bits;
+	int64_t base;
+	memcpy(&bits, &t, sizeof(bits));
+	memcpy(&base, &shifter, sizeof(base));
+	bits = (bits - base + 1023) << 52; // 2^k
+	double scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+
+#ifdef __SSE2__
+/*
+ * fastExp of two values, the operations are the same so the results are equal to the scalar version
+ */
+inline __m128d fastExp(__m128d x) {
+	const __m128d shifter = _mm_set1_pd(6755399441055744.0);
+	x = _mm_max_pd(x, _mm_set1_pd(-708.0));
+	x = _mm_min_pd(x, _mm_set1_pd(709.0));
+	__m128d t = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(1.4426950408889634)), shifter);
+	__m128d k = _mm_sub_pd(t, shifter);
+	__m128d r = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(6.93147180369123816490e-01))), _mm_mul_pd(k, _mm_set1_pd(1.90821492927058770002e-10)));
+	__m128d p = _mm_set1_pd(1.0 / 5040.0);
+	p = _mm_add_pd(_mm_set1_pd(1.0 / 720.0), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(1.0 / 120.0), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(1.0 / 24.0), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(1.0 / 6.0), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(0.5), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(r, p));
+	p = _mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(r, p));
+	__m128i bits = _mm_sub_epi64(_mm_castpd_si128(t), _mm_castpd_si128(shifter));
+	bits = _mm_slli_epi64(_mm_add_epi64(bits, _mm_set1_epi64x(1023)), 52);
+	return _mm_mul_pd(p, _mm_castsi128_pd(bits));
+}
+
+/*
+ * Per lane: mask ? a : b
+ */
+inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+	return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+#endif
+
 /*
  * Base struct
  */
@@ -34,44 +96,117 @@ struct Function {
 	Function() {};
 	virtual ~Function() {};
 	virtual double evaluate(double x) = 0;
+	/*
+	 * Evaluates n points, ys[i] = evaluate(xs[i]).  The functions below replace the virtual call per
+	 * point by a loop without branches, two points at a time with SSE2 for the membership functions and
+	 * the fast exponentials.  The results are the same as the scalar evaluation
+	 */
+	virtual void evaluate(const double* xs, double* ys, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			ys[i] = evaluate(xs[i]);
+		}
+	};
+	/*
+	 * Stores the points where the slope of a piecewise linear function changes (at most 4), returns
+	 * the number of points or -1 if the function is not piecewise linear
+	 */
+	virtual int getKnots(double*) {
+		return -1;
+	};
 };
 
 /*
  * f(x) = (1 / (stdv * sqrt(2 * PI))) * exp(-0.5 * pow(((x - mu) / stdv), 2.0))
+ * With fast the exponential is fastExp
  */
 struct Gaussian : public Function {
 	double mu;
 	double stdv;
-	Gaussian() : Function(), mu(0.0), stdv(1.0) {};
-	Gaussian(double mu, double stdv) : Function(), mu(mu), stdv(stdv) {};
+	bool fast;
+	Gaussian() : Function(), mu(0.0), stdv(1.0), fast(false) {};
+	Gaussian(double mu, double stdv, bool fast = false) : Function(), mu(mu), stdv(stdv), fast(fast) {};
 	~Gaussian() {};
 	double evaluate(double x) {
 		if (stdv > 0.0) {
-			return (1.0 / (stdv * sqrt(2.0 * PI))) * exp(-0.5 * pow(((x - mu) / stdv), 2.0));
+			double z = (x - mu) / stdv;
+			return (1.0 / (stdv * sqrt(2.0 * PI))) * (fast ? fastExp(-0.5 * (z * z)) : exp(-0.5 * (z * z)));
 		}
 		else {
 			return 1.0;
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		if (stdv <= 0.0) {
+			for (size_t i = 0; i < n; ++i) ys[i] = 1.0;
+			return;
+		}
+		double k = 1.0 / (stdv * sqrt(2.0 * PI));
+		if (fast) {
+			size_t i = 0;
+#ifdef __SSE2__
+			for (; i + 2 <= n; i += 2) {
+				__m128d z = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(xs + i), _mm_set1_pd(mu)), _mm_set1_pd(stdv));
+				__m128d e = fastExp(_mm_mul_pd(_mm_set1_pd(-0.5), _mm_mul_pd(z, z)));
+				_mm_storeu_pd(ys + i, _mm_mul_pd(_mm_set1_pd(k), e));
+			}
+#endif
+			for (; i < n; ++i) {
+				double z = (xs[i] - mu) / stdv;
+				ys[i] = k * fastExp(-0.5 * (z * z));
+			}
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				double z = (xs[i] - mu) / stdv;
+				ys[i] = k * exp(-0.5 * (z * z));
+			}
+		}
+	};
 };
 
 /*
  * f(x) = exp(-0.5 * pow(((x - mu) / stdv), 2.0))
+ * With fast the exponential is fastExp
  */
 struct UGaussian : public Function {
 	double mu;
 	double stdv;
-	UGaussian() : Function(), mu(0.0), stdv(1.0) {};
-	UGaussian(double mu, double stdv) : Function(), mu(mu), stdv(stdv) {};
+	bool fast;
+	UGaussian() : Function(), mu(0.0), stdv(1.0), fast(false) {};
+	UGaussian(double mu, double stdv, bool fast = false) : Function(), mu(mu), stdv(stdv), fast(fast) {};
 	~UGaussian() {};
 	double evaluate(double x) {
 		if (stdv > 0.0) {
-			return exp(-0.5 * pow(((x - mu) / stdv), 2.0));
+			double z = (x - mu) / stdv;
+			return fast ? fastExp(-0.5 * (z * z)) : exp(-0.5 * (z * z));
 		}
 		else {
 			return 1.0;
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		if (stdv <= 0.0) {
+			for (size_t i = 0; i < n; ++i) ys[i] = 1.0;
+			return;
+		}
+		if (fast) {
+			size_t i = 0;
+#ifdef __SSE2__
+			for (; i + 2 <= n; i += 2) {
+				__m128d z = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(xs + i), _mm_set1_pd(mu)), _mm_set1_pd(stdv));
+				_mm_storeu_pd(ys + i, fastExp(_mm_mul_pd(_mm_set1_pd(-0.5), _mm_mul_pd(z, z))));
+			}
+#endif
+			for (; i < n; ++i) {
+				double z = (xs[i] - mu) / stdv;
+				ys[i] = fastExp(-0.5 * (z * z));
+			}
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				double z = (xs[i] - mu) / stdv;
+				ys[i] = exp(-0.5 * (z * z));
+			}
+		}
+	};
 };
 
 /*
@@ -103,6 +238,36 @@ struct Triangular : public Function {
 			return 0.0;
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		size_t i = 0;
+#ifdef __SSE2__
+		const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b), vc = _mm_set1_pd(c);
+		for (; i + 2 <= n; i += 2) {
+			__m128d x = _mm_loadu_pd(xs + i);
+			__m128d up = _mm_div_pd(_mm_sub_pd(x, va), _mm_sub_pd(vb, va));
+			__m128d down = _mm_div_pd(_mm_sub_pd(vc, x), _mm_sub_pd(vc, vb));
+			__m128d y = _mm_and_pd(_mm_cmpeq_pd(x, vb), _mm_set1_pd(1.0));
+			y = select(_mm_and_pd(_mm_cmpgt_pd(x, vb), _mm_cmplt_pd(x, vc)), down, y);
+			y = select(_mm_and_pd(_mm_cmpgt_pd(x, va), _mm_cmplt_pd(x, vb)), up, y);
+			_mm_storeu_pd(ys + i, y);
+		}
+#endif
+		for (; i < n; ++i) {
+			double x = xs[i];
+			double up = (x - a) / (b - a);
+			double down = (c - x) / (c - b);
+			double y = x == b ? 1.0 : 0.0;
+			y = x > b && x < c ? down : y;
+			y = x > a && x < b ? up : y;
+			ys[i] = y;
+		}
+	};
+	int getKnots(double* knots) {
+		knots[0] = a;
+		knots[1] = b;
+		knots[2] = c;
+		return 3;
+	};
 };
 
 /*
@@ -135,6 +300,37 @@ struct Trapezoidal : public Function {
 			return 0.0;
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		size_t i = 0;
+#ifdef __SSE2__
+		const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b), vc = _mm_set1_pd(c), vd = _mm_set1_pd(d);
+		for (; i + 2 <= n; i += 2) {
+			__m128d x = _mm_loadu_pd(xs + i);
+			__m128d up = _mm_div_pd(_mm_sub_pd(x, va), _mm_sub_pd(vb, va));
+			__m128d down = _mm_div_pd(_mm_sub_pd(vd, x), _mm_sub_pd(vd, vc));
+			__m128d y = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(x, vc), _mm_cmplt_pd(x, vd)), down);
+			y = select(_mm_and_pd(_mm_cmpge_pd(x, vb), _mm_cmple_pd(x, vc)), _mm_set1_pd(1.0), y);
+			y = select(_mm_and_pd(_mm_cmpgt_pd(x, va), _mm_cmplt_pd(x, vb)), up, y);
+			_mm_storeu_pd(ys + i, y);
+		}
+#endif
+		for (; i < n; ++i) {
+			double x = xs[i];
+			double up = (x - a) / (b - a);
+			double down = (d - x) / (d - c);
+			double y = x > c && x < d ? down : 0.0;
+			y = x >= b && x <= c ? 1.0 : y;
+			y = x > a && x < b ? up : y;
+			ys[i] = y;
+		}
+	};
+	int getKnots(double* knots) {
+		knots[0] = a;
+		knots[1] = b;
+		knots[2] = c;
+		knots[3] = d;
+		return 4;
+	};
 };
 
 /*
@@ -159,6 +355,12 @@ struct Uniform : public Function {
 			return 0.0;
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		double height = 1.0 / (b - a);
+		for (size_t i = 0; i < n; ++i) {
+			ys[i] = xs[i] > a && xs[i] < b ? height : 0.0;
+		}
+	};
 };
 
 /*
@@ -186,6 +388,29 @@ struct RampAsc : public Function {
 			return (x - a) / (b - a);
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		size_t i = 0;
+#ifdef __SSE2__
+		const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
+		for (; i + 2 <= n; i += 2) {
+			__m128d x = _mm_loadu_pd(xs + i);
+			__m128d y = _mm_div_pd(_mm_sub_pd(x, va), _mm_sub_pd(vb, va));
+			y = select(_mm_cmpgt_pd(x, vb), _mm_set1_pd(1.0), y);
+			_mm_storeu_pd(ys + i, _mm_andnot_pd(_mm_cmplt_pd(x, va), y));
+		}
+#endif
+		for (; i < n; ++i) {
+			double x = xs[i];
+			double y = (x - a) / (b - a);
+			y = x > b ? 1.0 : y;
+			ys[i] = x < a ? 0.0 : y;
+		}
+	};
+	int getKnots(double* knots) {
+		knots[0] = a;
+		knots[1] = b;
+		return 2;
+	};
 };
 
 /*
@@ -213,6 +438,29 @@ struct RampDesc : public Function {
 			return (b - x) / (b - a);
 		}
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		size_t i = 0;
+#ifdef __SSE2__
+		const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
+		for (; i + 2 <= n; i += 2) {
+			__m128d x = _mm_loadu_pd(xs + i);
+			__m128d y = _mm_div_pd(_mm_sub_pd(vb, x), _mm_sub_pd(vb, va));
+			y = _mm_andnot_pd(_mm_cmpgt_pd(x, vb), y);
+			_mm_storeu_pd(ys + i, select(_mm_cmplt_pd(x, va), _mm_set1_pd(1.0), y));
+		}
+#endif
+		for (; i < n; ++i) {
+			double x = xs[i];
+			double y = (b - x) / (b - a);
+			y = x > b ? 0.0 : y;
+			ys[i] = x < a ? 1.0 : y;
+		}
+	};
+	int getKnots(double* knots) {
+		knots[0] = a;
+		knots[1] = b;
+		return 2;
+	};
 };
 
 /*
@@ -227,6 +475,14 @@ struct Linear : public Function {
 	double evaluate(double x) {
 		return m * x + b;
 	};
+	void evaluate(const double* xs, double* ys, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			ys[i] = m * xs[i] + b;
+		}
+	};
+	int getKnots(double*) {
+		return 0;
+	};
 };
 
 /*
@@ -242,20 +498,45 @@ struct Inverse : public Function {
 	double evaluate(double x) {
 		return a / (x - b) + c;
 	}
+	void evaluate(const double* xs, double* ys, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			ys[i] = a / (xs[i] - b) + c;
+		}
+	}
 };
 
 /*
  * f(x) = a * e^(x - b) + c
+ * With fast the exponential is fastExp
  */
 struct Exponential : public Function {
 	double a;
 	double b;
 	double c;
-	Exponential() : Function(), a(1.0), b(0.0), c(0.0) {};
-	Exponential(double a, double b, double c) : Function(), a(a), b(b), c(c) {};
+	bool fast;
+	Exponential() : Function(), a(1.0), b(0.0), c(0.0), fast(false) {};
+	Exponential(double a, double b, double c, bool fast = false) : Function(), a(a), b(b), c(c), fast(fast) {};
 	~Exponential() {};
 	double evaluate(double x) {
-		return a * exp(x - b) + c;
+		return a * (fast ? fastExp(x - b) : exp(x - b)) + c;
+	}
+	void evaluate(const double* xs, double* ys, size_t n) {
+		if (fast) {
+			size_t i = 0;
+#ifdef __SSE2__
+			for (; i + 2 <= n; i += 2) {
+				__m128d e = fastExp(_mm_sub_pd(_mm_loadu_pd(xs + i), _mm_set1_pd(b)));
+				_mm_storeu_pd(ys + i, _mm_add_pd(_mm_mul_pd(_mm_set1_pd(a), e), _mm_set1_pd(c)));
+			}
+#endif
+			for (; i < n; ++i) {
+				ys[i] = a * fastExp(xs[i] - b) + c;
+			}
+		} else {
+			for (size_t i = 0; i < n; ++i) {
+				ys[i] = a * exp(xs[i] - b) + c;
+			}
+		}
 	}
 };
 
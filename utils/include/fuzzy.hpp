@@ -29,5 +29,6 @@
 #include "FVariable.hpp"
 #include "FRule.hpp"
 #include "FEngine.hpp"
+#include "FSurface.hpp"
 
 #endif /* FUZZY_HPP_ */
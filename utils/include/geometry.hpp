@@ -22,7 +22,11 @@
 #define GEOMETRY_HPP_
 
 #include <cmath>
+#include <cstddef>
 #include "constants.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /*
  * Disclaimer: all this primitives use radians instead of sexagesimal degrees
@@ -89,26 +93,132 @@ struct Point {
 	}
 };
 
-inline double toDegrees(double radians) {
-	double degrees = (180.0 * radians / Math::PI);
-	if (degrees > 180.0) {
-		degrees -= 360.0;
-	} else if (degrees < -180.0) {
-		degrees += 360.0;
+/*
+ * Angle in degrees normalized to (-180, 180], any number of turns
+ */
+inline double normalizeAngle(double degrees) {
+	if (degrees > 180.0 || degrees <= -180.0) {
+		degrees -= 360.0 * ceil((degrees - 180.0) / 360.0);
 	}
 	return degrees;
 }
 
-inline double toRadians(double degrees) {
-	double radians = (Math::PI * degrees / 180.0);
-	if (radians > 2.0 * Math::PI) {
-		radians -= 2.0 * Math::PI;
-	} else if (radians < -2.0 * Math::PI) {
-		radians += 2.0 * Math::PI;
+/*
+ * Angle in radians normalized to (-PI, PI], any number of turns
+ */
+inline double normalizeRadians(double radians) {
+	if (radians > Math::PI || radians <= -Math::PI) {
+		radians -= 2.0 * Math::PI * ceil((radians - Math::PI) / (2.0 * Math::PI));
 	}
 	return radians;
 }
 
+/*
+ * Signed difference a - b of two angles in degrees, in (-180, 180]
+ */
+inline double angleDifference(double a, double b) {
+	return normalizeAngle(a - b);
+}
+
+inline double toDegrees(double radians) {
+	return normalizeAngle(180.0 * radians / Math::PI);
+}
+
+inline double toRadians(double degrees) {
+	return normalizeRadians(Math::PI * degrees / 180.0);
+}
+
+/*
+ * Direction in degrees of the vector (dx, dy), in (-180, 180]
+ */
+inline double bearing(double dx, double dy) {
+	return normalizeAngle(180.0 * atan2(dy, dx) / Math::PI);
+}
+
+inline double squaredDistance(double x0, double y0, double x1, double y1) {
+	double dx = x1 - x0;
+	double dy = y1 - y0;
+	return dx * dx + dy * dy;
+}
+
+inline double squaredDistance(Point p0, Point p1) {
+	return squaredDistance(p0.x, p0.y, p1.x, p1.y);
+}
+
+inline double distance(double x0, double y0, double x1, double y1) {
+	return sqrt(squaredDistance(x0, y0, x1, y1));
+}
+
+inline double distance(Point p0, Point p1) {
+	return sqrt(squaredDistance(p0.x, p0.y, p1.x, p1.y));
+}
+
+/*
+ * One to many kernels from (x, y) to the n points with coordinates in xs and ys, two points at a time
+ * with SSE2.  Comparisons against a radius should use the squared distances.
+ */
+inline void squaredDistances(double x, double y, const double* xs, const double* ys, double* ds, size_t n) {
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y);
+	for (; i + 2 <= n; i += 2) {
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vy);
+		_mm_storeu_pd(ds + i, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+	}
+#endif
+	for (; i < n; ++i) {
+		ds[i] = squaredDistance(x, y, xs[i], ys[i]);
+	}
+}
+
+inline void distances(double x, double y, const double* xs, const double* ys, double* ds, size_t n) {
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y);
+	for (; i + 2 <= n; i += 2) {
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vy);
+		_mm_storeu_pd(ds + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+	}
+#endif
+	for (; i < n; ++i) {
+		ds[i] = distance(x, y, xs[i], ys[i]);
+	}
+}
+
+/*
+ * Absolute direction in degrees from (x, y) to every point
+ */
+inline void bearings(double x, double y, const double* xs, const double* ys, double* angles, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		angles[i] = bearing(xs[i] - x, ys[i] - y);
+	}
+}
+
+/*
+ * Indices of the points at a distance of (x, y) less or equal than radius, in order, returns their count
+ */
+inline size_t withinRadius(double x, double y, const double* xs, const double* ys, size_t n, double radius, int* indices) {
+	const double r2 = radius * radius;
+	size_t count = 0;
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y), vr = _mm_set1_pd(r2);
+	for (; i + 2 <= n; i += 2) {
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vy);
+		int mask = _mm_movemask_pd(_mm_cmple_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), vr));
+		if (mask & 1) indices[count++] = i;
+		if (mask & 2) indices[count++] = i + 1;
+	}
+#endif
+	for (; i < n; ++i) {
+		if (squaredDistance(x, y, xs[i], ys[i]) <= r2) indices[count++] = i;
+	}
+	return count;
+}
+
 }
 
 #endif /* GEOMETRY_HPP_ */
@@ -0,0 +1,489 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CMAES.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <boost/random.hpp>
+#include "GAlgorithm.hpp"
+#include "TaskPool.hpp"
+
+namespace Genetics {
+
+struct CandidateBody {
+	const std::vector<double>* candidates;
+	std::vector<double>* fits;
+	int n;
+	ContinuousFitness fitness;
+	void* data;
+	unsigned int seed;
+	int generations;
+	void operator()(int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			(*fits)[i] = fitness(&(*candidates)[i * n], n, evaluationSeed(seed, generations, i), data);
+		}
+	}
+};
+
+struct ByFitDesc {
+	const std::vector<double>* fits;
+	bool operator()(int a, int b) const {
+		return (*fits)[a] > (*fits)[b] || ((*fits)[a] == (*fits)[b] && a < b);
+	}
+};
+
+/*
+ * Reflects a normalized value into [0, 1]
+ */
+static double reflect(double v) {
+	v = fmod(fabs(v), 2.0);
+	return v > 1.0 ? 2.0 - v : v;
+}
+
+CMAES::CMAES(double sigma, unsigned int seed) {
+	n = 0;
+	lambda = 0;
+	mu = 0;
+	this->sigma = sigma;
+	initial_sigma = sigma;
+	generations = 0;
+	eigen_generation = 0;
+	best_fit = 0.0;
+	has_best = false;
+	setSeed(seed);
+}
+
+CMAES::~CMAES() {
+
+}
+
+void CMAES::addVariable(double min, double max, double initial) {
+	if (lambda > 0) {
+		std::cerr << "CMAES::addVariable(double, double, double) -> the population was already generated" << std::endl;
+		return;
+	}
+	if (max <= min) {
+		std::cerr << "CMAES::addVariable(double, double, double) -> empty range [" << min << ", " << max << "]" << std::endl;
+		return;
+	}
+	this->min.push_back(min);
+	this->max.push_back(max);
+	this->initial.push_back(initial);
+	n++;
+}
+
+void CMAES::setParameters() {
+	mu = lambda / 2;
+	weights.resize(mu);
+	double sum = 0.0;
+	for (int i = 0; i < mu; ++i) {
+		weights[i] = log(mu + 0.5) - log(i + 1.0);
+		sum += weights[i];
+	}
+	double sum_squares = 0.0;
+	for (int i = 0; i < mu; ++i) {
+		weights[i] /= sum;
+		sum_squares += weights[i] * weights[i];
+	}
+	mueff = 1.0 / sum_squares;
+	cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+	cs = (mueff + 2.0) / (n + mueff + 5.0);
+	c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+	cmu = 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff);
+	if (cmu > 1.0 - c1) cmu = 1.0 - c1;
+	damps = 1.0 + 2.0 * std::max(0.0, sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+	chin = sqrt((double)n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+}
+
+void CMAES::generatePopulation(int size) {
+	if (n == 0) {
+		std::cerr << "CMAES::generatePopulation(int) -> there are no variables" << std::endl;
+		return;
+	}
+	lambda = size > 1 ? size : 4 + (int)(3.0 * log((double)n));
+	if (lambda < 2) lambda = 2;
+	setParameters();
+	mean.resize(n);
+	for (int i = 0; i < n; ++i) {
+		mean[i] = reflect((initial[i] - min[i]) / (max[i] - min[i]));
+	}
+	sigma = initial_sigma;
+	pc.assign(n, 0.0);
+	ps.assign(n, 0.0);
+	C.assign(n * n, 0.0);
+	B.assign(n * n, 0.0);
+	D.assign(n, 1.0);
+	for (int i = 0; i < n; ++i) {
+		C[i * n + i] = 1.0;
+		B[i * n + i] = 1.0;
+	}
+	samples.resize(lambda * n);
+	candidates.resize(lambda * n);
+	fits.assign(lambda, 0.0);
+	order.resize(lambda);
+	z.resize(n);
+	y.resize(n);
+	generations = 0;
+	eigen_generation = 0;
+	has_best = false;
+	sample();
+}
+
+void CMAES::sample() {
+	boost::normal_distribution<> normal(0.0, 1.0);
+	for (int k = 0; k < lambda; ++k) {
+		for (int i = 0; i < n; ++i) {
+			z[i] = D[i] * normal(rng);
+		}
+		double* x = &samples[k * n];
+		double* real = &candidates[k * n];
+		for (int i = 0; i < n; ++i) {
+			double bdz = 0.0;
+			for (int j = 0; j < n; ++j) {
+				bdz += B[i * n + j] * z[j];
+			}
+			x[i] = reflect(mean[i] + sigma * bdz);
+			real[i] = min[i] + (max[i] - min[i]) * x[i];
+		}
+		fits[k] = 0.0;
+	}
+}
+
+void CMAES::evaluate(ContinuousFitness fitness, void* data, int grain) {
+	CandidateBody body;
+	body.candidates = &candidates;
+	body.fits = &fits;
+	body.n = n;
+	body.fitness = fitness;
+	body.data = data;
+	body.seed = seed;
+	body.generations = generations;
+	Tasks::TaskPool::parallelFor(0, lambda, body, grain);
+}
+
+void CMAES::runGeneration() {
+	if (lambda == 0) return;
+	for (int k = 0; k < lambda; ++k) {
+		order[k] = k;
+	}
+	ByFitDesc by_fit;
+	by_fit.fits = &fits;
+	std::sort(order.begin(), order.end(), by_fit);
+	if (!has_best || fits[order[0]] > best_fit) {
+		best.assign(candidates.begin() + order[0] * n, candidates.begin() + (order[0] + 1) * n);
+		best_fit = fits[order[0]];
+		has_best = true;
+	}
+	// Mean and its step y = (new - old) / sigma
+	for (int i = 0; i < n; ++i) {
+		double m = 0.0;
+		for (int k = 0; k < mu; ++k) {
+			m += weights[k] * samples[order[k] * n + i];
+		}
+		y[i] = (m - mean[i]) / sigma;
+		mean[i] = m;
+	}
+	// C^(-1/2) y = B D^(-1) B' y
+	for (int j = 0; j < n; ++j) {
+		double bty = 0.0;
+		for (int i = 0; i < n; ++i) {
+			bty += B[i * n + j] * y[i];
+		}
+		z[j] = bty / D[j];
+	}
+	double ps_norm = 0.0;
+	double c_ps = sqrt(cs * (2.0 - cs) * mueff);
+	for (int i = 0; i < n; ++i) {
+		double bz = 0.0;
+		for (int j = 0; j < n; ++j) {
+			bz += B[i * n + j] * z[j];
+		}
+		ps[i] = (1.0 - cs) * ps[i] + c_ps * bz;
+		ps_norm += ps[i] * ps[i];
+	}
+	ps_norm = sqrt(ps_norm);
+	bool hsig = ps_norm / sqrt(1.0 - pow(1.0 - cs, 2.0 * (generations + 1))) / chin < 1.4 + 2.0 / (n + 1.0);
+	double c_pc = sqrt(cc * (2.0 - cc) * mueff);
+	for (int i = 0; i < n; ++i) {
+		pc[i] = (1.0 - cc) * pc[i] + (hsig ? c_pc * y[i] : 0.0);
+	}
+	// Rank one and rank mu updates
+	double correction = hsig ? 0.0 : c1 * cc * (2.0 - cc);
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j <= i; ++j) {
+			double rank_mu = 0.0;
+			for (int k = 0; k < mu; ++k) {
+				const double* x = &samples[order[k] * n];
+				double mean_i = mean[i] - sigma * y[i];
+				double mean_j = mean[j] - sigma * y[j];
+				rank_mu += weights[k] * (x[i] - mean_i) * (x[j] - mean_j);
+			}
+			rank_mu /= sigma * sigma;
+			double c = (1.0 - c1 - cmu) * C[i * n + j] + c1 * (pc[i] * pc[j] + correction * C[i * n + j]) + cmu * rank_mu;
+			C[i * n + j] = c;
+			C[j * n + i] = c;
+		}
+	}
+	sigma *= exp((cs / damps) * (ps_norm / chin - 1.0));
+	if (sigma > 1.0) sigma = 1.0; // The whole range
+	generations++;
+	// The decomposition is O(n^3), it is updated when C changed enough
+	if (generations - eigen_generation > lambda / ((c1 + cmu) * n * 10.0)) {
+		decompose();
+	}
+	sample();
+}
+
+/*
+ * Eigen decomposition of C with the cyclic Jacobi method, B gets the eigenvectors by columns and D the
+ * square roots of the eigenvalues
+ */
+void CMAES::decompose() {
+	eigen_generation = generations;
+	std::vector<double> a(C);
+	for (int i = 0; i < n * n; ++i) {
+		B[i] = 0.0;
+	}
+	for (int i = 0; i < n; ++i) {
+		B[i * n + i] = 1.0;
+	}
+	for (int sweep = 0; sweep < 50; ++sweep) {
+		double off = 0.0;
+		for (int p = 0; p < n; ++p) {
+			for (int q = p + 1; q < n; ++q) {
+				off += a[p * n + q] * a[p * n + q];
+			}
+		}
+		if (off < 1e-30) break;
+		for (int p = 0; p < n; ++p) {
+			for (int q = p + 1; q < n; ++q) {
+				double apq = a[p * n + q];
+				if (fabs(apq) < 1e-300) continue;
+				double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+				double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+				double c = 1.0 / sqrt(t * t + 1.0);
+				double s = t * c;
+				for (int k = 0; k < n; ++k) {
+					double akp = a[k * n + p];
+					double akq = a[k * n + q];
+					a[k * n + p] = c * akp - s * akq;
+					a[k * n + q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < n; ++k) {
+					double apk = a[p * n + k];
+					double aqk = a[q * n + k];
+					a[p * n + k] = c * apk - s * aqk;
+					a[q * n + k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < n; ++k) {
+					double bkp = B[k * n + p];
+					double bkq = B[k * n + q];
+					B[k * n + p] = c * bkp - s * bkq;
+					B[k * n + q] = s * bkp + c * bkq;
+				}
+			}
+		}
+	}
+	for (int i = 0; i < n; ++i) {
+		D[i] = sqrt(std::max(a[i * n + i], 1e-20));
+	}
+}
+
+void CMAES::setSeed(unsigned int seed) {
+	if (seed == 0) seed = time(0);
+	this->seed = seed;
+	rng.seed(seed);
+}
+
+unsigned int CMAES::getSeed() const {
+	return seed;
+}
+
+int CMAES::getGenerations() const {
+	return generations;
+}
+
+int CMAES::getSize() const {
+	return lambda;
+}
+
+int CMAES::getVariables() const {
+	return n;
+}
+
+const double* CMAES::getCandidate(int candidate) const {
+	return &candidates[candidate * n];
+}
+
+double CMAES::getFit(int candidate) const {
+	return fits[candidate];
+}
+
+void CMAES::setFit(int candidate, double fit) {
+	fits[candidate] = fit;
+}
+
+const double* CMAES::getBest() const {
+	return has_best ? &best[0] : 0;
+}
+
+double CMAES::getBestFit() const {
+	return best_fit;
+}
+
+const double* CMAES::getMean() {
+	mean_x.resize(n);
+	for (int i = 0; i < n; ++i) {
+		mean_x[i] = min[i] + (max[i] - min[i]) * mean[i];
+	}
+	return n > 0 ? &mean_x[0] : 0;
+}
+
+double CMAES::getSigma() const {
+	return sigma;
+}
+
+static const char CHECKPOINT_MAGIC[4] = {'P', 'H', 'C', 'M'};
+static const int CHECKPOINT_VERSION = 1;
+
+static void writeVector(std::ofstream &file, const std::vector<double> &values) {
+	if (!values.empty()) file.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(double));
+}
+
+static void readVector(std::ifstream &file, std::vector<double> &values, int count) {
+	values.resize(count);
+	if (count > 0) file.read(reinterpret_cast<char*>(&values[0]), count * sizeof(double));
+}
+
+bool CMAES::save(const std::string &filename) {
+	std::string temporary = filename + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "CMAES::save(string) -> could not open " << temporary << std::endl;
+		return false;
+	}
+	std::ostringstream state;
+	state << rng;
+	std::string rng_state = state.str();
+	int length = rng_state.length();
+	file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	file.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+	file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+	file.write(reinterpret_cast<const char*>(&lambda), sizeof(lambda));
+	file.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+	file.write(reinterpret_cast<const char*>(&generations), sizeof(generations));
+	file.write(reinterpret_cast<const char*>(&eigen_generation), sizeof(eigen_generation));
+	file.write(reinterpret_cast<const char*>(&sigma), sizeof(sigma));
+	file.write(reinterpret_cast<const char*>(&initial_sigma), sizeof(initial_sigma));
+	file.write(reinterpret_cast<const char*>(&has_best), sizeof(has_best));
+	file.write(reinterpret_cast<const char*>(&best_fit), sizeof(best_fit));
+	writeVector(file, min);
+	writeVector(file, max);
+	writeVector(file, initial);
+	writeVector(file, mean);
+	writeVector(file, pc);
+	writeVector(file, ps);
+	writeVector(file, C);
+	writeVector(file, B);
+	writeVector(file, D);
+	writeVector(file, samples);
+	writeVector(file, candidates);
+	writeVector(file, fits);
+	best.resize(n);
+	writeVector(file, best);
+	file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	file.write(rng_state.c_str(), length);
+	file.close();
+	if (!file || rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::cerr << "CMAES::save(string) -> error writing " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CMAES::load(const std::string &filename) {
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) {
+		std::cerr << "CMAES::load(string) -> could not open " << filename << std::endl;
+		return false;
+	}
+	char magic[4];
+	int version = 0;
+	int file_n = 0;
+	int file_lambda = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&file_n), sizeof(file_n));
+	file.read(reinterpret_cast<char*>(&file_lambda), sizeof(file_lambda));
+	if (!file || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION ||
+			file_n < 1 || file_n > 1 << 12 || file_lambda < 2 || file_lambda > 1 << 16) {
+		std::cerr << "CMAES::load(string) -> invalid checkpoint " << filename << std::endl;
+		return false;
+	}
+	n = file_n;
+	lambda = file_lambda;
+	file.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+	file.read(reinterpret_cast<char*>(&generations), sizeof(generations));
+	file.read(reinterpret_cast<char*>(&eigen_generation), sizeof(eigen_generation));
+	file.read(reinterpret_cast<char*>(&sigma), sizeof(sigma));
+	file.read(reinterpret_cast<char*>(&initial_sigma), sizeof(initial_sigma));
+	file.read(reinterpret_cast<char*>(&has_best), sizeof(has_best));
+	file.read(reinterpret_cast<char*>(&best_fit), sizeof(best_fit));
+	readVector(file, min, n);
+	readVector(file, max, n);
+	readVector(file, initial, n);
+	readVector(file, mean, n);
+	readVector(file, pc, n);
+	readVector(file, ps, n);
+	readVector(file, C, n * n);
+	readVector(file, B, n * n);
+	readVector(file, D, n);
+	readVector(file, samples, lambda * n);
+	readVector(file, candidates, lambda * n);
+	readVector(file, fits, lambda);
+	readVector(file, best, n);
+	int length = 0;
+	file.read(reinterpret_cast<char*>(&length), sizeof(length));
+	if (!file || length < 0 || length > 1 << 20) {
+		std::cerr << "CMAES::load(string) -> truncated checkpoint " << filename << std::endl;
+		return false;
+	}
+	std::vector<char> rng_state(length + 1, '\0');
+	file.read(&rng_state[0], length);
+	if (!file) {
+		std::cerr << "CMAES::load(string) -> truncated checkpoint " << filename << std::endl;
+		return false;
+	}
+	std::istringstream state(std::string(&rng_state[0], length));
+	state >> rng;
+	setParameters();
+	order.resize(lambda);
+	z.resize(n);
+	y.resize(n);
+	return true;
+}
+
+}
@@ -24,7 +24,7 @@
 namespace Fuzzy {
 
 FEngine::FEngine() {
-
+	compiled = false;
 }
 
 FEngine::~FEngine() {
@@ -35,6 +35,7 @@ FEngine::~FEngine() {
 
 void FEngine::addVariable(FVariable* variable) {
 	variables[variable->getName()] = variable;
+	compiled = false;
 }
 
 void FEngine::addRule(FRule rule) {
@@ -42,6 +43,7 @@ void FEngine::addRule(FRule rule) {
 	rule.parse();
 	outputs[rule.getOutputName()][rule.getOutputSet()] = 0.0;
 	rules.push_back(rule);
+	compiled = false;
 }
 
 FVariable* FEngine::getVariable(std::string name) {
@@ -86,4 +88,172 @@ void FEngine::reload() {
 	}
 }
 
+/*
+ * Index of name in names, it is appended if it is not there
+ */
+static int indexOf(std::vector<std::string> &names, const std::string &name) {
+	for (unsigned int i = 0; i < names.size(); ++i) {
+		if (names[i] == name) return i;
+	}
+	names.push_back(name);
+	return names.size() - 1;
+}
+
+void FEngine::compile() {
+	input_names.clear();
+	output_names.clear();
+	output_variables.clear();
+	input_functions.clear();
+	input_function_variable.clear();
+	compiled_rules.clear();
+	output_offsets.clear();
+	output_samples.clear();
+	output_x.clear();
+	// Inputs and outputs in the order of the rules
+	for (std::vector<FRule>::iterator itr = rules.begin(); itr != rules.end(); ++itr) {
+		if (!itr->parsed) continue;
+		indexOf(input_names, itr->firstVariable);
+		indexOf(input_names, itr->secondVariable);
+		indexOf(output_names, itr->outputVariable);
+	}
+	// Every output set is sampled, the defuzzification uses all the sets of the variable
+	std::map<std::string, std::map<std::string, int> > output_sets;
+	for (unsigned int o = 0; o < output_names.size(); ++o) {
+		FVariable* variable = variables[output_names[o]];
+		output_variables.push_back(variable);
+		output_offsets.push_back(output_samples.size() / STEPS);
+		double step = (variable->max - variable->min) / STEPS;
+		for (int i = 0; i < STEPS; ++i) {
+			output_x.push_back(variable->min + step * i);
+		}
+		for (std::map<std::string, Math::Function*>::iterator it = variable->mfuncs.begin(); it != variable->mfuncs.end(); ++it) {
+			output_sets[output_names[o]][it->first] = output_samples.size() / STEPS;
+			output_samples.resize(output_samples.size() + STEPS);
+			it->second->evaluate(&output_x[output_x.size() - STEPS], &output_samples[output_samples.size() - STEPS], STEPS);
+		}
+	}
+	output_offsets.push_back(output_samples.size() / STEPS);
+	// Input sets are evaluated once per evaluation even if several rules use them
+	std::map<std::string, std::map<std::string, int> > input_sets;
+	for (std::vector<FRule>::iterator itr = rules.begin(); itr != rules.end(); ++itr) {
+		if (!itr->parsed) continue;
+		std::string names[2] = {itr->firstVariable, itr->secondVariable};
+		std::string sets[2] = {itr->firstSet, itr->secondSet};
+		int indices[2];
+		for (int k = 0; k < 2; ++k) {
+			std::map<std::string, int> &indexed = input_sets[names[k]];
+			std::map<std::string, int>::iterator it = indexed.find(sets[k]);
+			if (it == indexed.end()) {
+				indexed[sets[k]] = input_functions.size();
+				indices[k] = input_functions.size();
+				input_functions.push_back(variables[names[k]]->mfuncs[sets[k]]);
+				input_function_variable.push_back(indexOf(input_names, names[k]));
+			} else {
+				indices[k] = it->second;
+			}
+		}
+		CompiledRule rule;
+		rule.first_input = indexOf(input_names, itr->firstVariable);
+		rule.first_set = indices[0];
+		rule.second_input = indexOf(input_names, itr->secondVariable);
+		rule.second_set = indices[1];
+		rule.output_set = output_sets[itr->outputVariable][itr->outputSet];
+		compiled_rules.push_back(rule);
+	}
+	memberships.assign(input_functions.size(), 0.0);
+	strengths.assign(output_offsets.back(), 0.0);
+	compiled = true;
+}
+
+bool FEngine::isCompiled() const {
+	return compiled;
+}
+
+int FEngine::getInputCount() const {
+	return input_names.size();
+}
+
+int FEngine::getOutputCount() const {
+	return output_names.size();
+}
+
+int FEngine::getInputIndex(std::string name) const {
+	for (unsigned int i = 0; i < input_names.size(); ++i) {
+		if (input_names[i] == name) return i;
+	}
+	return -1;
+}
+
+int FEngine::getOutputIndex(std::string name) const {
+	for (unsigned int i = 0; i < output_names.size(); ++i) {
+		if (output_names[i] == name) return i;
+	}
+	return -1;
+}
+
+std::string FEngine::getInputName(int index) const {
+	if (index < 0 || index >= (int)input_names.size()) return "";
+	return input_names[index];
+}
+
+std::string FEngine::getOutputName(int index) const {
+	if (index < 0 || index >= (int)output_names.size()) return "";
+	return output_names[index];
+}
+
+void FEngine::evaluate(const double* in, double* out) {
+	if (!compiled) compile();
+	int sets = input_functions.size();
+	for (int f = 0; f < sets; ++f) {
+		memberships[f] = input_functions[f]->evaluate(in[input_function_variable[f]]);
+	}
+	int total_sets = strengths.size();
+	for (int s = 0; s < total_sets; ++s) {
+		strengths[s] = 0.0;
+	}
+	for (std::vector<CompiledRule>::const_iterator itr = compiled_rules.begin(); itr != compiled_rules.end(); ++itr) {
+		double mfirst = memberships[itr->first_set];
+		double msecond = memberships[itr->second_set];
+		double strength = (mfirst > msecond) ? msecond : mfirst;
+		if (strength > strengths[itr->output_set]) {
+			strengths[itr->output_set] = strength;
+		}
+	}
+	// Centroid of the output sets clipped by the rule strengths, exact for piecewise linear sets
+	int count = output_names.size();
+	for (int o = 0; o < count; ++o) {
+		if (output_variables[o]->isPiecewiseLinear()) {
+			out[o] = output_variables[o]->defuzzify(&strengths[output_offsets[o]]);
+			continue;
+		}
+		const double* x = &output_x[o * STEPS];
+		double sm = 0.0;
+		double M = 0.0;
+		for (int i = 0; i < STEPS; ++i) {
+			double y = 0.0;
+			for (int s = output_offsets[o]; s < output_offsets[o + 1]; ++s) {
+				double ym = output_samples[s * STEPS + i];
+				if (ym > strengths[s]) {
+					ym = strengths[s];
+				}
+				if (ym > y) {
+					y = ym;
+				}
+			}
+			M += y;
+			sm += y * x[i];
+		}
+		out[o] = M > 0.0 ? sm / M : x[0];
+	}
+}
+
+void FEngine::evaluate(const double* in, double* out, int count) {
+	if (!compiled) compile();
+	int inputs = input_names.size();
+	int outputs = output_names.size();
+	for (int n = 0; n < count; ++n) {
+		evaluate(in + n * inputs, out + n * outputs);
+	}
+}
+
 }
@@ -20,6 +20,7 @@
 
 #include "FRule.hpp"
 #include <boost/regex.hpp>
+#include <iostream>
 
 namespace Fuzzy {
 
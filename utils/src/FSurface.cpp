@@ -0,0 +1,289 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FSurface.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Fuzzy {
+
+const int FSurface::MAX_INPUTS;
+
+static const char SURFACE_MAGIC[4] = {'P', 'H', 'F', 'S'};
+static const int SURFACE_VERSION = 1;
+
+FSurface::FSurface() {
+	inputs = 0;
+	outputs = 0;
+	max_error = 0.0;
+}
+
+FSurface::~FSurface() {
+
+}
+
+bool FSurface::bake(FEngine &engine, int resolution) {
+	if (!engine.isCompiled()) engine.compile();
+	return bake(engine, std::vector<int>(engine.getInputCount(), resolution));
+}
+
+bool FSurface::bake(FEngine &engine, const std::vector<int> &resolutions) {
+	if (!engine.isCompiled()) engine.compile();
+	if (engine.getInputCount() == 0 || engine.getInputCount() > MAX_INPUTS || (int)resolutions.size() != engine.getInputCount()) {
+		std::cerr << "FSurface::bake(FEngine, vector<int>) -> the engine must have 1 to " << MAX_INPUTS << " inputs and a resolution for each one" << std::endl;
+		return false;
+	}
+	inputs = engine.getInputCount();
+	outputs = engine.getOutputCount();
+	input_names.clear();
+	output_names.clear();
+	for (int d = 0; d < inputs; ++d) {
+		input_names.push_back(engine.getInputName(d));
+		FVariable* variable = engine.getVariable(input_names[d]);
+		if (variable == 0) {
+			std::cerr << "FSurface::bake(FEngine, vector<int>) -> variable " << input_names[d] << " not found" << std::endl;
+			inputs = 0;
+			outputs = 0;
+			return false;
+		}
+		min[d] = variable->getMin();
+		max[d] = variable->getMax();
+		resolution[d] = resolutions[d] < 2 ? 2 : resolutions[d];
+	}
+	for (int o = 0; o < outputs; ++o) {
+		output_names.push_back(engine.getOutputName(o));
+	}
+	index();
+	int nodes = stride[inputs - 1] * resolution[inputs - 1];
+	values.assign(nodes * outputs, 0.0);
+	double in[MAX_INPUTS];
+	for (int n = 0; n < nodes; ++n) {
+		for (int d = 0; d < inputs; ++d) {
+			in[d] = min[d] + step[d] * ((n / stride[d]) % resolution[d]);
+		}
+		engine.evaluate(in, &values[n * outputs]);
+	}
+	// Error at the center of every cell
+	max_error = 0.0;
+	std::vector<double> live(outputs);
+	std::vector<double> baked(outputs);
+	int cells = 1;
+	for (int d = 0; d < inputs; ++d) {
+		cells *= resolution[d] - 1;
+	}
+	for (int c = 0; c < cells; ++c) {
+		int rest = c;
+		for (int d = 0; d < inputs; ++d) {
+			in[d] = min[d] + step[d] * (rest % (resolution[d] - 1) + 0.5);
+			rest /= resolution[d] - 1;
+		}
+		engine.evaluate(in, &live[0]);
+		evaluate(in, &baked[0]);
+		for (int o = 0; o < outputs; ++o) {
+			double error = fabs(live[o] - baked[o]);
+			if (error > max_error) max_error = error;
+		}
+	}
+	return true;
+}
+
+void FSurface::index() {
+	int nodes = 1;
+	for (int d = 0; d < inputs; ++d) {
+		stride[d] = nodes;
+		nodes *= resolution[d];
+		step[d] = (max[d] - min[d]) / (resolution[d] - 1);
+	}
+}
+
+void FSurface::evaluate(const double* in, double* out) const {
+	int base = 0;
+	double t[MAX_INPUTS];
+	for (int d = 0; d < inputs; ++d) {
+		double f = step[d] > 0.0 ? (in[d] - min[d]) / step[d] : 0.0;
+		if (f < 0.0) f = 0.0;
+		int i = (int)f;
+		if (i >= resolution[d] - 1) i = resolution[d] - 2;
+		t[d] = f - i;
+		if (t[d] > 1.0) t[d] = 1.0;
+		base += i * stride[d];
+	}
+	if (inputs == 2) {
+		// Bilinear
+		const double* v00 = &values[base * outputs];
+		const double* v10 = &values[(base + stride[0]) * outputs];
+		const double* v01 = &values[(base + stride[1]) * outputs];
+		const double* v11 = &values[(base + stride[0] + stride[1]) * outputs];
+		double w00 = (1.0 - t[0]) * (1.0 - t[1]);
+		double w10 = t[0] * (1.0 - t[1]);
+		double w01 = (1.0 - t[0]) * t[1];
+		double w11 = t[0] * t[1];
+		for (int o = 0; o < outputs; ++o) {
+			out[o] = w00 * v00[o] + w10 * v10[o] + w01 * v01[o] + w11 * v11[o];
+		}
+		return;
+	}
+	for (int o = 0; o < outputs; ++o) {
+		out[o] = 0.0;
+	}
+	for (int corner = 0; corner < (1 << inputs); ++corner) {
+		double weight = 1.0;
+		int node = base;
+		for (int d = 0; d < inputs; ++d) {
+			if (corner & (1 << d)) {
+				weight *= t[d];
+				node += stride[d];
+			} else {
+				weight *= 1.0 - t[d];
+			}
+		}
+		if (weight == 0.0) continue;
+		const double* v = &values[node * outputs];
+		for (int o = 0; o < outputs; ++o) {
+			out[o] += weight * v[o];
+		}
+	}
+}
+
+double FSurface::getMaxError() const {
+	return max_error;
+}
+
+int FSurface::getInputCount() const {
+	return inputs;
+}
+
+int FSurface::getOutputCount() const {
+	return outputs;
+}
+
+int FSurface::getInputIndex(std::string name) const {
+	for (unsigned int i = 0; i < input_names.size(); ++i) {
+		if (input_names[i] == name) return i;
+	}
+	return -1;
+}
+
+int FSurface::getOutputIndex(std::string name) const {
+	for (unsigned int i = 0; i < output_names.size(); ++i) {
+		if (output_names[i] == name) return i;
+	}
+	return -1;
+}
+
+static void writeName(std::ofstream &file, const std::string &name) {
+	int length = name.length();
+	file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	file.write(name.c_str(), length);
+}
+
+static bool readName(std::ifstream &file, std::string &name) {
+	int length = 0;
+	file.read(reinterpret_cast<char*>(&length), sizeof(length));
+	if (!file || length < 0 || length > 1024) return false;
+	std::vector<char> buffer(length + 1, '\0');
+	file.read(&buffer[0], length);
+	name = std::string(&buffer[0], length);
+	return (bool)file;
+}
+
+bool FSurface::save(const std::string &filename) const {
+	std::ofstream file(filename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "FSurface::save(string) -> could not open " << filename << std::endl;
+		return false;
+	}
+	file.write(SURFACE_MAGIC, sizeof(SURFACE_MAGIC));
+	file.write(reinterpret_cast<const char*>(&SURFACE_VERSION), sizeof(SURFACE_VERSION));
+	file.write(reinterpret_cast<const char*>(&inputs), sizeof(inputs));
+	file.write(reinterpret_cast<const char*>(&outputs), sizeof(outputs));
+	for (int d = 0; d < inputs; ++d) {
+		writeName(file, input_names[d]);
+		file.write(reinterpret_cast<const char*>(&resolution[d]), sizeof(resolution[d]));
+		file.write(reinterpret_cast<const char*>(&min[d]), sizeof(min[d]));
+		file.write(reinterpret_cast<const char*>(&max[d]), sizeof(max[d]));
+	}
+	for (int o = 0; o < outputs; ++o) {
+		writeName(file, output_names[o]);
+	}
+	file.write(reinterpret_cast<const char*>(&max_error), sizeof(max_error));
+	if (!values.empty()) {
+		file.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(double));
+	}
+	return (bool)file;
+}
+
+bool FSurface::load(const std::string &filename) {
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) {
+		std::cerr << "FSurface::load(string) -> could not open " << filename << std::endl;
+		return false;
+	}
+	char magic[4];
+	int version = 0;
+	int file_inputs = 0;
+	int file_outputs = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&file_inputs), sizeof(file_inputs));
+	file.read(reinterpret_cast<char*>(&file_outputs), sizeof(file_outputs));
+	if (!file || memcmp(magic, SURFACE_MAGIC, sizeof(magic)) != 0 || version != SURFACE_VERSION ||
+			file_inputs < 1 || file_inputs > MAX_INPUTS || file_outputs < 0) {
+		std::cerr << "FSurface::load(string) -> invalid surface file " << filename << std::endl;
+		return false;
+	}
+	inputs = file_inputs;
+	outputs = file_outputs;
+	input_names.assign(inputs, "");
+	output_names.assign(outputs, "");
+	for (int d = 0; d < inputs; ++d) {
+		if (!readName(file, input_names[d])) break;
+		file.read(reinterpret_cast<char*>(&resolution[d]), sizeof(resolution[d]));
+		file.read(reinterpret_cast<char*>(&min[d]), sizeof(min[d]));
+		file.read(reinterpret_cast<char*>(&max[d]), sizeof(max[d]));
+		if (resolution[d] < 2) file.setstate(std::ifstream::failbit);
+	}
+	for (int o = 0; o < outputs && file; ++o) {
+		if (!readName(file, output_names[o])) break;
+	}
+	file.read(reinterpret_cast<char*>(&max_error), sizeof(max_error));
+	if (!file) {
+		std::cerr << "FSurface::load(string) -> truncated surface file " << filename << std::endl;
+		inputs = 0;
+		outputs = 0;
+		return false;
+	}
+	index();
+	values.assign(stride[inputs - 1] * resolution[inputs - 1] * outputs, 0.0);
+	if (!values.empty()) {
+		file.read(reinterpret_cast<char*>(&values[0]), values.size() * sizeof(double));
+	}
+	if (!file) {
+		std::cerr << "FSurface::load(string) -> truncated surface file " << filename << std::endl;
+		inputs = 0;
+		outputs = 0;
+		return false;
+	}
+	return true;
+}
+
+}
@@ -19,13 +19,18 @@
  */
 
 #include "FVariable.hpp"
+#include <algorithm>
 
 namespace Fuzzy {
 
+const int FVariable::MAX_LINEAR_SETS;
+
 FVariable::FVariable(std::string name, double min, double max) {
 	this->name = name;
 	this->min = min;
 	this->max = max;
+	linear = true;
+	index();
 }
 
 FVariable::~FVariable() {
@@ -36,6 +41,7 @@ FVariable::~FVariable() {
 
 void FVariable::addMembershipFunction(std::string set, Math::Function* f) {
 	mfuncs[set] = f;
+	index();
 }
 
 double FVariable::getMembershipFor(std::string set, double value) {
@@ -46,24 +52,174 @@ std::string FVariable::getName() {
 	return name;
 }
 
+double FVariable::getMin() const {
+	return min;
+}
+
+double FVariable::getMax() const {
+	return max;
+}
+
 double FVariable::defuzzify(std::map<std::string, double> memberships) {
+	std::vector<double> clips;
+	for (std::map<std::string, Math::Function*>::iterator it = mfuncs.begin(); it != mfuncs.end(); ++it) {
+		clips.push_back(memberships[it->first]);
+	}
+	return defuzzify(clips.empty() ? 0 : &clips[0]);
+}
+
+double FVariable::defuzzify(const double* memberships) {
+	if (linear) {
+		return exactCentroid(memberships);
+	}
+	return sampledCentroid(memberships);
+}
+
+bool FVariable::isPiecewiseLinear() const {
+	return linear;
+}
+
+void FVariable::index() {
+	functions.clear();
+	knots.clear();
+	knots.push_back(min);
+	knots.push_back(max);
+	linear = mfuncs.size() <= (unsigned int)MAX_LINEAR_SETS && max > min;
+	for (std::map<std::string, Math::Function*>::iterator it = mfuncs.begin(); it != mfuncs.end(); ++it) {
+		functions.push_back(it->second);
+		double function_knots[4];
+		int count = it->second->getKnots(function_knots);
+		if (count < 0) {
+			linear = false;
+			continue;
+		}
+		for (int k = 0; k < count; ++k) {
+			if (function_knots[k] > min && function_knots[k] < max) {
+				knots.push_back(function_knots[k]);
+			}
+		}
+	}
+	std::sort(knots.begin(), knots.end());
+	knots.erase(std::unique(knots.begin(), knots.end()), knots.end());
+	// Every set is linear between two knots, it is evaluated inside the interval so a set that jumps
+	// at a knot (a triangle with a = b) takes its value from the interval side
+	segment_start.clear();
+	segment_end.clear();
+	if (!linear) return;
+	for (unsigned int k = 0; k + 1 < knots.size(); ++k) {
+		double h = knots[k + 1] - knots[k];
+		for (unsigned int s = 0; s < functions.size(); ++s) {
+			double v1 = functions[s]->evaluate(knots[k] + 0.25 * h);
+			double v3 = functions[s]->evaluate(knots[k] + 0.75 * h);
+			segment_start.push_back(1.5 * v1 - 0.5 * v3);
+			segment_end.push_back(1.5 * v3 - 0.5 * v1);
+		}
+	}
+}
+
+/*
+ * Between two knots every set is linear, the clipped sets are linear between the points where a set
+ * crosses its membership and their maximum is linear between the points where two clipped sets cross,
+ * so the area and the moment of each piece are integrated exactly
+ */
+double FVariable::exactCentroid(const double* memberships) {
+	const int sets = functions.size();
+	double points[MAX_LINEAR_SETS + 2];
+	double pieces[MAX_LINEAR_SETS * (MAX_LINEAR_SETS - 1) / 2 + 2];
+	double clip0[MAX_LINEAR_SETS];
+	double clip1[MAX_LINEAR_SETS];
+	double area = 0.0;
+	double moment = 0.0;
+	for (unsigned int k = 0; k + 1 < knots.size(); ++k) {
+		double x0 = knots[k];
+		double x1 = knots[k + 1];
+		double h = x1 - x0;
+		const double* start = &segment_start[k * sets];
+		const double* end = &segment_end[k * sets];
+		int n = 0;
+		points[n++] = x0;
+		for (int s = 0; s < sets; ++s) {
+			double a = memberships[s];
+			if ((start[s] - a) * (end[s] - a) < 0.0) {
+				points[n++] = x0 + h * (a - start[s]) / (end[s] - start[s]);
+			}
+		}
+		points[n++] = x1;
+		std::sort(points, points + n);
+		for (int j = 0; j + 1 < n; ++j) {
+			double u0 = points[j];
+			double u1 = points[j + 1];
+			if (u1 <= u0) continue;
+			for (int s = 0; s < sets; ++s) {
+				double f0 = start[s] + (end[s] - start[s]) * (u0 - x0) / h;
+				double f1 = start[s] + (end[s] - start[s]) * (u1 - x0) / h;
+				clip0[s] = f0 < memberships[s] ? f0 : memberships[s];
+				clip1[s] = f1 < memberships[s] ? f1 : memberships[s];
+			}
+			int m = 0;
+			pieces[m++] = u0;
+			for (int s = 0; s < sets; ++s) {
+				for (int t = s + 1; t < sets; ++t) {
+					double d0 = clip0[s] - clip0[t];
+					double d1 = clip1[s] - clip1[t];
+					if (d0 * d1 < 0.0) {
+						pieces[m++] = u0 + (u1 - u0) * d0 / (d0 - d1);
+					}
+				}
+			}
+			pieces[m++] = u1;
+			std::sort(pieces, pieces + m);
+			double w = u1 - u0;
+			for (int i = 0; i + 1 < m; ++i) {
+				double p0 = pieces[i];
+				double p1 = pieces[i + 1];
+				if (p1 <= p0) continue;
+				double y0 = 0.0;
+				double y1 = 0.0;
+				for (int s = 0; s < sets; ++s) {
+					double c0 = clip0[s] + (clip1[s] - clip0[s]) * (p0 - u0) / w;
+					double c1 = clip0[s] + (clip1[s] - clip0[s]) * (p1 - u0) / w;
+					if (c0 > y0) y0 = c0;
+					if (c1 > y1) y1 = c1;
+				}
+				double length = p1 - p0;
+				area += 0.5 * (y0 + y1) * length;
+				moment += length * (p0 * (2.0 * y0 + y1) + p1 * (y0 + 2.0 * y1)) / 6.0;
+			}
+		}
+	}
+	if (area > 0.0) {
+		return moment / area;
+	} else {
+		return min;
+	}
+}
+
+double FVariable::sampledCentroid(const double* memberships) {
+	const int sets = functions.size();
 	double step = (max - min) / STEPS;
-	double sm = 0.0;
-	double M = 0.0;
+	double xs[STEPS];
+	double ys[STEPS];
+	double ms[STEPS];
 	for (int i = 0; i < STEPS; ++i) {
-		double x = min + step * i;
-		double y = 0.0;
-		for (std::map<std::string, Math::Function*>::iterator it = mfuncs.begin(); it != mfuncs.end(); ++it) {
-			double ym = it->second->evaluate(x);
-			if (ym > memberships[it->first]) {
-				ym = memberships[it->first];
-			}
-			if (ym > y) {
-				y = ym;
+		xs[i] = min + step * i;
+		ys[i] = 0.0;
+	}
+	// Every set is evaluated over all the abscissas at once
+	for (int s = 0; s < sets; ++s) {
+		functions[s]->evaluate(xs, ms, STEPS);
+		for (int i = 0; i < STEPS; ++i) {
+			double ym = ms[i] > memberships[s] ? memberships[s] : ms[i];
+			if (ym > ys[i]) {
+				ys[i] = ym;
 			}
 		}
-		M += step * y;
-		sm += step * y * x;
+	}
+	double sm = 0.0;
+	double M = 0.0;
+	for (int i = 0; i < STEPS; ++i) {
+		M += step * ys[i];
+		sm += step * ys[i] * xs[i];
 	}
 	if (M > 0.0) {
 		return sm / M;
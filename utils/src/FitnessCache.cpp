@@ -0,0 +1,183 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FitnessCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Genetics {
+
+static const char CACHE_MAGIC[4] = {'P', 'H', 'F', 'C'};
+static const int CACHE_VERSION = 1;
+
+FitnessCache::FitnessCache(int max_evaluations) {
+	setMaxEvaluations(max_evaluations);
+	hits = 0;
+	evaluations = 0;
+}
+
+FitnessCache::~FitnessCache() {
+
+}
+
+void FitnessCache::setMaxEvaluations(int max_evaluations) {
+	this->max_evaluations = max_evaluations < 1 ? 1 : max_evaluations;
+}
+
+int FitnessCache::getMaxEvaluations() const {
+	return max_evaluations;
+}
+
+unsigned long long FitnessCache::hash(const unsigned int* genome, int words) {
+	unsigned long long h = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)words;
+	for (int w = 0; w < words; ++w) {
+		h ^= genome[w];
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+		h ^= h >> 31;
+	}
+	return h;
+}
+
+const FitnessCache::Entry* FitnessCache::find(const unsigned int* genome, int words) const {
+	std::map<unsigned long long, Entry>::const_iterator it = entries.find(hash(genome, words));
+	if (it == entries.end()) return 0;
+	const Entry &entry = it->second;
+	if ((int)entry.genome.size() != words || memcmp(&entry.genome[0], genome, words * sizeof(unsigned int)) != 0) {
+		return 0; // Another genome with the same hash
+	}
+	return &entry;
+}
+
+bool FitnessCache::lookup(const unsigned int* genome, int words, double &fit) {
+	const Entry* entry = find(genome, words);
+	if (entry == 0) return false;
+	fit = entry->sum / entry->count;
+	if (entry->count < max_evaluations) return false;
+	hits++;
+	return true;
+}
+
+double FitnessCache::add(const unsigned int* genome, int words, double fit) {
+	evaluations++;
+	Entry &entry = entries[hash(genome, words)];
+	if ((int)entry.genome.size() != words || memcmp(&entry.genome[0], genome, words * sizeof(unsigned int)) != 0) {
+		// New genome, a genome with the same hash is replaced
+		entry.genome.assign(genome, genome + words);
+		entry.sum = 0.0;
+		entry.count = 0;
+	}
+	entry.sum += fit;
+	entry.count++;
+	return entry.sum / entry.count;
+}
+
+int FitnessCache::getCount(const unsigned int* genome, int words) const {
+	const Entry* entry = find(genome, words);
+	return entry ? entry->count : 0;
+}
+
+int FitnessCache::getSize() const {
+	return entries.size();
+}
+
+unsigned long FitnessCache::getHits() const {
+	return hits;
+}
+
+unsigned long FitnessCache::getEvaluations() const {
+	return evaluations;
+}
+
+void FitnessCache::clear() {
+	entries.clear();
+	hits = 0;
+	evaluations = 0;
+}
+
+bool FitnessCache::save(const std::string &filename) const {
+	std::string temporary = filename + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "FitnessCache::save(string) -> could not open " << temporary << std::endl;
+		return false;
+	}
+	int count = entries.size();
+	file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (std::map<unsigned long long, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+		int words = it->second.genome.size();
+		file.write(reinterpret_cast<const char*>(&words), sizeof(words));
+		file.write(reinterpret_cast<const char*>(&it->second.genome[0]), words * sizeof(unsigned int));
+		file.write(reinterpret_cast<const char*>(&it->second.sum), sizeof(it->second.sum));
+		file.write(reinterpret_cast<const char*>(&it->second.count), sizeof(it->second.count));
+	}
+	file.close();
+	if (!file || rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::cerr << "FitnessCache::save(string) -> error writing " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool FitnessCache::load(const std::string &filename) {
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) {
+		std::cerr << "FitnessCache::load(string) -> could not open " << filename << std::endl;
+		return false;
+	}
+	char magic[4];
+	int version = 0;
+	int count = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!file || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || version != CACHE_VERSION || count < 0) {
+		std::cerr << "FitnessCache::load(string) -> invalid cache " << filename << std::endl;
+		return false;
+	}
+	std::vector<unsigned int> genome;
+	for (int e = 0; e < count; ++e) {
+		int words = 0;
+		file.read(reinterpret_cast<char*>(&words), sizeof(words));
+		if (!file || words < 1 || words > 1 << 16) break;
+		genome.resize(words);
+		double sum = 0.0;
+		int evaluations = 0;
+		file.read(reinterpret_cast<char*>(&genome[0]), words * sizeof(unsigned int));
+		file.read(reinterpret_cast<char*>(&sum), sizeof(sum));
+		file.read(reinterpret_cast<char*>(&evaluations), sizeof(evaluations));
+		if (!file) break;
+		Entry &entry = entries[hash(&genome[0], words)];
+		entry.genome = genome;
+		entry.sum = sum;
+		entry.count = evaluations;
+	}
+	if (!file) {
+		std::cerr << "FitnessCache::load(string) -> truncated cache " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+}
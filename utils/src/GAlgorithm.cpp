@@ -20,15 +20,61 @@
 
 #include "GAlgorithm.hpp"
 #include <boost/random.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "FitnessCache.hpp"
+#include "TaskPool.hpp"
 
 namespace Genetics {
 
-GAlgorithm::GAlgorithm(double p_cross, double p_mutation) {
+/*
+ * The bits of the three values are mixed (splitmix64 finalizer) so close generations and individuals
+ * give unrelated streams
+ */
+unsigned int evaluationSeed(unsigned int seed, int generation, int individual) {
+	unsigned long long z = ((unsigned long long)seed << 32) ^ ((unsigned long long)generation << 20) ^ (unsigned long long)individual;
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	return (unsigned int)z;
+}
+
+struct FitnessBody {
+	std::vector<Individual>* generation;
+	const std::vector<int>* indices;		// Individuals to evaluate, 0 for all
+	Fitness fitness;
+	void* data;
+	unsigned int seed;
+	int generations;
+	void operator()(int begin, int end) {
+		for (int k = begin; k < end; ++k) {
+			int i = indices ? (*indices)[k] : k;
+			Individual &individual = (*generation)[i];
+			individual.fit = fitness(individual, evaluationSeed(seed, generations, i), data);
+		}
+	}
+};
+
+const int GAlgorithm::GENOME_WORD_BITS;
+
+GAlgorithm::GAlgorithm(double p_cross, double p_mutation, unsigned int seed) {
 	generations = 0;
 	this->p_cross = p_cross;
 	this->p_mutation = p_mutation;
 	max_var_size = 8 * sizeof(int);
+	size = 0;
+	genome_bits = 0;
+	words = 0;
+	copies = false;
+	cache = 0;
+	setSeed(seed);
 }
 
 GAlgorithm::~GAlgorithm() {
@@ -39,6 +85,10 @@ void GAlgorithm::addVariable(int bits) {
 	if (bits > max_var_size) {
 		return;
 	}
+	if (size > 0) {
+		std::cerr << "GAlgorithm::addVariable(int) -> the population was already generated" << std::endl;
+		return;
+	}
 	Variable var;
 	var.bits = bits;
 	int ones = 0;
@@ -48,122 +98,436 @@ void GAlgorithm::addVariable(int bits) {
 	}
 	var.ones = ones;
 	variables.push_back(var);
+	// The first variable takes the highest bits
+	genome_bits += bits;
+	int offset = genome_bits;
+	for (std::vector<Variable>::iterator it = variables.begin(); it != variables.end(); ++it) {
+		offset -= it->bits;
+		it->offset = offset;
+	}
+	words = (genome_bits + GENOME_WORD_BITS - 1) / GENOME_WORD_BITS;
 }
 
 void GAlgorithm::generatePopulation(int size) {
-	boost::mt19937 rng(time(0));
-	boost::uniform_real<> dist(0.0, 1.0);
+	this->size = size;
+	genomes.assign(size * words, 0);
+	next.assign(size * words, 0);
+	fits.assign(size, 0.0);
+	next_fits.assign(size, 0.0);
+	mask.assign(words, 0);
+	generation.clear();
+	copies = false;
+	// Every bit is 1 with probability 0.5, the bits after the genome stay 0
+	unsigned int last = genome_bits % GENOME_WORD_BITS == 0 ? ~0u : (1u << (genome_bits % GENOME_WORD_BITS)) - 1;
 	for (int p = 0; p < size; ++p) {
-		Individual individual;
-		for (int i = 0; i < variables.size(); ++i) {
-			int var = 0;
-			for (int j = 0; j < variables[i].bits; ++j) {
-				if (dist(rng) > 0.5) {
-					var = mutate(var, j);
-				}
-			}
-			individual.variables.push_back(var);
+		for (int w = 0; w < words; ++w) {
+			genomes[p * words + w] = (unsigned int)rng() & (w == words - 1 ? last : ~0u);
 		}
-		individual.fit = 0.0;
-		generation.push_back(individual);
+	}
+}
+
+/*
+ * Uniform integer in [0, n) from one raw draw, without the division of the modulo
+ */
+static inline int draw(boost::mt19937 &rng, int n) {
+	return (int)(((unsigned long long)rng() * (unsigned int)n) >> 32);
+}
+
+/*
+ * Sets the bits [from, to) of the mask
+ */
+static inline void setBits(unsigned int* mask, int from, int to) {
+	if (from / GAlgorithm::GENOME_WORD_BITS == (to - 1) / GAlgorithm::GENOME_WORD_BITS && to - from < GAlgorithm::GENOME_WORD_BITS) {
+		mask[from / GAlgorithm::GENOME_WORD_BITS] |= ((1u << (to - from)) - 1) << (from % GAlgorithm::GENOME_WORD_BITS);
+		return;
+	}
+	for (int w = from / GAlgorithm::GENOME_WORD_BITS; w * GAlgorithm::GENOME_WORD_BITS < to; ++w) {
+		int low = from - w * GAlgorithm::GENOME_WORD_BITS;
+		int high = to - w * GAlgorithm::GENOME_WORD_BITS;
+		unsigned int bits = ~0u;
+		if (low > 0) bits &= ~0u << low;
+		if (high < GAlgorithm::GENOME_WORD_BITS) bits &= (1u << high) - 1;
+		mask[w] |= bits;
 	}
 }
 
 void GAlgorithm::runGeneration(bool per_individual) {
+	writeBack();
 	double total_fit = 0.0;
-	for (std::vector<Individual>::iterator it = generation.begin(); it != generation.end(); ++it) {
-		total_fit += it->fit;
+	for (int p = 0; p < size; ++p) {
+		total_fit += fits[p];
 	}
 	if (total_fit > 0) {
-		for (std::vector<Individual>::iterator it = generation.begin(); it != generation.end(); ++it) {
-			it->fit = it->fit / total_fit;
+		for (int p = 0; p < size; ++p) {
+			fits[p] = fits[p] / total_fit;
 		}
 	} else {
 		return;
 	}
-	std::vector<Individual> new_gen;
-	boost::mt19937 rng(time(0));
 	boost::uniform_int<>  ndist(0, variables.size() - 1);
 	boost::uniform_real<> rdist(0.0, 1.0);
-	double p_inv = 1.0 / generation.size();
+	double p_inv = 1.0 / size;
 	double r = p_inv * rdist(rng);
-	double c = generation[0].fit;
+	double c = fits[0];
 	int i = 1;
-	Individual first;
-	for (int j = 0; j < 2 * generation.size(); ++j) {
+	int first = 0;
+	int children = 0;
+	for (int j = 0; j < 2 * size; ++j) {
 		double u = r + p_inv * (double)j;
 		while (u > c) {
-			i = (i + 1) % generation.size();
-			c += generation[i].fit;
+			i = (i + 1) % size;
+			c += fits[i];
 		}
-		//std::cout << j << ": Chose " << i << " with fit " << generation[i].fit << " and u " << u << std::endl;
 		if (j % 2 == 0) {
-			first = generation[i];
-		} else {
-			Individual second = generation[i];
-			if (rdist(rng) < p_cross) {
-				Individual child;
-				child.fit = 0.0;
-				child.variables.resize(variables.size());
-				if (per_individual) {
-					int var = ndist(rng);
-					boost::uniform_int<> bdist(0, variables[var].bits);
-					int bit = bdist(rng);
-					for (int k = 0; k < variables.size(); k++) {
-						if (k == var) {
-							child.variables[k] = cross(first.variables[k], second.variables[k], k, bit);
-						} else if (k < var) {
-							child.variables[k] = first.variables[k];
-						} else {
-							child.variables[k] = second.variables[k];
-						}
-					}
-				} else {
-					for (int k = 0; k < variables.size(); k++) {
-						boost::uniform_int<> bdist(1, variables[k].bits);
-						int bit = bdist(rng);
-						child.variables[k] = cross(first.variables[k], second.variables[k], k, bit);
-					}
-				}
-				new_gen.push_back(child);
+			first = i;
+			continue;
+		}
+		int second = i;
+		const unsigned int* a = &genomes[first * words];
+		const unsigned int* b = &genomes[second * words];
+		unsigned int* child = &next[children * words];
+		if (rdist(rng) < p_cross) {
+			// The bits in the mask come from the second parent and the others from the first one
+			for (int w = 0; w < words; ++w) {
+				mask[w] = 0;
+			}
+			if (per_individual) {
+				// One point: the variables before var and the high bits of var from the first parent
+				int var = ndist(rng);
+				int bit = draw(rng, variables[var].bits + 1) + 1;
+				if (bit > variables[var].bits) bit = variables[var].bits;
+				setBits(&mask[0], 0, variables[var].offset + bit);
 			} else {
-				if (first.fit > second.fit) {
-					new_gen.push_back(first);
-				} else {
-					new_gen.push_back(second);
+				// One point per variable, 16 random bits each (one draw for two variables) since this runs
+				// for every variable of every child
+				unsigned int random = 0;
+				for (unsigned int k = 0; k < variables.size(); k++) {
+					if (k % 2 == 0) random = rng();
+					int bit = (int)(((random >> (16 * (k % 2))) & 0xFFFF) * (unsigned int)variables[k].bits >> 16) + 2;
+					if (bit > variables[k].bits) bit = variables[k].bits;
+					setBits(&mask[0], variables[k].offset, variables[k].offset + bit);
 				}
 			}
-			if (rdist(rng) < p_mutation) {
-				int var = ndist(rng);
-				boost::uniform_int<> bdist(0, variables[var].bits - 1);
-				int bit = bdist(rng);
-				new_gen.back().variables[var] = mutate(new_gen.back().variables[var], bit);
+			for (int w = 0; w < words; ++w) {
+				child[w] = (a[w] & ~mask[w]) | (b[w] & mask[w]);
 			}
+			next_fits[children] = 0.0;
+		} else {
+			int fitter = fits[first] > fits[second] ? first : second;
+			const unsigned int* parent = &genomes[fitter * words];
+			for (int w = 0; w < words; ++w) {
+				child[w] = parent[w];
+			}
+			next_fits[children] = fits[fitter];
+		}
+		if (rdist(rng) < p_mutation) {
+			int var = ndist(rng);
+			int bit = variables[var].offset + draw(rng, variables[var].bits);
+			child[bit / GENOME_WORD_BITS] ^= 1u << (bit % GENOME_WORD_BITS);
 		}
+		children++;
 	}
-	generation = new_gen;
+	genomes.swap(next);
+	fits.swap(next_fits);
 	generations++;
 }
 
+void GAlgorithm::evaluate(Fitness fitness, void* data, int grain) {
+	FitnessBody body;
+	body.generation = &generation;
+	body.indices = 0;
+	body.fitness = fitness;
+	body.data = data;
+	body.seed = seed;
+	body.generations = generations;
+	if (cache == 0) {
+		begin();
+		Tasks::TaskPool::parallelFor(0, size, body, grain);
+		return;
+	}
+	writeBack();
+	begin();
+	// The cache is read and written by the calling thread, only the misses are evaluated in parallel
+	pending.clear();
+	sources.assign(size, -1);
+	std::map<unsigned long long, int> first;
+	for (int p = 0; p < size; ++p) {
+		const unsigned int* genome = &genomes[p * words];
+		double fit;
+		if (cache->lookup(genome, words, fit)) {
+			generation[p].fit = fit;
+			continue;
+		}
+		std::pair<std::map<unsigned long long, int>::iterator, bool> inserted = first.insert(std::make_pair(FitnessCache::hash(genome, words), p));
+		int source = inserted.first->second;
+		if (!inserted.second && memcmp(&genomes[source * words], genome, words * sizeof(unsigned int)) == 0) {
+			sources[p] = source;
+		} else {
+			pending.push_back(p);
+		}
+	}
+	body.indices = &pending;
+	Tasks::TaskPool::parallelFor(0, pending.size(), body, grain);
+	for (std::vector<int>::iterator it = pending.begin(); it != pending.end(); ++it) {
+		generation[*it].fit = cache->add(&genomes[*it * words], words, generation[*it].fit);
+	}
+	for (int p = 0; p < size; ++p) {
+		if (sources[p] >= 0) generation[p].fit = generation[sources[p]].fit;
+	}
+}
+
+void GAlgorithm::setCache(FitnessCache* cache) {
+	this->cache = cache;
+}
+
+void GAlgorithm::setSeed(unsigned int seed) {
+	if (seed == 0) seed = time(0);
+	this->seed = seed;
+	rng.seed(seed);
+}
+
+unsigned int GAlgorithm::getSeed() const {
+	return seed;
+}
+
+int GAlgorithm::getGenerations() const {
+	return generations;
+}
+
+int GAlgorithm::getSize() const {
+	return size;
+}
+
+int GAlgorithm::getGenomeWords() const {
+	return words;
+}
+
+const unsigned int* GAlgorithm::getGenome(int individual) const {
+	return &genomes[individual * words];
+}
+
+/*
+ * Bits [offset, offset + bits) of a genome
+ */
+static inline unsigned int extract(const unsigned int* genome, int offset, int bits) {
+	int w = offset / GAlgorithm::GENOME_WORD_BITS;
+	int shift = offset % GAlgorithm::GENOME_WORD_BITS;
+	unsigned int value = genome[w] >> shift;
+	if (shift + bits > GAlgorithm::GENOME_WORD_BITS) value |= genome[w + 1] << (GAlgorithm::GENOME_WORD_BITS - shift);
+	return bits < GAlgorithm::GENOME_WORD_BITS ? value & ((1u << bits) - 1) : value;
+}
+
+/*
+ * Writes value in the bits [offset, offset + bits) of a genome that were 0
+ */
+static inline void insert(unsigned int* genome, int offset, int bits, unsigned int value) {
+	if (bits < GAlgorithm::GENOME_WORD_BITS) value &= (1u << bits) - 1;
+	int w = offset / GAlgorithm::GENOME_WORD_BITS;
+	int shift = offset % GAlgorithm::GENOME_WORD_BITS;
+	genome[w] |= value << shift;
+	if (shift + bits > GAlgorithm::GENOME_WORD_BITS) genome[w + 1] |= value >> (GAlgorithm::GENOME_WORD_BITS - shift);
+}
+
+int GAlgorithm::getVariable(int individual, int variable) const {
+	return (int)extract(&genomes[individual * words], variables[variable].offset, variables[variable].bits);
+}
+
+double GAlgorithm::getFit(int individual) const {
+	if (copies) return generation[individual].fit;
+	return fits[individual];
+}
+
+void GAlgorithm::setFit(int individual, double fit) {
+	fits[individual] = fit;
+	if (copies) generation[individual].fit = fit;
+}
+
+struct ByFit {
+	const GAlgorithm* ga;
+	bool operator()(int a, int b) const {
+		return ga->getFit(a) > ga->getFit(b);
+	}
+};
+
+void GAlgorithm::getRanking(std::vector<int> &ranking) const {
+	ranking.resize(size);
+	for (int p = 0; p < size; ++p) {
+		ranking[p] = p;
+	}
+	ByFit by_fit;
+	by_fit.ga = this;
+	std::stable_sort(ranking.begin(), ranking.end(), by_fit);
+}
+
+void GAlgorithm::setIndividual(int individual, const unsigned int* genome, double fit) {
+	writeBack();
+	for (int w = 0; w < words; ++w) {
+		genomes[individual * words + w] = genome[w];
+	}
+	fits[individual] = fit;
+}
+
+static const char CHECKPOINT_MAGIC[4] = {'P', 'H', 'G', 'A'};
+static const int CHECKPOINT_VERSION = 1;
+
+bool GAlgorithm::save(const std::string &filename) {
+	writeBack();
+	// Written to a temporary file and renamed, a run killed while saving keeps the previous checkpoint
+	std::string temporary = filename + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "GAlgorithm::save(string) -> could not open " << temporary << std::endl;
+		return false;
+	}
+	std::ostringstream state;
+	state << rng;
+	std::string rng_state = state.str();
+	int count = variables.size();
+	int length = rng_state.length();
+	file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	file.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+	file.write(reinterpret_cast<const char*>(&p_cross), sizeof(p_cross));
+	file.write(reinterpret_cast<const char*>(&p_mutation), sizeof(p_mutation));
+	file.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+	file.write(reinterpret_cast<const char*>(&generations), sizeof(generations));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (int k = 0; k < count; ++k) {
+		file.write(reinterpret_cast<const char*>(&variables[k].bits), sizeof(variables[k].bits));
+	}
+	file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	if (size > 0) {
+		file.write(reinterpret_cast<const char*>(&genomes[0]), genomes.size() * sizeof(unsigned int));
+		file.write(reinterpret_cast<const char*>(&fits[0]), fits.size() * sizeof(double));
+	}
+	file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	file.write(rng_state.c_str(), length);
+	file.close();
+	if (!file) {
+		std::cerr << "GAlgorithm::save(string) -> error writing " << temporary << std::endl;
+		return false;
+	}
+	if (rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::cerr << "GAlgorithm::save(string) -> could not rename " << temporary << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool GAlgorithm::load(const std::string &filename) {
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) {
+		std::cerr << "GAlgorithm::load(string) -> could not open " << filename << std::endl;
+		return false;
+	}
+	char magic[4];
+	int version = 0;
+	int count = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!file || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION) {
+		std::cerr << "GAlgorithm::load(string) -> invalid checkpoint " << filename << std::endl;
+		return false;
+	}
+	double file_p_cross, file_p_mutation;
+	unsigned int file_seed;
+	int file_generations, file_size;
+	file.read(reinterpret_cast<char*>(&file_p_cross), sizeof(file_p_cross));
+	file.read(reinterpret_cast<char*>(&file_p_mutation), sizeof(file_p_mutation));
+	file.read(reinterpret_cast<char*>(&file_seed), sizeof(file_seed));
+	file.read(reinterpret_cast<char*>(&file_generations), sizeof(file_generations));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!file || count < 0 || count > 1 << 16) {
+		std::cerr << "GAlgorithm::load(string) -> invalid checkpoint " << filename << std::endl;
+		return false;
+	}
+	std::vector<int> bits(count);
+	for (int k = 0; k < count; ++k) {
+		file.read(reinterpret_cast<char*>(&bits[k]), sizeof(bits[k]));
+		if (bits[k] < 1 || bits[k] > max_var_size) file.setstate(std::ifstream::failbit);
+	}
+	file.read(reinterpret_cast<char*>(&file_size), sizeof(file_size));
+	if (!file || file_size < 0) {
+		std::cerr << "GAlgorithm::load(string) -> invalid checkpoint " << filename << std::endl;
+		return false;
+	}
+	variables.clear();
+	genome_bits = 0;
+	words = 0;
+	size = 0;
+	for (int k = 0; k < count; ++k) {
+		addVariable(bits[k]);
+	}
+	generatePopulation(file_size);
+	if (file_size > 0) {
+		file.read(reinterpret_cast<char*>(&genomes[0]), genomes.size() * sizeof(unsigned int));
+		file.read(reinterpret_cast<char*>(&fits[0]), fits.size() * sizeof(double));
+	}
+	int length = 0;
+	file.read(reinterpret_cast<char*>(&length), sizeof(length));
+	if (!file || length < 0 || length > 1 << 20) {
+		std::cerr << "GAlgorithm::load(string) -> truncated checkpoint " << filename << std::endl;
+		return false;
+	}
+	std::vector<char> rng_state(length + 1, '\0');
+	file.read(&rng_state[0], length);
+	if (!file) {
+		std::cerr << "GAlgorithm::load(string) -> truncated checkpoint " << filename << std::endl;
+		return false;
+	}
+	std::istringstream state(std::string(&rng_state[0], length));
+	state >> rng;
+	p_cross = file_p_cross;
+	p_mutation = file_p_mutation;
+	seed = file_seed;
+	generations = file_generations;
+	return true;
+}
+
 std::vector<Individual>::iterator GAlgorithm::begin() {
+	if (!copies) {
+		// The copies keep their vectors between generations
+		generation.resize(size);
+		for (int p = 0; p < size; ++p) {
+			decode(p, generation[p]);
+		}
+		copies = true;
+	}
 	return generation.begin();
 }
 
 std::vector<Individual>::iterator GAlgorithm::end() {
+	begin();
 	return generation.end();
 }
 
-int GAlgorithm::cross(int var_a, int var_b, int index, int bit) {
-	int upper_mask = variables[index].ones << bit;
-	int lower_mask = variables[index].ones >> (variables[index].bits - bit);
-	var_a = var_a & upper_mask;
-	var_b = var_b & lower_mask;
-	return var_a | var_b;
+void GAlgorithm::decode(int individual, Individual &copy) const {
+	const unsigned int* genome = &genomes[individual * words];
+	const int count = variables.size();
+	copy.variables.resize(count);
+	for (int k = 0; k < count; ++k) {
+		copy.variables[k] = (int)extract(genome, variables[k].offset, variables[k].bits);
+	}
+	copy.fit = fits[individual];
 }
 
-int GAlgorithm::mutate(int var, int bit) {
-	int mask = 1 << bit;
-	return var ^ mask;
+void GAlgorithm::encode(const Individual &copy, int individual) {
+	unsigned int* genome = &genomes[individual * words];
+	for (int w = 0; w < words; ++w) {
+		genome[w] = 0;
+	}
+	const int count = variables.size() < copy.variables.size() ? variables.size() : copy.variables.size();
+	for (int k = 0; k < count; ++k) {
+		insert(genome, variables[k].offset, variables[k].bits, (unsigned int)copy.variables[k]);
+	}
+	fits[individual] = copy.fit;
+}
+
+void GAlgorithm::writeBack() {
+	if (!copies) return;
+	for (int p = 0; p < size; ++p) {
+		encode(generation[p], p);
+	}
+	copies = false;
 }
 
 }
@@ -0,0 +1,364 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Islands.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "TaskPool.hpp"
+
+namespace Genetics {
+
+static const char MIGRANTS_MAGIC[4] = {'P', 'H', 'M', 'G'};
+static const char ISLANDS_MAGIC[4] = {'P', 'H', 'I', 'S'};
+
+/*
+ * Seed of an island from the seed of the model and the position of the island in the ring
+ */
+static unsigned int islandSeed(unsigned int seed, int island) {
+	unsigned long long z = ((unsigned long long)seed << 32) ^ (unsigned long long)island;
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	return (unsigned int)z == 0 ? 1 : (unsigned int)z;
+}
+
+struct IslandStep {
+	GAlgorithm* island;
+	Fitness fitness;
+	void* data;
+	bool per_individual;
+	bool evolve;
+};
+
+static void runStep(void* arg) {
+	IslandStep* step = static_cast<IslandStep*>(arg);
+	if (step->evolve) step->island->runGeneration(step->per_individual);
+	step->island->evaluate(step->fitness, step->data);
+}
+
+Islands::Islands(int islands, double p_cross, double p_mutation, unsigned int seed) {
+	if (islands < 1) islands = 1;
+	this->seed = seed == 0 ? time(0) : seed;
+	for (int i = 0; i < islands; ++i) {
+		this->islands.push_back(new GAlgorithm(p_cross, p_mutation, islandSeed(this->seed, i)));
+	}
+	interval = 0;
+	elites = 0;
+	process = 0;
+	processes = 1;
+	checkpoint_interval = 0;
+	generations = 0;
+	evaluated = false;
+	migrations = 0;
+	received = 0;
+	saved_generations = -1;
+}
+
+Islands::~Islands() {
+	for (std::vector<GAlgorithm*>::iterator it = islands.begin(); it != islands.end(); ++it) {
+		delete *it;
+	}
+}
+
+void Islands::addVariable(int bits) {
+	for (std::vector<GAlgorithm*>::iterator it = islands.begin(); it != islands.end(); ++it) {
+		(*it)->addVariable(bits);
+	}
+}
+
+void Islands::generatePopulation(int size) {
+	for (std::vector<GAlgorithm*>::iterator it = islands.begin(); it != islands.end(); ++it) {
+		(*it)->generatePopulation(size);
+	}
+	evaluated = false;
+}
+
+void Islands::setMigration(int interval, int elites) {
+	this->interval = interval;
+	this->elites = elites;
+}
+
+void Islands::setChannel(const std::string &directory, int process, int processes) {
+	if (processes < 1 || process < 0 || process >= processes) {
+		std::cerr << "Islands::setChannel(string, int, int) -> invalid process " << process << " of " << processes << std::endl;
+		return;
+	}
+	this->directory = directory;
+	this->process = process;
+	this->processes = processes;
+	// The islands of every process take different seeds
+	for (unsigned int i = 0; i < islands.size(); ++i) {
+		islands[i]->setSeed(islandSeed(seed, process * islands.size() + i));
+	}
+}
+
+void Islands::setCheckpoint(const std::string &prefix, int interval) {
+	checkpoint = prefix;
+	checkpoint_interval = interval;
+}
+
+void Islands::run(int generations, Fitness fitness, void* data, bool per_individual) {
+	std::vector<IslandStep> steps(islands.size());
+	for (unsigned int i = 0; i < islands.size(); ++i) {
+		steps[i].island = islands[i];
+		steps[i].fitness = fitness;
+		steps[i].data = data;
+		steps[i].per_individual = per_individual;
+		steps[i].evolve = evaluated;
+	}
+	for (int g = evaluated ? 0 : -1; g < generations; ++g) {
+		Tasks::TaskGroup group;
+		for (unsigned int i = 0; i < steps.size(); ++i) {
+			group.run(runStep, &steps[i]);
+		}
+		group.wait();
+		if (!evaluated) {
+			// The first step only evaluated the generated populations
+			evaluated = true;
+			for (unsigned int i = 0; i < steps.size(); ++i) {
+				steps[i].evolve = true;
+			}
+			continue;
+		}
+		this->generations++;
+		if (interval > 0 && this->generations % interval == 0) {
+			migrate();
+		}
+		if (checkpoint_interval > 0 && this->generations % checkpoint_interval == 0) {
+			save(checkpoint);
+		}
+	}
+}
+
+void Islands::migrate() {
+	if (elites <= 0) return;
+	const int count = islands.size();
+	const int words = islands[0]->getGenomeWords();
+	const int size = islands[0]->getSize();
+	const int migrating = elites < size ? elites : size;
+	if (migrating == 0) return;
+	// The elites of every island are copied before any island changes
+	migrants.resize(count * migrating * words);
+	migrant_fits.resize(count * migrating);
+	for (int i = 0; i < count; ++i) {
+		islands[i]->getRanking(ranking);
+		for (int e = 0; e < migrating; ++e) {
+			const unsigned int* genome = islands[i]->getGenome(ranking[e]);
+			for (int w = 0; w < words; ++w) {
+				migrants[(i * migrating + e) * words + w] = genome[w];
+			}
+			migrant_fits[i * migrating + e] = islands[i]->getFit(ranking[e]);
+		}
+	}
+	migrations++;
+	for (int i = 1; i < count; ++i) {
+		replaceWorst(*islands[i], &migrants[(i - 1) * migrating * words], &migrant_fits[(i - 1) * migrating], migrating);
+	}
+	if (processes > 1) {
+		sendMigrants(*islands[count - 1]);
+		receiveMigrants(*islands[0]);
+	} else if (count > 1) {
+		replaceWorst(*islands[0], &migrants[(count - 1) * migrating * words], &migrant_fits[(count - 1) * migrating], migrating);
+	}
+}
+
+void Islands::replaceWorst(GAlgorithm &island, const unsigned int* genomes, const double* fits, int count) {
+	island.getRanking(ranking);
+	const int words = island.getGenomeWords();
+	for (int c = 0; c < count && c < (int)ranking.size(); ++c) {
+		island.setIndividual(ranking[ranking.size() - 1 - c], genomes + c * words, fits[c]);
+	}
+}
+
+std::string Islands::channelFile(int process) const {
+	std::stringstream file;
+	file << directory << "/migrants." << process;
+	return file.str();
+}
+
+bool Islands::sendMigrants(const GAlgorithm &island) {
+	const int count = islands.size();
+	const int words = island.getGenomeWords();
+	const int migrating = migrant_fits.size() / count;
+	const unsigned int* genomes = &migrants[(count - 1) * migrating * words];
+	const double* fits = &migrant_fits[(count - 1) * migrating];
+	// Written to a temporary file and renamed, the next process never reads half a file
+	std::string filename = channelFile(process);
+	std::string temporary = filename + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "Islands::sendMigrants(GAlgorithm) -> could not open " << temporary << std::endl;
+		return false;
+	}
+	file.write(MIGRANTS_MAGIC, sizeof(MIGRANTS_MAGIC));
+	file.write(reinterpret_cast<const char*>(&migrations), sizeof(migrations));
+	file.write(reinterpret_cast<const char*>(&migrating), sizeof(migrating));
+	file.write(reinterpret_cast<const char*>(&words), sizeof(words));
+	file.write(reinterpret_cast<const char*>(genomes), migrating * words * sizeof(unsigned int));
+	file.write(reinterpret_cast<const char*>(fits), migrating * sizeof(double));
+	file.close();
+	if (!file || rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::cerr << "Islands::sendMigrants(GAlgorithm) -> error writing " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Islands::receiveMigrants(GAlgorithm &island) {
+	std::string filename = channelFile((process + processes - 1) % processes);
+	std::ifstream file(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) return false; // The previous process did not send migrants yet
+	char magic[4];
+	int number = 0;
+	int count = 0;
+	int words = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&number), sizeof(number));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	file.read(reinterpret_cast<char*>(&words), sizeof(words));
+	if (!file || memcmp(magic, MIGRANTS_MAGIC, sizeof(magic)) != 0 || words != island.getGenomeWords() || count < 0 || count > island.getSize()) {
+		std::cerr << "Islands::receiveMigrants(GAlgorithm) -> invalid migrants in " << filename << std::endl;
+		return false;
+	}
+	if (number == received) return false; // Already taken
+	std::vector<unsigned int> genomes(count * words);
+	std::vector<double> fits(count);
+	if (count > 0) {
+		file.read(reinterpret_cast<char*>(&genomes[0]), genomes.size() * sizeof(unsigned int));
+		file.read(reinterpret_cast<char*>(&fits[0]), fits.size() * sizeof(double));
+	}
+	if (!file) {
+		std::cerr << "Islands::receiveMigrants(GAlgorithm) -> truncated migrants in " << filename << std::endl;
+		return false;
+	}
+	received = number;
+	if (count > 0) replaceWorst(island, &genomes[0], &fits[0], count);
+	return true;
+}
+
+std::string Islands::islandFile(const std::string &prefix, int island, int generation) const {
+	std::stringstream file;
+	file << prefix << "." << process * islands.size() + island << "." << generation;
+	return file.str();
+}
+
+bool Islands::save(const std::string &prefix) {
+	// The islands go to files of their generation, the files of the previous checkpoint are kept
+	for (unsigned int i = 0; i < islands.size(); ++i) {
+		if (!islands[i]->save(islandFile(prefix, i, generations))) return false;
+	}
+	// The state is written last, to a temporary file and renamed, so it only refers to complete islands
+	// of one generation, a crash before the rename resumes from the previous checkpoint
+	std::stringstream state;
+	state << prefix << ".islands." << process;
+	std::string temporary = state.str() + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!file) {
+		std::cerr << "Islands::save(string) -> could not open " << temporary << std::endl;
+		return false;
+	}
+	int count = islands.size();
+	file.write(ISLANDS_MAGIC, sizeof(ISLANDS_MAGIC));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	file.write(reinterpret_cast<const char*>(&generations), sizeof(generations));
+	file.write(reinterpret_cast<const char*>(&evaluated), sizeof(evaluated));
+	file.write(reinterpret_cast<const char*>(&migrations), sizeof(migrations));
+	file.write(reinterpret_cast<const char*>(&received), sizeof(received));
+	file.close();
+	if (!file) {
+		std::cerr << "Islands::save(string) -> error writing " << temporary << std::endl;
+		return false;
+	}
+	if (rename(temporary.c_str(), state.str().c_str()) != 0) {
+		std::cerr << "Islands::save(string) -> could not rename " << temporary << std::endl;
+		return false;
+	}
+	if (saved_generations >= 0 && saved_generations != generations) {
+		for (unsigned int i = 0; i < islands.size(); ++i) {
+			remove(islandFile(prefix, i, saved_generations).c_str());
+		}
+	}
+	saved_generations = generations;
+	return true;
+}
+
+bool Islands::load(const std::string &prefix) {
+	std::stringstream state;
+	state << prefix << ".islands." << process;
+	std::ifstream file(state.str().c_str(), std::ifstream::in | std::ifstream::binary);
+	if (!file) return false; // No checkpoint, the run starts from the generated populations
+	char magic[4];
+	int count = 0;
+	int file_generations = 0;
+	bool file_evaluated = false;
+	int file_migrations = 0;
+	int file_received = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	file.read(reinterpret_cast<char*>(&file_generations), sizeof(file_generations));
+	file.read(reinterpret_cast<char*>(&file_evaluated), sizeof(file_evaluated));
+	file.read(reinterpret_cast<char*>(&file_migrations), sizeof(file_migrations));
+	file.read(reinterpret_cast<char*>(&file_received), sizeof(file_received));
+	if (!file || memcmp(magic, ISLANDS_MAGIC, sizeof(magic)) != 0 || count != (int)islands.size()) {
+		std::cerr << "Islands::load(string) -> invalid checkpoint " << state.str() << std::endl;
+		return false;
+	}
+	for (unsigned int i = 0; i < islands.size(); ++i) {
+		if (!islands[i]->load(islandFile(prefix, i, file_generations))) return false;
+	}
+	saved_generations = file_generations;
+	generations = file_generations;
+	evaluated = file_evaluated;
+	migrations = file_migrations;
+	received = file_received;
+	return true;
+}
+
+int Islands::getIslands() const {
+	return islands.size();
+}
+
+GAlgorithm& Islands::getIsland(int island) {
+	return *islands[island];
+}
+
+double Islands::getBest(int &island, int &individual) const {
+	double best = 0.0;
+	island = -1;
+	individual = -1;
+	for (unsigned int i = 0; i < islands.size(); ++i) {
+		for (int p = 0; p < islands[i]->getSize(); ++p) {
+			double fit = islands[i]->getFit(p);
+			if (island < 0 || fit > best) {
+				best = fit;
+				island = i;
+				individual = p;
+			}
+		}
+	}
+	return best;
+}
+
+}
@@ -0,0 +1,270 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Physics.hpp"
+#include "constants.hpp"
+#include <cmath>
+
+namespace Physics {
+
+static const double EPSILON = 1.0e-10;
+
+inline double normalizeAngle(double degrees) {
+	while (degrees > 180.0) degrees -= 360.0;
+	while (degrees < -180.0) degrees += 360.0;
+	return degrees;
+}
+
+inline double bound(double min, double value, double max) {
+	return value < min ? min : (value > max ? max : value);
+}
+
+/*
+ * Limits the magnitude of the vector (x, y) to max
+ */
+inline void limit(double &x, double &y, double max) {
+	double magnitude = sqrt(x * x + y * y);
+	if (magnitude > max && magnitude > EPSILON) {
+		x *= max / magnitude;
+		y *= max / magnitude;
+	}
+}
+
+Model::Model() {
+	ball_accel_max        = 2.7;
+	ball_decay            = 0.94;
+	ball_size             = 0.085;
+	ball_speed_max        = 3.0;
+	player_accel_max      = 1.0;
+	player_decay          = 0.4;
+	player_size           = 0.3;
+	player_speed_max      = 1.05;
+	dash_power_rate       = 0.006;
+	effort                = 1.0;
+	inertia_moment        = 5.0;
+	kickable_margin       = 0.7;
+	kick_power_rate       = 0.027;
+	stamina_inc_max       = 45.0;
+	stamina_max           = 8000.0;
+	extra_stamina         = 50.0;
+	max_dash_power        = 100.0;
+	min_dash_power        = -100.0;
+	max_dash_angle        = 180.0;
+	min_dash_angle        = -180.0;
+	dash_angle_step       = 45.0;
+	side_dash_rate        = 0.4;
+	back_dash_rate        = 0.6;
+	maxmoment             = 180.0;
+	minmoment             = -180.0;
+	maxpower              = 100.0;
+	minpower              = -100.0;
+	tackle_dist           = 2.0;
+	tackle_back_dist      = 0.0;
+	tackle_width          = 1.25;
+	tackle_exponent       = 6.0;
+	tackle_power_rate     = 0.027;
+	max_tackle_power      = 100.0;
+	max_back_tackle_power = 0.0;
+}
+
+Simulator::Simulator() {
+
+}
+
+Simulator::Simulator(const Model &model) {
+	this->model = model;
+}
+
+Simulator::~Simulator() {
+
+}
+
+void Simulator::setModel(const Model &model) {
+	this->model = model;
+}
+
+const Model& Simulator::getModel() const {
+	return model;
+}
+
+double Simulator::getDashAcceleration(double power, double direction) const {
+	power = bound(model.min_dash_power, power, model.max_dash_power);
+	direction = bound(model.min_dash_angle, direction, model.max_dash_angle);
+	if (model.dash_angle_step > EPSILON) {
+		direction = model.dash_angle_step * floor(direction / model.dash_angle_step + 0.5);
+	}
+	double abs_direction = fabs(direction);
+	double dir_rate = abs_direction > 90.0
+			? model.back_dash_rate - (model.back_dash_rate - model.side_dash_rate) * (1.0 - (abs_direction - 90.0) / 90.0)
+			: model.side_dash_rate + (1.0 - model.side_dash_rate) * (1.0 - abs_direction / 90.0);
+	dir_rate = bound(0.0, dir_rate, 1.0);
+	double accel = fabs(model.effort * power * dir_rate * model.dash_power_rate);
+	return accel > model.player_accel_max ? model.player_accel_max : accel;
+}
+
+/*
+ * rcssserver Player::dash: the power is limited by the available stamina and a back dash
+ * (negative power) costs twice the power and pushes to the opposite direction
+ */
+void Simulator::dash(State &state, double power, double direction, double &ax, double &ay) const {
+	power = bound(model.min_dash_power, power, model.max_dash_power);
+	direction = bound(model.min_dash_angle, direction, model.max_dash_angle);
+	if (model.dash_angle_step > EPSILON) {
+		direction = model.dash_angle_step * floor(direction / model.dash_angle_step + 0.5);
+	}
+	bool back_dash = power < 0.0;
+	double power_need = back_dash ? -2.0 * power : power;
+	double available = state.stamina + model.extra_stamina;
+	if (power_need > available) power_need = available;
+	state.stamina -= power_need;
+	if (state.stamina < 0.0) state.stamina = 0.0;
+	power = back_dash ? power_need / -2.0 : power_need;
+	double abs_direction = fabs(direction);
+	double dir_rate = abs_direction > 90.0
+			? model.back_dash_rate - (model.back_dash_rate - model.side_dash_rate) * (1.0 - (abs_direction - 90.0) / 90.0)
+			: model.side_dash_rate + (1.0 - model.side_dash_rate) * (1.0 - abs_direction / 90.0);
+	dir_rate = bound(0.0, dir_rate, 1.0);
+	double accel = fabs(model.effort * power * dir_rate * model.dash_power_rate);
+	if (back_dash) direction += 180.0;
+	double angle = (state.body + direction) * Math::PI / 180.0;
+	ax += accel * cos(angle);
+	ay += accel * sin(angle);
+}
+
+double Simulator::getKickEffectiveRate(const State &state) const {
+	double dx = state.ball_x - state.x;
+	double dy = state.ball_y - state.y;
+	double dist_ball = sqrt(dx * dx + dy * dy) - model.ball_size - model.player_size;
+	if (dist_ball > model.kickable_margin) return 0.0;
+	double dir_diff = fabs(normalizeAngle(atan2(dy, dx) * 180.0 / Math::PI - state.body));
+	if (dist_ball < 0.0) dist_ball = 0.0;
+	return model.kick_power_rate * (1.0 - 0.25 * dir_diff / 180.0 - 0.25 * dist_ball / model.kickable_margin);
+}
+
+bool Simulator::isKickable(const State &state) const {
+	double dx = state.ball_x - state.x;
+	double dy = state.ball_y - state.y;
+	double radius = model.player_size + model.ball_size + model.kickable_margin;
+	return dx * dx + dy * dy <= radius * radius;
+}
+
+void Simulator::kick(State &state, double power, double direction, double &bax, double &bay) const {
+	double rate = getKickEffectiveRate(state);
+	if (rate <= 0.0) return;
+	power = bound(model.minpower, power, model.maxpower);
+	direction = bound(model.minmoment, direction, model.maxmoment);
+	double angle = (state.body + direction) * Math::PI / 180.0;
+	bax += power * rate * cos(angle);
+	bay += power * rate * sin(angle);
+}
+
+double Simulator::getTackleProbability(const State &state) const {
+	double body = state.body * Math::PI / 180.0;
+	double dx = state.ball_x - state.x;
+	double dy = state.ball_y - state.y;
+	// Ball relative to the body direction
+	double x = dx * cos(body) + dy * sin(body);
+	double y = -dx * sin(body) + dy * cos(body);
+	double dist = x > 0.0 ? model.tackle_dist : model.tackle_back_dist;
+	if (dist < EPSILON || model.tackle_width < EPSILON) return 0.0;
+	if (fabs(x) > dist || fabs(y) > model.tackle_width) return 0.0;
+	double fail = pow(fabs(x) / dist, model.tackle_exponent) + pow(fabs(y) / model.tackle_width, model.tackle_exponent);
+	return fail < 1.0 ? 1.0 - fail : 0.0;
+}
+
+void Simulator::tackle(State &state, double direction, double &bax, double &bay) const {
+	if (getTackleProbability(state) <= 0.0) return;
+	direction = bound(model.minmoment, direction, model.maxmoment);
+	double power = (model.max_back_tackle_power + (model.max_tackle_power - model.max_back_tackle_power) * (1.0 - fabs(direction) / 180.0)) * model.tackle_power_rate;
+	double ball_dir = normalizeAngle(atan2(state.ball_y - state.y, state.ball_x - state.x) * 180.0 / Math::PI - state.body);
+	power *= 1.0 - 0.5 * fabs(ball_dir) / 180.0;
+	double angle = (state.body + direction) * Math::PI / 180.0;
+	bax += power * cos(angle);
+	bay += power * sin(angle);
+}
+
+void Simulator::step(State &state, const Action &action) const {
+	double ax = 0.0, ay = 0.0;
+	double bax = 0.0, bay = 0.0;
+	switch (action.type) {
+	case DASH:
+		dash(state, action.arg0, action.arg1, ax, ay);
+		break;
+	case TURN: {
+		double moment = bound(model.minmoment, action.arg0, model.maxmoment);
+		double speed = sqrt(state.vx * state.vx + state.vy * state.vy);
+		state.body = normalizeAngle(state.body + moment / (1.0 + model.inertia_moment * speed));
+		break;
+	}
+	case KICK:
+		kick(state, action.arg0, action.arg1, bax, bay);
+		break;
+	case TACKLE:
+		tackle(state, action.arg0, bax, bay);
+		break;
+	default:
+		break;
+	}
+	// Player
+	limit(ax, ay, model.player_accel_max);
+	state.vx += ax;
+	state.vy += ay;
+	limit(state.vx, state.vy, model.player_speed_max);
+	state.x += state.vx;
+	state.y += state.vy;
+	state.vx *= model.player_decay;
+	state.vy *= model.player_decay;
+	state.stamina += model.stamina_inc_max;
+	if (state.stamina > model.stamina_max) state.stamina = model.stamina_max;
+	// Ball
+	limit(bax, bay, model.ball_accel_max);
+	state.ball_vx += bax;
+	state.ball_vy += bay;
+	limit(state.ball_vx, state.ball_vy, model.ball_speed_max);
+	state.ball_x += state.ball_vx;
+	state.ball_y += state.ball_vy;
+	state.ball_vx *= model.ball_decay;
+	state.ball_vy *= model.ball_decay;
+}
+
+void Simulator::rollout(State &state, const Action* actions, int length, State* trajectory) const {
+	for (int i = 0; i < length; ++i) {
+		step(state, actions[i]);
+		if (trajectory) trajectory[i] = state;
+	}
+}
+
+void Simulator::rollouts(const State &start, const Action* actions, int count, int length, State* results) const {
+	for (int i = 0; i < count; ++i) {
+		results[i] = start;
+		rollout(results[i], actions + i * length, length);
+	}
+}
+
+void Simulator::predictBall(State &state, int cycles) const {
+	for (int i = 0; i < cycles; ++i) {
+		state.ball_x += state.ball_vx;
+		state.ball_y += state.ball_vy;
+		state.ball_vx *= model.ball_decay;
+		state.ball_vy *= model.ball_decay;
+	}
+}
+
+}
@@ -0,0 +1,219 @@
+/*
+ * Phoenix2D (RoboCup Soccer Simulation 2D League)
+ * Copyright (c) 2013 Ivan Gonzalez
+ *
+ * This file is part of Phoenix2D.
+ *
+ * Phoenix2D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Phoenix2D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Phoenix2D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TaskPool.hpp"
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace Tasks {
+
+const int TaskPool::MAX_THREADS;
+const int TaskPool::QUEUE_SIZE;
+const int TaskPool::MAX_CHUNKS;
+
+/*
+ * Bounded queue of a thread, the owner works on the tail and the thieves take from the head
+ */
+struct Queue {
+	pthread_mutex_t mutex;
+	Task tasks[TaskPool::QUEUE_SIZE];
+	unsigned int head;
+	unsigned int tail;
+};
+
+static Queue queues[TaskPool::MAX_THREADS];
+static pthread_t workers[TaskPool::MAX_THREADS];
+static int threads = 1;
+static bool running = false;
+static volatile int queued = 0;
+static pthread_mutex_t idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static bool bind_cores = false;
+static int first_core = 0;
+
+/* Queue of the current thread, 0 for the threads out of the pool */
+static __thread int slot = 0;
+
+static bool pop(int index, Task &task, bool newest) {
+	Queue &queue = queues[index];
+	if (queue.head == queue.tail) return false; // Checked again with the lock
+	bool found = false;
+	pthread_mutex_lock(&queue.mutex);
+	if (queue.head != queue.tail) {
+		if (newest) {
+			queue.tail--;
+			task = queue.tasks[queue.tail % TaskPool::QUEUE_SIZE];
+		} else {
+			task = queue.tasks[queue.head % TaskPool::QUEUE_SIZE];
+			queue.head++;
+		}
+		found = true;
+	}
+	pthread_mutex_unlock(&queue.mutex);
+	if (found) __sync_fetch_and_sub(&queued, 1);
+	return found;
+}
+
+static void* worker(void* arg) {
+	slot = (int)(long)arg;
+#ifdef CPU_SET
+	if (bind_cores) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cores > 0) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET((first_core + slot) % cores, &set);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+				std::cerr << "TaskPool::worker(void*) -> can not bind worker " << slot << std::endl;
+			}
+		}
+	}
+#endif
+	while (true) {
+		if (TaskPool::runPending()) continue;
+		pthread_mutex_lock(&idle_mutex);
+		while (queued == 0 && running) {
+			pthread_cond_wait(&idle_cond, &idle_mutex);
+		}
+		bool stop = !running && queued == 0;
+		pthread_mutex_unlock(&idle_mutex);
+		if (stop) break;
+	}
+	return 0;
+}
+
+TaskGroup::TaskGroup() {
+	pending = 0;
+}
+
+TaskGroup::~TaskGroup() {
+	wait();
+}
+
+void TaskGroup::run(Function function, void* arg) {
+	__sync_fetch_and_add(&pending, 1);
+	Task task;
+	task.function = function;
+	task.arg = arg;
+	task.group = this;
+	if (!TaskPool::isRunning() || !TaskPool::push(task)) {
+		function(arg);
+		finish();
+	}
+}
+
+void TaskGroup::wait() {
+	while (pending > 0) {
+		if (!TaskPool::runPending()) sched_yield();
+	}
+	__sync_synchronize();
+}
+
+int TaskGroup::getPending() const {
+	return pending;
+}
+
+void TaskGroup::finish() {
+	__sync_fetch_and_sub(&pending, 1);
+}
+
+void TaskPool::start(int count, bool affinity, int core) {
+	if (running) stop();
+	if (count < 1) count = 1;
+	if (count > MAX_THREADS) count = MAX_THREADS;
+	threads = count;
+	bind_cores = affinity;
+	first_core = core;
+	queued = 0;
+	for (int i = 0; i < threads; ++i) {
+		pthread_mutex_init(&queues[i].mutex, 0);
+		queues[i].head = 0;
+		queues[i].tail = 0;
+	}
+	if (threads == 1) return;
+	running = true;
+	for (int i = 1; i < threads; ++i) {
+		if (pthread_create(&workers[i], 0, worker, (void*)(long)i) != 0) {
+			std::cerr << "TaskPool::start(int, bool, int) -> error creating worker " << i << std::endl;
+			threads = i;
+			break;
+		}
+	}
+}
+
+void TaskPool::stop() {
+	if (!running) return;
+	pthread_mutex_lock(&idle_mutex);
+	running = false;
+	pthread_cond_broadcast(&idle_cond);
+	pthread_mutex_unlock(&idle_mutex);
+	for (int i = 1; i < threads; ++i) {
+		pthread_join(workers[i], 0);
+	}
+	// Tasks queued by the threads out of the pool after the workers left
+	while (runPending());
+	for (int i = 0; i < threads; ++i) {
+		pthread_mutex_destroy(&queues[i].mutex);
+	}
+	threads = 1;
+}
+
+int TaskPool::getThreads() {
+	return threads;
+}
+
+bool TaskPool::isRunning() {
+	return running;
+}
+
+bool TaskPool::push(const Task &task) {
+	if (!running) return false;
+	Queue &queue = queues[slot];
+	pthread_mutex_lock(&queue.mutex);
+	bool full = queue.tail - queue.head >= (unsigned int)QUEUE_SIZE;
+	if (!full) {
+		queue.tasks[queue.tail % QUEUE_SIZE] = task;
+		queue.tail++;
+	}
+	pthread_mutex_unlock(&queue.mutex);
+	if (full) return false;
+	__sync_fetch_and_add(&queued, 1);
+	pthread_mutex_lock(&idle_mutex);
+	pthread_cond_signal(&idle_cond);
+	pthread_mutex_unlock(&idle_mutex);
+	return true;
+}
+
+bool TaskPool::runPending() {
+	if (queued == 0) return false;
+	Task task;
+	bool found = pop(slot, task, true);
+	for (int i = 1; i < threads && !found; ++i) {
+		found = pop((slot + i) % threads, task, false);
+	}
+	if (!found) return false;
+	task.function(task.arg);
+	if (task.group) task.group->finish();
+	return true;
+}
+
+}